@@ -0,0 +1,196 @@
+#ifndef RAPIDUTF_BENCHMARK_CORPUS_HPP
+#define RAPIDUTF_BENCHMARK_CORPUS_HPP
+
+// Deterministic text generators that mimic the code point mix of real-world languages.
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace corpus {
+
+enum class kind {
+    english,     // ASCII with an occasional accented word
+    russian,     // Cyrillic, two-byte UTF-8
+    arabic,      // Arabic script, two-byte UTF-8
+    hindi,       // Devanagari, three-byte UTF-8
+    cjk,         // Chinese and Japanese, three-byte UTF-8 with little whitespace
+    emoji_chat,  // Short ASCII chat lines dense with four-byte emoji
+    json,        // ASCII structure around strings in all of the above
+};
+
+inline auto all() -> const std::vector<kind>& {
+    static const std::vector<kind> kinds = {kind::english, kind::russian, kind::arabic, kind::hindi, kind::cjk, kind::emoji_chat, kind::json};
+    return kinds;
+}
+
+inline auto name(kind k) -> const char* {
+    switch (k) {
+        case kind::english: return "english";
+        case kind::russian: return "russian";
+        case kind::arabic: return "arabic";
+        case kind::hindi: return "hindi";
+        case kind::cjk: return "cjk";
+        case kind::emoji_chat: return "emoji_chat";
+        case kind::json: return "json";
+    }
+    return "unknown";
+}
+
+namespace detail {
+
+using words = std::vector<const char*>;
+
+inline auto english() -> const words& {
+    static const words list = {"the", "of", "and", "to", "in", "is", "that", "for", "it", "was", "on", "with", "as", "be", "at", "by",
+                               "this", "from", "have", "not", "are", "but", "which", "they", "one", "you", "all", "were", "time",
+                               "people", "world", "information", "performance", "conversion", "between", "during", "because"};
+    return list;
+}
+
+inline auto english_accented() -> const words& {
+    static const words list = {u8"café", u8"naïve", u8"résumé", u8"façade", u8"coöperate", u8"déjà", u8"jalapeño", u8"über"};
+    return list;
+}
+
+inline auto russian() -> const words& {
+    static const words list = {u8"и", u8"в", u8"не", u8"на", u8"что", u8"быть", u8"с", u8"он", u8"как", u8"это", u8"по", u8"но",
+                               u8"они", u8"мы", u8"который", u8"человек", u8"время", u8"год", u8"работа", u8"страна", u8"вопрос",
+                               u8"здравствуйте", u8"производительность", u8"преобразование"};
+    return list;
+}
+
+inline auto arabic() -> const words& {
+    static const words list = {u8"في", u8"من", u8"على", u8"إلى", u8"أن", u8"هذا", u8"التي", u8"كان", u8"عن", u8"مع", u8"هو",
+                               u8"العالم", u8"الناس", u8"الوقت", u8"مرحبا", u8"الحكومة", u8"المعلومات", u8"التحويل", u8"السريع"};
+    return list;
+}
+
+inline auto hindi() -> const words& {
+    static const words list = {u8"के", u8"है", u8"में", u8"की", u8"और", u8"से", u8"को", u8"का", u8"एक", u8"पर", u8"यह", u8"भी",
+                               u8"नमस्ते", u8"भारत", u8"सरकार", u8"जानकारी", u8"समय", u8"लोग", u8"दुनिया", u8"प्रदर्शन", u8"रूपांतरण"};
+    return list;
+}
+
+inline auto cjk() -> const words& {
+    static const words list = {u8"的", u8"一", u8"是", u8"不", u8"了", u8"人", u8"我", u8"在", u8"有", u8"他", u8"这个", u8"中国",
+                               u8"世界", u8"时间", u8"信息", u8"转换", u8"性能", u8"こんにちは", u8"ありがとう", u8"日本語", u8"です",
+                               u8"東京", u8"カタカナ", u8"ひらがな", u8"の", u8"を", u8"は"};
+    return list;
+}
+
+inline auto emoji() -> const words& {
+    static const words list = {u8"😀", u8"😂", u8"🤣", u8"😍", u8"👍", u8"🙏", u8"🔥", u8"🎉", u8"❤️", u8"😭", u8"🥺", u8"✨",
+                               u8"👨‍👩‍👧", u8"🇹🇭", u8"👍🏽", u8"🤔"};
+    return list;
+}
+
+inline auto chat() -> const words& {
+    static const words list = {"lol", "ok", "omg", "see", "you", "tomorrow", "haha", "yes", "no", "what", "where", "are", "u", "thanks",
+                               "love", "this", "so", "good", "wait", "brb", "nice", "same"};
+    return list;
+}
+
+class writer {
+public:
+    explicit writer(kind k) : m_random(0x5eed + static_cast<unsigned>(k)) {}
+
+    auto pick(const words& list) -> const char* {
+        return list[std::uniform_int_distribution<std::size_t>(0, list.size() - 1)(m_random)];
+    }
+
+    auto chance(int percent) -> bool {
+        return std::uniform_int_distribution<int>(0, 99)(m_random) < percent;
+    }
+
+    auto number(int low, int high) -> int {
+        return std::uniform_int_distribution<int>(low, high)(m_random);
+    }
+
+    // A sentence of space separated words (no separators for CJK) ended by `stop`
+    auto sentence(std::string& out, const words& list, const char* separator, const char* stop) -> void {
+        const int length = number(4, 14);
+        for (int i = 0; i < length; ++i) {
+            if (i != 0) {
+                out += separator;
+            }
+            out += pick(list);
+        }
+        out += stop;
+    }
+
+private:
+    std::mt19937 m_random;
+};
+
+inline auto paragraph(writer& w, kind k, std::string& out) -> void {
+    switch (k) {
+        case kind::english: {
+            const int length = w.number(4, 14);
+            for (int i = 0; i < length; ++i) {
+                out += (i == 0) ? "" : " ";
+                out += w.chance(3) ? w.pick(english_accented()) : w.pick(english());
+            }
+            out += ". ";
+            break;
+        }
+        case kind::russian: w.sentence(out, russian(), " ", ". "); break;
+        case kind::arabic: w.sentence(out, arabic(), " ", u8"، "); break;
+        case kind::hindi: w.sentence(out, hindi(), " ", u8"। "); break;
+        case kind::cjk: w.sentence(out, cjk(), "", u8"。"); break;
+        case kind::emoji_chat: {
+            out += w.chance(50) ? "alice: " : "bob: ";
+            const int length = w.number(1, 8);
+            for (int i = 0; i < length; ++i) {
+                out += (i == 0) ? "" : " ";
+                out += w.chance(35) ? w.pick(emoji()) : w.pick(chat());
+            }
+            out += '\n';
+            return;
+        }
+        case kind::json: {
+            static const kind languages[] = {kind::english, kind::russian, kind::arabic, kind::hindi, kind::cjk, kind::emoji_chat};
+            out += "{\"id\":";
+            out += std::to_string(w.number(1, 999999));
+            out += ",\"lang\":\"";
+            const kind language = languages[w.number(0, 5)];
+            out += name(language);
+            out += "\",\"text\":\"";
+            std::string text;
+            paragraph(w, language, text);
+            for (const char c : text) {
+                out += (c == '\n') ? ' ' : c;
+            }
+            out += "\",\"score\":";
+            out += std::to_string(w.number(0, 100));
+            out += "},\n";
+            return;
+        }
+    }
+    if (w.chance(15)) {
+        out += '\n';
+    }
+}
+
+}  // namespace detail
+
+// About `size` bytes of UTF-8 text, cut on a code point boundary. The same arguments always give the same text.
+inline auto generate(kind k, std::size_t size) -> std::string {
+    detail::writer w(k);
+    std::string text;
+    text.reserve(size + 256);
+    while (text.size() < size) {
+        detail::paragraph(w, k, text);
+    }
+    std::size_t cut = size;
+    while (cut > 0 && (static_cast<unsigned char>(text[cut]) & 0xC0U) == 0x80U) {
+        --cut;
+    }
+    text.resize(cut);
+    return text;
+}
+
+}  // namespace corpus
+
+#endif  // RAPIDUTF_BENCHMARK_CORPUS_HPP
@@ -0,0 +1,61 @@
+#ifndef RAPIDUTF_BENCHMARK_HEAP_COUNTERS_HPP
+#define RAPIDUTF_BENCHMARK_HEAP_COUNTERS_HPP
+
+// Heap accounting for benchmarks. Linking source/heap_counters.cpp replaces the global operator new and delete,
+// over-aligned forms included, with versions that count every allocation of the program.
+//
+// A heap::scope placed before the benchmark loop reports allocations and allocated bytes per iteration, and the
+// peak of live heap bytes above the level at its construction, alone and per input byte. The peak is program wide,
+// so it is only meaningful for single-threaded benchmarks.
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace heap {
+
+struct totals {
+    std::uint64_t allocations;
+    std::uint64_t allocated_bytes;
+    std::int64_t live_bytes;
+    std::int64_t peak_bytes;
+};
+
+// Counts since program start; the peak is the highest live byte count since the last reset_peak()
+auto current() -> totals;
+
+// Lowers the peak to the bytes live right now
+auto reset_peak() -> void;
+
+class scope {
+public:
+    // `bytes` is the input size of one iteration
+    scope(benchmark::State& state, std::size_t bytes) : m_state(state), m_bytes(bytes) {
+        reset_peak();
+        m_start = current();
+    }
+
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+
+    ~scope() {
+        const totals end = current();
+        const auto peak = static_cast<double>(end.peak_bytes - m_start.live_bytes);
+        m_state.counters["allocs"] = benchmark::Counter(static_cast<double>(end.allocations - m_start.allocations), benchmark::Counter::kAvgIterations);
+        m_state.counters["alloc_B"] = benchmark::Counter(static_cast<double>(end.allocated_bytes - m_start.allocated_bytes), benchmark::Counter::kAvgIterations);
+        m_state.counters["peak_B"] = peak;
+        if (m_bytes != 0) {
+            m_state.counters["peak/B"] = peak / static_cast<double>(m_bytes);
+        }
+    }
+
+private:
+    benchmark::State& m_state;
+    std::size_t m_bytes;
+    totals m_start{};
+};
+
+}  // namespace heap
+
+#endif  // RAPIDUTF_BENCHMARK_HEAP_COUNTERS_HPP
@@ -0,0 +1,135 @@
+#ifndef RAPIDUTF_BENCHMARK_PERF_COUNTERS_HPP
+#define RAPIDUTF_BENCHMARK_PERF_COUNTERS_HPP
+
+// Optional hardware counters for benchmarks, read with perf_event_open on Linux.
+//
+// Set RAPIDUTF_PERF_COUNTERS=1 to enable them. A perf::scope placed before the benchmark loop then reports
+// cycles, instructions, branch misses, L1d and LLC read misses per iteration, plus cycles per input byte.
+// Counters the kernel or the CPU does not provide (perf_event_paranoid, virtual machines) are left out.
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace perf {
+
+inline auto enabled() -> bool {
+    static const bool on = [] {
+        const char* value = std::getenv("RAPIDUTF_PERF_COUNTERS");
+        return value != nullptr && std::strcmp(value, "0") != 0 && value[0] != '\0';
+    }();
+    return on;
+}
+
+#if defined(__linux__)
+
+constexpr auto read_miss(std::uint64_t cache) -> std::uint64_t {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8U) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U);
+}
+
+class scope {
+public:
+    // `bytes` is the input size of one iteration
+    scope(benchmark::State& state, std::size_t bytes) : m_state(state), m_bytes(bytes) {
+        if (!enabled()) {
+            return;
+        }
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            m_fds[i] = open(events[i].type, events[i].config);
+        }
+        if (m_fds[0] < 0) {
+            static bool warned = false;
+            if (!warned) {
+                warned = true;
+                std::fprintf(stderr, "perf_event_open failed (%s); hardware counters are not reported\n", std::strerror(errno));
+            }
+        }
+        for (const int fd : m_fds) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    }
+
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+
+    ~scope() {
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            const int fd = m_fds[i];
+            if (fd < 0) {
+                continue;
+            }
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            // value, time enabled, time running: scale up when the kernel multiplexed the counter
+            std::array<std::uint64_t, 3> reading{};
+            if (read(fd, reading.data(), sizeof(reading)) == static_cast<ssize_t>(sizeof(reading)) && reading[2] != 0) {
+                const double value = static_cast<double>(reading[0]) * static_cast<double>(reading[1]) / static_cast<double>(reading[2]);
+                m_state.counters[events[i].name] = benchmark::Counter(value, benchmark::Counter::kAvgIterations);
+                if (i == 0 && m_bytes != 0 && m_state.iterations() != 0) {
+                    const double bytes = static_cast<double>(m_bytes) * static_cast<double>(m_state.iterations());
+                    m_state.counters["cycles/B"] = benchmark::Counter(value / bytes, benchmark::Counter::kAvgThreads);
+                }
+            }
+            close(fd);
+        }
+    }
+
+private:
+    struct event {
+        const char* name;
+        std::uint32_t type;
+        std::uint64_t config;
+    };
+
+    static constexpr std::array<event, 5> events = {{
+        {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {"L1d-misses", PERF_TYPE_HW_CACHE, read_miss(PERF_COUNT_HW_CACHE_L1D)},
+        {"LLC-misses", PERF_TYPE_HW_CACHE, read_miss(PERF_COUNT_HW_CACHE_LL)},
+    }};
+
+    // Counts the calling thread in user space only, so it works with the default perf_event_paranoid
+    static int open(std::uint32_t type, std::uint64_t config) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    benchmark::State& m_state;
+    std::size_t m_bytes;
+    std::array<int, events.size()> m_fds{-1, -1, -1, -1, -1};
+};
+
+#else
+
+class scope {
+public:
+    scope(benchmark::State&, std::size_t) {}
+};
+
+#endif
+
+}  // namespace perf
+
+#endif  // RAPIDUTF_BENCHMARK_PERF_COUNTERS_HPP
@@ -0,0 +1,131 @@
+#include "heap_counters.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Replacement global allocation functions. Each block carries its size in a header of one fundamental alignment,
+// so unsized deletes can account for it as well. Over-aligned blocks are placed inside a larger malloc block, with
+// the address malloc returned stored in their header after the size.
+
+namespace {
+
+constexpr std::size_t header = alignof(std::max_align_t);
+static_assert(header >= sizeof(std::size_t) + sizeof(void*), "the header holds a size and an address");
+
+std::atomic<std::uint64_t> allocations{0};
+std::atomic<std::uint64_t> allocated_bytes{0};
+std::atomic<std::int64_t> live_bytes{0};
+std::atomic<std::int64_t> peak_bytes{0};
+
+// Records a block of `size` bytes whose header starts at `block`, and returns the memory after the header
+void* track(void* block, std::size_t size) noexcept {
+    *static_cast<std::size_t*>(block) = size;
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    const std::int64_t live = live_bytes.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed) + static_cast<std::int64_t>(size);
+    std::int64_t peak = peak_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return static_cast<char*>(block) + header;
+}
+
+// Returns the header of the block at `pointer` after taking its size off the live bytes
+void* untrack(void* pointer) noexcept {
+    void* block = static_cast<char*>(pointer) - header;
+    live_bytes.fetch_sub(static_cast<std::int64_t>(*static_cast<std::size_t*>(block)), std::memory_order_relaxed);
+    return block;
+}
+
+void* allocate(std::size_t size) noexcept {
+    void* block = std::malloc(size + header);
+    if (block == nullptr) {
+        return nullptr;
+    }
+    return track(block, size);
+}
+
+void* allocate(std::size_t size, std::align_val_t alignment) noexcept {
+    const auto align = static_cast<std::size_t>(alignment);
+    void* block = std::malloc(size + header + align - 1);
+    if (block == nullptr) {
+        return nullptr;
+    }
+    const std::uintptr_t start = (reinterpret_cast<std::uintptr_t>(block) + header + align - 1) & ~(std::uintptr_t{align} - 1);
+    char* aligned_header = reinterpret_cast<char*>(start) - header;
+    std::memcpy(aligned_header + sizeof(std::size_t), &block, sizeof(block));
+    return track(aligned_header, size);
+}
+
+void deallocate(void* pointer) noexcept {
+    if (pointer == nullptr) {
+        return;
+    }
+    std::free(untrack(pointer));
+}
+
+void deallocate(void* pointer, std::align_val_t) noexcept {
+    if (pointer == nullptr) {
+        return;
+    }
+    void* block = nullptr;
+    std::memcpy(&block, static_cast<char*>(untrack(pointer)) + sizeof(std::size_t), sizeof(block));
+    std::free(block);
+}
+
+void* allocate_or_throw(std::size_t size) {
+    void* pointer = allocate(size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* allocate_or_throw(std::size_t size, std::align_val_t alignment) {
+    void* pointer = allocate(size, alignment);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+}  // namespace
+
+namespace heap {
+
+auto current() -> totals {
+    return {allocations.load(std::memory_order_relaxed), allocated_bytes.load(std::memory_order_relaxed), live_bytes.load(std::memory_order_relaxed),
+            peak_bytes.load(std::memory_order_relaxed)};
+}
+
+auto reset_peak() -> void {
+    peak_bytes.store(live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+}  // namespace heap
+
+void* operator new(std::size_t size) { return allocate_or_throw(size); }
+void* operator new[](std::size_t size) { return allocate_or_throw(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* pointer) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { deallocate(pointer); }
+
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate_or_throw(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate_or_throw(size, alignment); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocate(size, alignment); }
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept { deallocate(pointer, alignment); }
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept { deallocate(pointer, alignment); }
+void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept { deallocate(pointer, alignment); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t alignment) noexcept { deallocate(pointer, alignment); }
+void operator delete(void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept { deallocate(pointer, alignment); }
+void operator delete[](void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept { deallocate(pointer, alignment); }
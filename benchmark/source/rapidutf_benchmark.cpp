@@ -1,5 +1,9 @@
 #include <benchmark/benchmark.h>
 #include "rapidutf/rapidutf.hpp"
+#include "corpus.hpp"
+#include "heap_counters.hpp"
+#include "perf_counters.hpp"
+#include <memory>
 #include <string>
 
 using namespace rapidutf;
@@ -8,6 +12,8 @@ using namespace rapidutf;
 
 static void BM_UTF8_to_UTF16_ASCII(benchmark::State& state) {
     std::string utf8(1000000, 'A'); // 1,000,000 ASCII characters
+    perf::scope counters(state, utf8.size() * sizeof(utf8[0]));
+    heap::scope allocations(state, utf8.size() * sizeof(utf8[0]));
     for (auto _ [[maybe_unused]] : state) {
         std::u16string result = converter::utf8_to_utf16(utf8);
         benchmark::DoNotOptimize(result);
@@ -23,6 +29,8 @@ static void BM_UTF8_to_UTF16_NonASCII(benchmark::State& state) {
     for(size_t i = 0; i < 1000000; ++i) {
         utf8.append("世");
     }
+    perf::scope counters(state, utf8.size() * sizeof(utf8[0]));
+    heap::scope allocations(state, utf8.size() * sizeof(utf8[0]));
     for (auto _ [[maybe_unused]] : state) {
         std::u16string result = converter::utf8_to_utf16(utf8);
         benchmark::DoNotOptimize(result);
@@ -37,6 +45,8 @@ BENCHMARK(BM_UTF8_to_UTF16_NonASCII)
 
 static void BM_UTF16_to_UTF8_ASCII(benchmark::State& state) {
     std::u16string utf16(1000000, u'A'); // 1,000,000 ASCII characters
+    perf::scope counters(state, utf16.size() * sizeof(utf16[0]));
+    heap::scope allocations(state, utf16.size() * sizeof(utf16[0]));
     for (auto _ [[maybe_unused]] : state) {
         std::string result = converter::utf16_to_utf8(utf16);
         benchmark::DoNotOptimize(result);
@@ -52,6 +62,8 @@ static void BM_UTF16_to_UTF8_NonASCII(benchmark::State& state) {
     for(size_t i = 0; i < 1000000; ++i) {
         utf16.append(u"世");
     }
+    perf::scope counters(state, utf16.size() * sizeof(utf16[0]));
+    heap::scope allocations(state, utf16.size() * sizeof(utf16[0]));
     for (auto _ [[maybe_unused]] : state) {
         std::string result = converter::utf16_to_utf8(utf16);
         benchmark::DoNotOptimize(result);
@@ -66,6 +78,8 @@ BENCHMARK(BM_UTF16_to_UTF8_NonASCII)
 
 static void BM_UTF32_to_UTF16_ASCII(benchmark::State& state) {
     std::u32string utf32(1000000, U'A'); // 1,000,000 ASCII characters
+    perf::scope counters(state, utf32.size() * sizeof(utf32[0]));
+    heap::scope allocations(state, utf32.size() * sizeof(utf32[0]));
     for (auto _ [[maybe_unused]] : state) {
         std::u16string result = converter::utf32_to_utf16(utf32);
         benchmark::DoNotOptimize(result);
@@ -81,6 +95,8 @@ static void BM_UTF32_to_UTF16_NonASCII(benchmark::State& state) {
     for(size_t i = 0; i < 1000000; ++i) {
         utf32.append(U"世");
     }
+    perf::scope counters(state, utf32.size() * sizeof(utf32[0]));
+    heap::scope allocations(state, utf32.size() * sizeof(utf32[0]));
     for (auto _ [[maybe_unused]] : state) {
         std::u16string result = converter::utf32_to_utf16(utf32);
         benchmark::DoNotOptimize(result);
@@ -95,6 +111,8 @@ BENCHMARK(BM_UTF32_to_UTF16_NonASCII)
 
 static void BM_UTF16_to_UTF32_ASCII(benchmark::State& state) {
     std::u16string utf16(1000000, u'A'); // 1,000,000 ASCII characters
+    perf::scope counters(state, utf16.size() * sizeof(utf16[0]));
+    heap::scope allocations(state, utf16.size() * sizeof(utf16[0]));
     for (auto _ [[maybe_unused]] : state) {
         std::u32string result = converter::utf16_to_utf32(utf16);
         benchmark::DoNotOptimize(result);
@@ -110,6 +128,8 @@ static void BM_UTF16_to_UTF32_NonASCII(benchmark::State& state) {
     for(size_t i = 0; i < 1000000; ++i) {
         utf16.append(u"世");
     }
+    perf::scope counters(state, utf16.size() * sizeof(utf16[0]));
+    heap::scope allocations(state, utf16.size() * sizeof(utf16[0]));
     for (auto _ [[maybe_unused]] : state) {
         std::u32string result = converter::utf16_to_utf32(utf16);
         benchmark::DoNotOptimize(result);
@@ -124,6 +144,8 @@ BENCHMARK(BM_UTF16_to_UTF32_NonASCII)
 
 static void BM_UTF8_to_UTF32_ASCII(benchmark::State& state) {
     std::string utf8(1000000, 'A'); // 1,000,000 ASCII characters
+    perf::scope counters(state, utf8.size() * sizeof(utf8[0]));
+    heap::scope allocations(state, utf8.size() * sizeof(utf8[0]));
     for (auto _ [[maybe_unused]] : state) {
         std::u32string result = converter::utf8_to_utf32(utf8);
         benchmark::DoNotOptimize(result);
@@ -139,6 +161,8 @@ static void BM_UTF8_to_UTF32_NonASCII(benchmark::State& state) {
     for(size_t i = 0; i < 1000000; ++i) {
         utf8.append("世");
     }
+    perf::scope counters(state, utf8.size() * sizeof(utf8[0]));
+    heap::scope allocations(state, utf8.size() * sizeof(utf8[0]));
     for (auto _ [[maybe_unused]] : state) {
         std::u32string result = converter::utf8_to_utf32(utf8);
         benchmark::DoNotOptimize(result);
@@ -153,6 +177,8 @@ BENCHMARK(BM_UTF8_to_UTF32_NonASCII)
 
 static void BM_UTF32_to_UTF8_ASCII(benchmark::State& state) {
     std::u32string utf32(1000000, U'A'); // 1,000,000 ASCII characters
+    perf::scope counters(state, utf32.size() * sizeof(utf32[0]));
+    heap::scope allocations(state, utf32.size() * sizeof(utf32[0]));
     for (auto _ [[maybe_unused]] : state) {
         std::string result = converter::utf32_to_utf8(utf32);
         benchmark::DoNotOptimize(result);
@@ -168,6 +194,8 @@ static void BM_UTF32_to_UTF8_NonASCII(benchmark::State& state) {
     for(size_t i = 0; i < 1000000; ++i) {
         utf32.append(U"世");
     }
+    perf::scope counters(state, utf32.size() * sizeof(utf32[0]));
+    heap::scope allocations(state, utf32.size() * sizeof(utf32[0]));
     for (auto _ [[maybe_unused]] : state) {
         std::string result = converter::utf32_to_utf8(utf32);
         benchmark::DoNotOptimize(result);
@@ -178,4 +206,187 @@ BENCHMARK(BM_UTF32_to_UTF8_NonASCII)
     ->Unit(benchmark::kMillisecond)
     ->DisplayAggregatesOnly(true);
 
+// Code point counting Benchmarks
+
+static void BM_Count_UTF8_NonASCII(benchmark::State& state) {
+    std::string utf8;
+    for(size_t i = 0; i < 1000000; ++i) {
+        utf8.append("世");
+    }
+    perf::scope counters(state, utf8.size() * sizeof(utf8[0]));
+    heap::scope allocations(state, utf8.size() * sizeof(utf8[0]));
+    for (auto _ [[maybe_unused]] : state) {
+        std::size_t count = converter::count_utf8(utf8);
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(utf8.length()));
+}
+BENCHMARK(BM_Count_UTF8_NonASCII)
+    ->Unit(benchmark::kMillisecond)
+    ->DisplayAggregatesOnly(true);
+
+static void BM_Count_UTF16_NonASCII(benchmark::State& state) {
+    std::u16string utf16;
+    for(size_t i = 0; i < 1000000; ++i) {
+        utf16.append(u"😀");
+    }
+    perf::scope counters(state, utf16.size() * sizeof(utf16[0]));
+    heap::scope allocations(state, utf16.size() * sizeof(utf16[0]));
+    for (auto _ [[maybe_unused]] : state) {
+        std::size_t count = converter::count_utf16(utf16);
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(utf16.length()));
+}
+BENCHMARK(BM_Count_UTF16_NonASCII)
+    ->Unit(benchmark::kMillisecond)
+    ->DisplayAggregatesOnly(true);
+
+// Short string latency, lengths in UTF-8 bytes
+
+template <typename Convert>
+static void short_string_benchmark(benchmark::State& state, corpus::kind kind, Convert convert) {
+    const std::string utf8 = corpus::generate(kind, static_cast<std::size_t>(state.range(0)));
+    const auto input = convert.prepare(utf8);
+    perf::scope counters(state, input.size() * sizeof(input[0]));
+    heap::scope allocations(state, input.size() * sizeof(input[0]));
+    for (auto _ [[maybe_unused]] : state) {
+        auto result = convert(input);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+struct short_utf8_to_utf16 {
+    std::string prepare(const std::string& utf8) const { return utf8; }
+    std::u16string operator()(const std::string& s) const { return converter::utf8_to_utf16(s); }
+};
+struct short_utf16_to_utf8 {
+    std::u16string prepare(const std::string& utf8) const { return converter::utf8_to_utf16(utf8); }
+    std::string operator()(const std::u16string& s) const { return converter::utf16_to_utf8(s); }
+};
+struct short_utf8_to_utf32 {
+    std::string prepare(const std::string& utf8) const { return utf8; }
+    std::u32string operator()(const std::string& s) const { return converter::utf8_to_utf32(s); }
+};
+struct short_utf32_to_utf8 {
+    std::u32string prepare(const std::string& utf8) const { return converter::utf8_to_utf32(utf8); }
+    std::string operator()(const std::u32string& s) const { return converter::utf32_to_utf8(s); }
+};
+struct short_utf16_to_utf32 {
+    std::u16string prepare(const std::string& utf8) const { return converter::utf8_to_utf16(utf8); }
+    std::u32string operator()(const std::u16string& s) const { return converter::utf16_to_utf32(s); }
+};
+struct short_utf32_to_utf16 {
+    std::u32string prepare(const std::string& utf8) const { return converter::utf8_to_utf32(utf8); }
+    std::u16string operator()(const std::u32string& s) const { return converter::utf32_to_utf16(s); }
+};
+
+BENCHMARK_CAPTURE(short_string_benchmark, UTF8_to_UTF16_English, corpus::kind::english, short_utf8_to_utf16{})
+    ->DenseRange(0, 128, 8)
+    ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(short_string_benchmark, UTF8_to_UTF16_CJK, corpus::kind::cjk, short_utf8_to_utf16{})
+    ->DenseRange(0, 128, 8)
+    ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(short_string_benchmark, UTF16_to_UTF8_English, corpus::kind::english, short_utf16_to_utf8{})
+    ->DenseRange(0, 128, 8)
+    ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(short_string_benchmark, UTF16_to_UTF8_CJK, corpus::kind::cjk, short_utf16_to_utf8{})
+    ->DenseRange(0, 128, 8)
+    ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(short_string_benchmark, UTF8_to_UTF32_English, corpus::kind::english, short_utf8_to_utf32{})
+    ->DenseRange(0, 128, 8)
+    ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(short_string_benchmark, UTF32_to_UTF8_English, corpus::kind::english, short_utf32_to_utf8{})
+    ->DenseRange(0, 128, 8)
+    ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(short_string_benchmark, UTF16_to_UTF32_English, corpus::kind::english, short_utf16_to_utf32{})
+    ->DenseRange(0, 128, 8)
+    ->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(short_string_benchmark, UTF32_to_UTF16_English, corpus::kind::english, short_utf32_to_utf16{})
+    ->DenseRange(0, 128, 8)
+    ->Unit(benchmark::kNanosecond);
+
+// Inputs larger than the last-level cache, where the conversions switch to input prefetch and, for caller-owned
+// destinations, streaming stores. Converts into a reused buffer so the allocator stays out of the measurement; sizes in
+// UTF-8 bytes.
+
+template <typename Convert>
+static void large_input_benchmark(benchmark::State& state, corpus::kind kind, Convert convert) {
+    const auto input = convert.prepare(corpus::generate(kind, static_cast<std::size_t>(state.range(0))));
+    decltype(convert(input)) output;
+    perf::scope counters(state, input.size() * sizeof(input[0]));
+    for (auto _ [[maybe_unused]] : state) {
+        convert(input, output);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(input.size() * sizeof(input[0])));
+}
+
+struct large_utf8_to_utf16 : short_utf8_to_utf16 {
+    using short_utf8_to_utf16::operator();
+    void operator()(const std::string& s, std::u16string& out) const { converter::utf8_to_utf16(s, out); }
+};
+struct large_utf8_to_utf32 : short_utf8_to_utf32 {
+    using short_utf8_to_utf32::operator();
+    void operator()(const std::string& s, std::u32string& out) const { converter::utf8_to_utf32(s, out); }
+};
+
+// The same conversions into storage the library never initializes, written through the pointer overloads. All-ASCII
+// input is one long run, so it is widened almost entirely with streaming stores.
+
+static std::string ascii_input(std::size_t size) { return std::string(size, 'A'); }
+static std::string english_input(std::size_t size) { return corpus::generate(corpus::kind::english, size); }
+
+template <typename Convert>
+static void large_buffer_benchmark(benchmark::State& state, std::string (*generate)(std::size_t), Convert convert) {
+    const std::string input = generate(static_cast<std::size_t>(state.range(0)));
+    const std::size_t capacity = convert.length(input);
+    const std::unique_ptr<typename Convert::unit[]> output(new typename Convert::unit[capacity]);
+    convert(input, output.get(), capacity);  // Maps the pages, so the loop measures the stores and not page faults
+    perf::scope counters(state, input.size());
+    for (auto _ [[maybe_unused]] : state) {
+        benchmark::DoNotOptimize(convert(input, output.get(), capacity));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(input.size()));
+}
+
+struct buffer_utf8_to_utf16 {
+    using unit = char16_t;
+    std::size_t length(const std::string& s) const { return converter::utf16_length_from_utf8(s); }
+    std::size_t operator()(const std::string& s, char16_t* out, std::size_t capacity) const { return converter::utf8_to_utf16(s, out, capacity); }
+};
+struct buffer_utf8_to_utf32 {
+    using unit = char32_t;
+    std::size_t length(const std::string& s) const { return converter::count_utf8(s); }
+    std::size_t operator()(const std::string& s, char32_t* out, std::size_t capacity) const { return converter::utf8_to_utf32(s, out, capacity); }
+};
+
+BENCHMARK_CAPTURE(large_input_benchmark, UTF8_to_UTF16_English, corpus::kind::english, large_utf8_to_utf16{})
+    ->Arg(512 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(large_input_benchmark, UTF8_to_UTF16_CJK, corpus::kind::cjk, large_utf8_to_utf16{})
+    ->Arg(512 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(large_input_benchmark, UTF8_to_UTF32_English, corpus::kind::english, large_utf8_to_utf32{})
+    ->Arg(512 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(large_input_benchmark, UTF8_to_UTF32_CJK, corpus::kind::cjk, large_utf8_to_utf32{})
+    ->Arg(512 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(large_buffer_benchmark, UTF8_to_UTF16_ASCII, ascii_input, buffer_utf8_to_utf16{})
+    ->Arg(512 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(large_buffer_benchmark, UTF8_to_UTF16_English, english_input, buffer_utf8_to_utf16{})
+    ->Arg(512 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(large_buffer_benchmark, UTF8_to_UTF32_ASCII, ascii_input, buffer_utf8_to_utf32{})
+    ->Arg(512 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(large_buffer_benchmark, UTF8_to_UTF32_English, english_input, buffer_utf8_to_utf32{})
+    ->Arg(512 << 20)
+    ->Unit(benchmark::kMillisecond);
+
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include "rapidutf/rapidutf.hpp"
+#include "corpus.hpp"
+#include "heap_counters.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+using namespace rapidutf;
+
+// Conversions over generated language corpora, from 16 B to 64 MB of UTF-8 source text.
+// The GB counter is the input of each conversion in 10^9 bytes per second, chars counts code points per second.
+// allocs, alloc_B and peak_B are the heap allocations, allocated bytes and peak live bytes of one conversion.
+
+namespace {
+
+enum class conversion { utf8_to_utf16, utf8_to_utf32, utf16_to_utf8, utf16_to_utf32, utf32_to_utf8, utf32_to_utf16 };
+
+const std::int64_t sizes[] = {16, 256, 4 << 10, 64 << 10, 1 << 20, 16 << 20, 64 << 20};
+
+// Benchmarks run corpus by corpus, so only the texts of the current corpus are kept
+const std::string& corpus_text(corpus::kind kind, std::size_t size) {
+    static corpus::kind cached_kind = corpus::kind::english;
+    static std::map<std::size_t, std::string> texts;
+    if (kind != cached_kind) {
+        texts.clear();
+        cached_kind = kind;
+    }
+    auto it = texts.find(size);
+    if (it == texts.end()) {
+        it = texts.emplace(size, corpus::generate(kind, size)).first;
+    }
+    return it->second;
+}
+
+template <typename Input, typename Convert>
+void run(benchmark::State& state, const Input& input, std::size_t chars, Convert convert) {
+    heap::scope allocations(state, input.size() * sizeof(typename Input::value_type));
+    for (auto _ [[maybe_unused]] : state) {
+        auto result = convert(input);
+        benchmark::DoNotOptimize(result);
+    }
+    const double bytes = static_cast<double>(input.size() * sizeof(typename Input::value_type));
+    state.counters["GB"] = benchmark::Counter(bytes / 1e9, benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["chars"] = benchmark::Counter(static_cast<double>(chars), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void BM_Corpus(benchmark::State& state, corpus::kind kind, conversion type) {
+    const std::string& utf8 = corpus_text(kind, static_cast<std::size_t>(state.range(0)));
+    const std::size_t chars = converter::count_utf8(utf8);
+    switch (type) {
+        case conversion::utf8_to_utf16:
+            run(state, utf8, chars, [](const std::string& s) { return converter::utf8_to_utf16(s); });
+            break;
+        case conversion::utf8_to_utf32:
+            run(state, utf8, chars, [](const std::string& s) { return converter::utf8_to_utf32(s); });
+            break;
+        case conversion::utf16_to_utf8:
+            run(state, converter::utf8_to_utf16(utf8), chars, [](const std::u16string& s) { return converter::utf16_to_utf8(s); });
+            break;
+        case conversion::utf16_to_utf32:
+            run(state, converter::utf8_to_utf16(utf8), chars, [](const std::u16string& s) { return converter::utf16_to_utf32(s); });
+            break;
+        case conversion::utf32_to_utf8:
+            run(state, converter::utf8_to_utf32(utf8), chars, [](const std::u32string& s) { return converter::utf32_to_utf8(s); });
+            break;
+        case conversion::utf32_to_utf16:
+            run(state, converter::utf8_to_utf32(utf8), chars, [](const std::u32string& s) { return converter::utf32_to_utf16(s); });
+            break;
+    }
+}
+
+void register_benchmarks() {
+    const std::pair<conversion, const char*> conversions[] = {
+        {conversion::utf8_to_utf16, "UTF8_to_UTF16"},   {conversion::utf8_to_utf32, "UTF8_to_UTF32"},
+        {conversion::utf16_to_utf8, "UTF16_to_UTF8"},   {conversion::utf16_to_utf32, "UTF16_to_UTF32"},
+        {conversion::utf32_to_utf8, "UTF32_to_UTF8"},   {conversion::utf32_to_utf16, "UTF32_to_UTF16"},
+    };
+    for (const corpus::kind kind : corpus::all()) {
+        for (const auto& [type, label] : conversions) {
+            const std::string name = std::string("BM_Corpus_") + label + "/" + corpus::name(kind);
+            auto* bench = benchmark::RegisterBenchmark(name.c_str(), BM_Corpus, kind, type);
+            for (const std::int64_t size : sizes) {
+                bench->Arg(size);
+            }
+            bench->Unit(benchmark::kMicrosecond);
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    register_benchmarks();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
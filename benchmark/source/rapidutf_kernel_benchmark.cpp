@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+#include "rapidutf/rapidutf.hpp"
+#include "corpus.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+
+using namespace rapidutf;
+
+// Every compiled backend of every kernel on the same inputs, so a SIMD path can be compared with the portable
+// fallback directly. Each kernel's result is checked against the public entry point before timing.
+
+namespace {
+
+const corpus::kind kinds[] = {corpus::kind::english, corpus::kind::russian, corpus::kind::cjk, corpus::kind::emoji_chat};
+const std::int64_t sizes[] = {4 << 10, 64 << 10, 4 << 20};
+
+const std::string& corpus_text(corpus::kind kind, std::size_t size) {
+    static std::map<std::pair<corpus::kind, std::size_t>, std::string> texts;
+    auto it = texts.find({kind, size});
+    if (it == texts.end()) {
+        it = texts.emplace(std::make_pair(kind, size), corpus::generate(kind, size)).first;
+    }
+    return it->second;
+}
+
+template <typename Input, typename Kernel, typename Reference>
+void run(benchmark::State& state, const Input& input, Kernel kernel, Reference reference) {
+    if (kernel(input) != reference(input)) {
+        state.SkipWithError("kernel result differs from the public entry point");
+        return;
+    }
+    for (auto _ [[maybe_unused]] : state) {
+        auto result = kernel(input);
+        benchmark::DoNotOptimize(result);
+    }
+    const double bytes = static_cast<double>(input.size() * sizeof(typename Input::value_type));
+    state.counters["GB"] = benchmark::Counter(bytes / 1e9, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+using bench_function = std::function<void(benchmark::State&, const detail::kernel_table&, const std::string&)>;
+
+const std::pair<const char*, bench_function> kernels[] = {
+    {"UTF8_to_UTF16", [](benchmark::State& state, const detail::kernel_table& k, const std::string& utf8) {
+         run(state, utf8, k.utf8_to_utf16, [](const std::string& s) { return converter::utf8_to_utf16(s); });
+     }},
+    {"UTF8_to_UTF32", [](benchmark::State& state, const detail::kernel_table& k, const std::string& utf8) {
+         run(state, utf8, k.utf8_to_utf32, [](const std::string& s) { return converter::utf8_to_utf32(s); });
+     }},
+    {"UTF16_to_UTF8", [](benchmark::State& state, const detail::kernel_table& k, const std::string& utf8) {
+         run(state, converter::utf8_to_utf16(utf8), k.utf16_to_utf8, [](const std::u16string& s) { return converter::utf16_to_utf8(s); });
+     }},
+    {"UTF16_to_UTF32", [](benchmark::State& state, const detail::kernel_table& k, const std::string& utf8) {
+         run(state, converter::utf8_to_utf16(utf8), k.utf16_to_utf32, [](const std::u16string& s) { return converter::utf16_to_utf32(s); });
+     }},
+    {"UTF32_to_UTF8", [](benchmark::State& state, const detail::kernel_table& k, const std::string& utf8) {
+         run(state, converter::utf8_to_utf32(utf8), k.utf32_to_utf8, [](const std::u32string& s) { return converter::utf32_to_utf8(s); });
+     }},
+    {"UTF32_to_UTF16", [](benchmark::State& state, const detail::kernel_table& k, const std::string& utf8) {
+         run(state, converter::utf8_to_utf32(utf8), k.utf32_to_utf16, [](const std::u32string& s) { return converter::utf32_to_utf16(s); });
+     }},
+    {"Count_UTF8", [](benchmark::State& state, const detail::kernel_table& k, const std::string& utf8) {
+         run(state, utf8, k.count_utf8, [](const std::string& s) { return converter::count_utf8(s); });
+     }},
+    {"Count_UTF16", [](benchmark::State& state, const detail::kernel_table& k, const std::string& utf8) {
+         run(state, converter::utf8_to_utf16(utf8), k.count_utf16, [](const std::u16string& s) { return converter::count_utf16(s); });
+     }},
+};
+
+void register_benchmarks() {
+    static const std::vector<detail::kernel_table> tables = detail::kernel_tables();
+    for (const auto& [label, function] : kernels) {
+        for (const corpus::kind kind : kinds) {
+            for (const auto& table : tables) {
+                const std::string name = std::string("BM_Kernel_") + label + "/" + corpus::name(kind) + "/" + table.backend;
+                auto* bench = benchmark::RegisterBenchmark(name.c_str(), [kind, &table, &function = function](benchmark::State& state) {
+                    function(state, table, corpus_text(kind, static_cast<std::size_t>(state.range(0))));
+                });
+                for (const std::int64_t size : sizes) {
+                    bench->Arg(size);
+                }
+                bench->Unit(benchmark::kMicrosecond);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    register_benchmarks();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <benchmark/benchmark.h>
+#include "rapidutf/rapidutf.hpp"
+#include "corpus.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+using namespace rapidutf;
+
+// The same conversion from 1 to 64 threads at once over a shared input, to find where concurrent callers stop
+// scaling. "alloc" calls the value-returning API, so every conversion goes through the allocator; "reuse" converts
+// into a per-thread buffer that stops allocating after the first iteration. Times are wall clock: GB is the
+// aggregate input throughput of all threads, GB/thread the average per thread, which stays flat while scaling is
+// linear and drops once the allocator or memory bandwidth becomes the limit.
+
+namespace {
+
+const corpus::kind kinds[] = {corpus::kind::english, corpus::kind::cjk};
+const std::int64_t sizes[] = {64, 4 << 10, 1 << 20};
+constexpr int max_threads = 64;
+
+// Filled before any benchmark runs, so threads only ever read it
+std::map<std::pair<corpus::kind, std::size_t>, std::pair<std::string, std::u16string>> texts;
+
+void generate_texts() {
+    for (const corpus::kind kind : kinds) {
+        for (const std::int64_t size : sizes) {
+            std::string utf8 = corpus::generate(kind, static_cast<std::size_t>(size));
+            std::u16string utf16 = converter::utf8_to_utf16(utf8);
+            texts.emplace(std::make_pair(kind, static_cast<std::size_t>(size)), std::make_pair(std::move(utf8), std::move(utf16)));
+        }
+    }
+}
+
+template <typename Input>
+void set_counters(benchmark::State& state, const Input& input) {
+    // Counters are summed over threads and multiplied by the iterations of all threads, hence kAvgThreads
+    const double gigabytes = static_cast<double>(input.size() * sizeof(typename Input::value_type)) / 1e9;
+    const auto flags = benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kAvgThreads;
+    state.counters["GB"] = benchmark::Counter(gigabytes, flags);
+    state.counters["GB/thread"] = benchmark::Counter(gigabytes / state.threads(), flags);
+}
+
+template <typename Input, typename Convert>
+void run_alloc(benchmark::State& state, const Input& input, Convert convert) {
+    for (auto _ [[maybe_unused]] : state) {
+        auto result = convert(input);
+        benchmark::DoNotOptimize(result);
+    }
+    set_counters(state, input);
+}
+
+template <typename Output, typename Input, typename Convert>
+void run_reuse(benchmark::State& state, const Input& input, Convert convert) {
+    Output output;
+    for (auto _ [[maybe_unused]] : state) {
+        convert(input, output);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    set_counters(state, input);
+}
+
+void BM_UTF8_to_UTF16_alloc(benchmark::State& state, corpus::kind kind) {
+    const std::string& utf8 = texts.at({kind, static_cast<std::size_t>(state.range(0))}).first;
+    run_alloc(state, utf8, [](const std::string& s) { return converter::utf8_to_utf16(s); });
+}
+
+void BM_UTF8_to_UTF16_reuse(benchmark::State& state, corpus::kind kind) {
+    const std::string& utf8 = texts.at({kind, static_cast<std::size_t>(state.range(0))}).first;
+    run_reuse<std::u16string>(state, utf8, [](const std::string& s, std::u16string& out) { converter::utf8_to_utf16(s, out); });
+}
+
+void BM_UTF16_to_UTF8_alloc(benchmark::State& state, corpus::kind kind) {
+    const std::u16string& utf16 = texts.at({kind, static_cast<std::size_t>(state.range(0))}).second;
+    run_alloc(state, utf16, [](const std::u16string& s) { return converter::utf16_to_utf8(s); });
+}
+
+void BM_UTF16_to_UTF8_reuse(benchmark::State& state, corpus::kind kind) {
+    const std::u16string& utf16 = texts.at({kind, static_cast<std::size_t>(state.range(0))}).second;
+    run_reuse<std::string>(state, utf16, [](const std::u16string& s, std::string& out) { converter::utf16_to_utf8(s, out); });
+}
+
+void register_benchmarks() {
+    const std::pair<const char*, void (*)(benchmark::State&, corpus::kind)> functions[] = {
+        {"BM_Threads_UTF8_to_UTF16/alloc", BM_UTF8_to_UTF16_alloc},
+        {"BM_Threads_UTF8_to_UTF16/reuse", BM_UTF8_to_UTF16_reuse},
+        {"BM_Threads_UTF16_to_UTF8/alloc", BM_UTF16_to_UTF8_alloc},
+        {"BM_Threads_UTF16_to_UTF8/reuse", BM_UTF16_to_UTF8_reuse},
+    };
+    for (const auto& [label, function] : functions) {
+        for (const corpus::kind kind : kinds) {
+            const std::string name = std::string(label) + "/" + corpus::name(kind);
+            auto* bench = benchmark::RegisterBenchmark(name.c_str(), function, kind);
+            for (const std::int64_t size : sizes) {
+                bench->Arg(size);
+            }
+            bench->ThreadRange(1, max_threads)->UseRealTime()->Unit(benchmark::kMicrosecond);
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    generate_texts();
+    register_benchmarks();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -1,16 +1,28 @@
 #ifndef CONVERTER_HPP
 #define CONVERTER_HPP
 
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 #include <cwchar>
 
+#include "rapidutf/rapidutf_export.hpp"
+
 #if WCHAR_MAX > 0xFFFFu
 #  define RAPIDUTF_WCHAR_T_IS_WIDE
 #endif
 
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#  define RAPIDUTF_BIG_ENDIAN
+#endif
+
 
 // #undef RAPIDUTF_USE_NEON
 // #undef RAPIDUTF_USE_AVX2
@@ -18,14 +30,163 @@
 namespace rapidutf
 {
 
-class converter
+// Byte order of UTF-16 and UTF-32 code units. `native` aliases the byte order of the host.
+enum class byte_order
+{
+  little,
+  big,
+#if defined(RAPIDUTF_BIG_ENDIAN)
+  native = big,
+#else
+  native = little,
+#endif
+};
+
+// Encodings reported by converter::detect_encoding
+enum class encoding
+{
+  unknown,
+  utf8,
+  utf16_le,
+  utf16_be,
+  utf32_le,
+  utf32_be,
+};
+
+// Bytes per character of the fixed-width forms produced by converter::utf8_to_narrowest
+enum class char_width
+{
+  latin1 = 1,
+  ucs2 = 2,
+  ucs4 = 4,
+};
+
+// Text in the narrowest fixed-width form that holds all of its code points; only the member named by `width` is filled
+struct narrow_text
+{
+  char_width width = char_width::latin1;
+  std::string latin1;
+  std::u16string ucs2;
+  std::u32string ucs4;
+};
+
+// Units of a position in UTF-8 text, see converter::translate_offset
+enum class offset_unit
+{
+  utf8,  // bytes
+  utf16,  // UTF-16 code units, as in language server positions
+  code_point,
+};
+
+// Half-open range of positions in one offset_unit
+struct text_range
+{
+  std::size_t begin = 0;
+  std::size_t end = 0;
+};
+
+// Conversion directions, the index of runtime_stats::conversions
+enum class conversion
+{
+  utf8_to_utf16,
+  utf16_to_utf8,
+  utf16_to_utf32,
+  utf32_to_utf16,
+  utf8_to_utf32,
+  utf32_to_utf8,
+};
+
+// Instruction sets the conversions run on, see converter::active_backend
+enum class backend
+{
+  scalar,
+  avx2,
+  neon,
+};
+
+// Usage counters of one conversion direction, summed over all threads. Bytes are input bytes.
+struct conversion_stats
+{
+  std::uint64_t calls = 0;
+  std::uint64_t invalid_input = 0;  // calls that threw
+  std::uint64_t small_input_bytes = 0;  // converted without a kernel, see the short input path
+  std::uint64_t simd_bytes = 0;  // given to the AVX2 or NEON kernel
+  std::uint64_t simd_scalar_bytes = 0;  // the part of simd_bytes the SIMD kernel handed to scalar code
+  std::uint64_t scalar_transitions = 0;  // blocks and tails the SIMD kernel handed to scalar code
+  std::uint64_t fallback_bytes = 0;  // converted by the portable kernel
+};
+
+// Snapshot returned by converter::stats(). Counting is compiled in only with RAPIDUTF_ENABLE_STATS, otherwise
+// `enabled` is false and every counter stays zero.
+struct runtime_stats
+{
+  bool enabled = false;
+  std::array<conversion_stats, 6> conversions {};
+
+  auto operator[](conversion direction) const -> const conversion_stats & { return conversions.at(static_cast<std::size_t>(direction)); }
+};
+
+template<typename Unit>
+class code_point_view;
+
+namespace detail
+{
+struct kernel_table;
+
+// The SIMD backend compiled into the library, if any, followed by the portable fallback
+RAPIDUTF_EXPORT auto kernel_tables() -> std::vector<kernel_table>;
+
+// Code unit types accepted by converter::transcode; their size selects UTF-8, UTF-16 or UTF-32
+template<typename Unit>
+constexpr bool is_code_unit = std::is_same_v<Unit, char> || std::is_same_v<Unit, char16_t> || std::is_same_v<Unit, char32_t> || std::is_same_v<Unit, wchar_t>
+#if defined(__cpp_char8_t)
+                              || std::is_same_v<Unit, char8_t>
+#endif
+    ;
+
+// The unit type the kernels work on for each UTF form
+template<std::size_t Size>
+struct native_unit;
+template<>
+struct native_unit<1>
+{
+  using type = char;
+};
+template<>
+struct native_unit<2>
+{
+  using type = char16_t;
+};
+template<>
+struct native_unit<4>
+{
+  using type = char32_t;
+};
+template<typename Unit>
+using native_unit_t = typename native_unit<sizeof(Unit)>::type;
+
+// Outputs that are filled as a block: contiguous storage with resize(); anything else is used as an output iterator
+template<typename Output, typename = void>
+struct is_resizable_contiguous : std::false_type
+{
+};
+template<typename Output>
+struct is_resizable_contiguous<Output, std::void_t<decltype(std::declval<Output &>().data()), decltype(std::declval<Output &>().resize(std::size_t {}))>> : std::true_type
+{
+};
+}  // namespace detail
+
+class RAPIDUTF_EXPORT converter
 {
 public:
   static auto is_valid_utf8_sequence(const unsigned char *bytes, int length) -> bool;
-  static auto is_valid_utf8(const std::string &utf8) -> bool;
+  static auto is_valid_utf8(std::string_view utf8) -> bool;
   static auto is_valid_utf16(const std::u16string &utf16) -> bool;
   static auto is_valid_utf32(const std::u32string &utf32) -> bool;
+  static auto is_valid_utf16(std::u16string_view utf16, byte_order order) -> bool;
+  static auto is_valid_utf32(std::u32string_view utf32, byte_order order) -> bool;
 
+  // Defined inline below: short inputs that need no transcoding are converted at the call site
   static auto utf8_to_utf16(const std::string &utf8) -> std::u16string;
   static auto utf16_to_utf8(const std::u16string &utf16) -> std::string;
   static auto utf16_to_utf32(const std::u16string &utf16) -> std::u32string;
@@ -33,42 +194,963 @@ public:
   static auto utf8_to_utf32(const std::string &utf8) -> std::u32string;
   static auto utf32_to_utf8(const std::u32string &utf32) -> std::string;
 
+  // Byte-order aware variants. `order` (or `from`/`to`) describes the UTF-16/UTF-32 side; non-native
+  // input is byte-swapped inside the kernels' loads rather than in a separate pass, and non-native output inside their
+  // stores.
+  static auto utf8_to_utf16(const std::string &utf8, byte_order order) -> std::u16string;
+  static auto utf16_to_utf8(const std::u16string &utf16, byte_order order) -> std::string;
+  static auto utf16_to_utf32(const std::u16string &utf16, byte_order from, byte_order to) -> std::u32string;
+  static auto utf32_to_utf16(const std::u32string &utf32, byte_order from, byte_order to) -> std::u16string;
+  static auto utf8_to_utf32(const std::string &utf8, byte_order order) -> std::u32string;
+  static auto utf32_to_utf8(const std::u32string &utf32, byte_order order) -> std::string;
+
+  // Buffer-reuse variants: the output replaces the contents of the second argument and keeps its capacity, so a
+  // caller converting in a loop stops allocating once the buffer is large enough. The output is unspecified on error.
+  static auto utf8_to_utf16(std::string_view utf8, std::u16string &utf16, byte_order order = byte_order::native) -> void;
+  static auto utf16_to_utf8(std::u16string_view utf16, std::string &utf8, byte_order order = byte_order::native) -> void;
+  static auto utf16_to_utf32(std::u16string_view utf16, std::u32string &utf32, byte_order from = byte_order::native, byte_order to = byte_order::native) -> void;
+  static auto utf32_to_utf16(std::u32string_view utf32, std::u16string &utf16, byte_order from = byte_order::native, byte_order to = byte_order::native) -> void;
+  static auto utf8_to_utf32(std::string_view utf8, std::u32string &utf32, byte_order order = byte_order::native) -> void;
+  static auto utf32_to_utf8(std::u32string_view utf32, std::string &utf8, byte_order order = byte_order::native) -> void;
+
+  // Pointer variants for caller-owned storage such as a std::vector or a memory-mapped file: the kernels write
+  // straight to `output`, which has room for `capacity` units and must hold the whole result (the *_length_from_*
+  // functions and the code point counts give its exact size for well-formed input). Return the number of units
+  // written; invalid input, or a result that does not fit, throws and leaves the destination unspecified. Large
+  // UTF-8 inputs widen their ASCII runs into `output` with streaming stores that bypass the cache, so storage that is
+  // allocated but not yet written, such as a fresh mapping, is not read in first.
+  static auto utf8_to_utf16(std::string_view utf8, char16_t *output, std::size_t capacity, byte_order order = byte_order::native) -> std::size_t;
+  static auto utf16_to_utf8(std::u16string_view utf16, char *output, std::size_t capacity, byte_order order = byte_order::native) -> std::size_t;
+  static auto utf16_to_utf32(std::u16string_view utf16, char32_t *output, std::size_t capacity, byte_order from = byte_order::native, byte_order to = byte_order::native) -> std::size_t;
+  static auto utf32_to_utf16(std::u32string_view utf32, char16_t *output, std::size_t capacity, byte_order from = byte_order::native, byte_order to = byte_order::native) -> std::size_t;
+  static auto utf8_to_utf32(std::string_view utf8, char32_t *output, std::size_t capacity, byte_order order = byte_order::native) -> std::size_t;
+  static auto utf32_to_utf8(std::u32string_view utf32, char *output, std::size_t capacity, byte_order order = byte_order::native) -> std::size_t;
+
+  static auto swap_byte_order(std::u16string &utf16) -> void;
+  static auto swap_byte_order(std::u32string &utf32) -> void;
+  static auto swap_byte_order(char16_t *utf16, std::size_t length) -> void;
+  static auto swap_byte_order(char32_t *utf32, std::size_t length) -> void;
+
+  // Encoding detection: a byte order mark wins, otherwise heuristics run over a bounded prefix of the input
+  static auto detect_encoding(const void *data, std::size_t length) -> encoding;
+  static auto bom_length(const void *data, std::size_t length) -> std::size_t;
+
+  // Code point counts of well-formed input, computed without decoding or allocating
+  static auto count_utf8(std::string_view utf8) -> std::size_t;
+  static auto count_utf16(std::u16string_view utf16, byte_order order = byte_order::native) -> std::size_t;
+
+  // Exact code unit counts of the conversion of well-formed input, computed without converting; used to size
+  // output buffers up front. `order` describes UTF-16/UTF-32 input.
+  static auto utf16_length_from_utf8(std::string_view utf8) -> std::size_t;
+  static auto utf8_length_from_utf16(std::u16string_view utf16, byte_order order = byte_order::native) -> std::size_t;
+  static auto utf8_length_from_utf32(std::u32string_view utf32, byte_order order = byte_order::native) -> std::size_t;
+  static auto utf16_length_from_utf32(std::u32string_view utf32, byte_order order = byte_order::native) -> std::size_t;
+
+  // Offset just past the first `count` code points of native-order input, or its length when it holds fewer. The
+  // input is counted in blocks of at most `count` units with the SIMD kernels, so no block can overshoot.
+  static auto skip_code_points(std::string_view utf8, std::size_t count) -> std::size_t;
+  static auto skip_code_points(std::u16string_view utf16, std::size_t count) -> std::size_t;
+
+  // Positions in well-formed UTF-8 translated between bytes, UTF-16 units and code points by counting, without
+  // converting the text. Positions inside a sequence or surrogate pair round up to the next code point and positions
+  // past the end clamp to it. The batch form sorts its offsets and counts the text once for all of them; for many
+  // lookups spread over a large text, utf8_offset_index::translate starts from the nearest checkpoint instead.
+  static auto translate_offset(std::string_view utf8, std::size_t offset, offset_unit from, offset_unit to) -> std::size_t;
+  static auto translate_range(std::string_view utf8, text_range range, offset_unit from, offset_unit to) -> text_range;
+  static auto translate_offsets(std::string_view utf8, std::vector<std::size_t> &offsets, offset_unit from, offset_unit to) -> void;
+
+  // Longest prefix of well-formed native-order text within a limit that does not cut a code point: a byte limit backs
+  // off at most 3 bytes, a unit limit at most the high half of a surrogate pair. The *_code_points variants keep the
+  // first `count` code points, found with skip_code_points.
+  static auto truncate_utf8(std::string_view utf8, std::size_t max_bytes) -> std::string_view;
+  static auto truncate_utf16(std::u16string_view utf16, std::size_t max_units) -> std::u16string_view;
+  static auto truncate_utf8_code_points(std::string_view utf8, std::size_t count) -> std::string_view;
+  static auto truncate_utf16_code_points(std::u16string_view utf16, std::size_t count) -> std::u16string_view;
+
+  // Consecutive pieces of at most `chunk_size` units, each ending on a code point boundary; chunk_size must hold the
+  // longest sequence (4 bytes, 2 UTF-16 units)
+  static auto split_at_boundaries(std::string_view utf8, std::size_t chunk_size) -> std::vector<std::string_view>;
+  static auto split_at_boundaries(std::u16string_view utf16, std::size_t chunk_size) -> std::vector<std::u16string_view>;
+
+  // Lazy views over the code points of native-order text, decoded while iterating instead of into a UTF-32 copy
+  static auto utf8_codepoints(std::string_view utf8) -> code_point_view<char>;
+  static auto utf16_codepoints(std::u16string_view utf16) -> code_point_view<char16_t>;
+
+  // ASCII checks; find_first_non_ascii returns the length of the input when every byte is ASCII
+  static auto is_ascii(std::string_view utf8) -> bool;
+  static auto find_first_non_ascii(std::string_view utf8) -> std::size_t;
+
+  // Decodes UTF-8 into Latin-1, UCS-2 or UCS-4, whichever is the narrowest that fits (PEP 393 style)
+  static auto utf8_to_narrowest(const std::string &utf8) -> narrow_text;
+
   static auto utf8_to_wide(const std::string &utf8) -> std::wstring;
   static auto wide_to_utf8(const std::wstring &wide) -> std::string;
 
+  // Scalar conversions usable in constant expressions, for tables of literals that would otherwise be converted at
+  // startup. Invalid input throws, which inside a constant expression is a compile error; N must equal the length
+  // of the result. RAPIDUTF_UTF16_LITERAL and RAPIDUTF_UTF32_LITERAL size the array and force compile-time evaluation.
+  static constexpr auto utf16_length_of(std::string_view utf8) -> std::size_t;
+  static constexpr auto utf32_length_of(std::string_view utf8) -> std::size_t;
+  template<std::size_t N>
+  static constexpr auto utf8_to_utf16_array(std::string_view utf8) -> std::array<char16_t, N>;
+  template<std::size_t N>
+  static constexpr auto utf8_to_utf32_array(std::string_view utf8) -> std::array<char32_t, N>;
+
+  // Generic front end over code unit types. From and To are char, char16_t, char32_t, wchar_t or char8_t and select
+  // UTF-8, UTF-16 or UTF-32 by their size; `input` is any contiguous range of From and is read in place (except
+  // wchar_t, which is copied to the matching char16_t/char32_t first). Resizable contiguous containers are sized with
+  // the length functions and written by the kernels in place (wchar_t ones receive a copy), and any other output is an
+  // output iterator that a scalar loop writes to and returns past the last unit.
+  template<typename From, typename To, typename Input, typename Output>
+  static auto transcode(const Input &input, Output &output) -> std::enable_if_t<detail::is_resizable_contiguous<Output>::value>;
+  template<typename From, typename To, typename Input, typename OutputIt>
+  static auto transcode(const Input &input, OutputIt out) -> std::enable_if_t<!detail::is_resizable_contiguous<OutputIt>::value, OutputIt>;
+
+  // Counters of every thread since program start; cheap enough to poll for a metrics exporter
+  static auto stats() -> runtime_stats;
+
+  // Backend that runs a conversion in this process. The SIMD backend is fixed at build time; setting the
+  // RAPIDUTF_FORCE_BACKEND environment variable to `scalar` switches every kernel to the portable code. The variable
+  // is read once, and values naming a backend that is not compiled in (scalar|sse42|avx2|avx512|neon) are ignored.
+  static auto active_backend(conversion direction) -> backend;
+  static auto backend_name(backend kind) -> const char *;
+
 private:
-  static auto utf8_to_utf16_scalar(const unsigned char *bytes, std::size_t length, std::u16string &utf16) -> void;
-  static auto utf16_to_utf8_scalar(const char16_t *chars, std::size_t length, std::string &utf8) -> void;
-  static auto utf16_to_utf32_scalar(const char16_t *chars, std::size_t length, std::u32string &utf32) -> void;
-  static auto utf32_to_utf16_scalar(const char32_t *chars, std::size_t length, std::u16string &utf16) -> void;
-  static auto utf8_to_utf32_scalar(const unsigned char *bytes, std::size_t length, std::u32string &utf32) -> void;
-  static auto utf32_to_utf8_scalar(const char32_t *chars, std::size_t length, std::string &utf8) -> void;
+  friend auto detail::kernel_tables() -> std::vector<detail::kernel_table>;
+
+  template<typename Source, typename Target>
+  static auto transcode_native(std::basic_string_view<Source> input, std::basic_string<Target> &output) -> void;
+  template<typename Source, typename Target>
+  static auto transcode_native(std::basic_string_view<Source> input, Target *output, std::size_t capacity) -> std::size_t;
+  template<typename Source, typename Target>
+  static auto transcode_length(std::basic_string_view<Source> input) -> std::size_t;
+  template<typename Unit>
+  static auto validate_native(std::basic_string_view<Unit> input) -> void;
+
+  // Bodies shared by the buffer-reuse and pointer variants; Output is a std::basic_string or a fixed destination
+  template<typename Output>
+  static auto utf8_to_utf16_dispatch(std::string_view utf8, Output &utf16, byte_order order) -> void;
+  template<typename Output>
+  static auto utf16_to_utf8_dispatch(std::u16string_view utf16, Output &utf8, byte_order order) -> void;
+  template<typename Output>
+  static auto utf16_to_utf32_dispatch(std::u16string_view utf16, Output &utf32, byte_order from, byte_order to) -> void;
+  template<typename Output>
+  static auto utf32_to_utf16_dispatch(std::u32string_view utf32, Output &utf16, byte_order from, byte_order to) -> void;
+  template<typename Output>
+  static auto utf8_to_utf32_dispatch(std::string_view utf8, Output &utf32, byte_order order) -> void;
+  template<typename Output>
+  static auto utf32_to_utf8_dispatch(std::u32string_view utf32, Output &utf8, byte_order order) -> void;
+
+  static auto utf8_valid_prefix(const unsigned char *bytes, std::size_t length) -> std::size_t;
+  static auto detect_bom(const unsigned char *bytes, std::size_t length) -> encoding;
+
+  template<typename Output>
+  static auto utf8_to_utf16_scalar(const unsigned char *bytes, std::size_t length, Output &utf16, byte_order order = byte_order::native) -> void;
+  template<typename Output>
+  static auto utf16_to_utf8_scalar(const char16_t *chars, std::size_t length, Output &utf8, byte_order order = byte_order::native) -> void;
+  template<typename Output>
+  static auto utf16_to_utf32_scalar(const char16_t *chars, std::size_t length, Output &utf32, byte_order from = byte_order::native, byte_order to = byte_order::native) -> void;
+  template<typename Output>
+  static auto utf32_to_utf16_scalar(const char32_t *chars, std::size_t length, Output &utf16, byte_order from = byte_order::native, byte_order to = byte_order::native) -> void;
+  template<typename Output>
+  static auto utf8_to_utf32_scalar(const unsigned char *bytes, std::size_t length, Output &utf32, byte_order order = byte_order::native) -> void;
+  template<typename Output>
+  static auto utf32_to_utf8_scalar(const char32_t *chars, std::size_t length, Output &utf8, byte_order order = byte_order::native) -> void;
+  static auto utf8_to_latin1_scalar(const unsigned char *bytes, std::size_t length, char *latin1) -> void;
 
 #if defined(RAPIDUTF_USE_AVX2)
-  static auto utf8_to_utf16_avx2(const std::string &utf8) -> std::u16string;
-  static auto utf16_to_utf8_avx2(const std::u16string &utf16) -> std::string;
-  static auto utf16_to_utf32_avx2(const std::u16string &utf16) -> std::u32string;
-  static auto utf32_to_utf16_avx2(const std::u32string &utf32) -> std::u16string;
-  static auto utf8_to_utf32_avx2(const std::string &utf8) -> std::u32string;
-  static auto utf32_to_utf8_avx2(const std::u32string &utf32) -> std::string;
+  template<typename Output>
+  static auto utf8_to_utf16_avx2(std::string_view utf8, Output &utf16, byte_order order) -> void;
+  template<typename Output>
+  static auto utf16_to_utf8_avx2(std::u16string_view utf16, Output &utf8, byte_order order) -> void;
+  template<typename Output>
+  static auto utf16_to_utf32_avx2(std::u16string_view utf16, Output &utf32, byte_order from, byte_order to) -> void;
+  template<typename Output>
+  static auto utf32_to_utf16_avx2(std::u32string_view utf32, Output &utf16, byte_order from, byte_order to) -> void;
+  template<typename Output>
+  static auto utf8_to_utf32_avx2(std::string_view utf8, Output &utf32, byte_order order) -> void;
+  template<typename Output>
+  static auto utf32_to_utf8_avx2(std::u32string_view utf32, Output &utf8, byte_order order) -> void;
+  static auto count_utf8_avx2(const unsigned char *bytes, std::size_t length) -> std::size_t;
+  static auto count_utf16_avx2(const char16_t *chars, std::size_t length, byte_order order) -> std::size_t;
+  static auto utf16_length_from_utf8_avx2(const unsigned char *bytes, std::size_t length) -> std::size_t;
+  static auto utf8_length_from_utf16_avx2(const char16_t *chars, std::size_t length, byte_order order) -> std::size_t;
+  static auto utf8_length_from_utf32_avx2(const char32_t *chars, std::size_t length, byte_order order) -> std::size_t;
+  static auto utf16_length_from_utf32_avx2(const char32_t *chars, std::size_t length, byte_order order) -> std::size_t;
+  static auto find_first_non_ascii_avx2(const unsigned char *bytes, std::size_t length) -> std::size_t;
+  static auto utf8_char_width_avx2(const unsigned char *bytes, std::size_t length) -> char_width;
 #elif defined(RAPIDUTF_USE_NEON)
-  static auto utf8_to_utf16_neon(const std::string &utf8) -> std::u16string;
-  static auto utf16_to_utf8_neon(const std::u16string &utf16) -> std::string;
-  static auto utf16_to_utf32_neon(const std::u16string &utf16) -> std::u32string;
-  static auto utf32_to_utf16_neon(const std::u32string &utf32) -> std::u16string;
-  static auto utf8_to_utf32_neon(const std::string &utf8) -> std::u32string;
-  static auto utf32_to_utf8_neon(const std::u32string &utf32) -> std::string;
+  template<typename Output>
+  static auto utf8_to_utf16_neon(std::string_view utf8, Output &utf16, byte_order order) -> void;
+  template<typename Output>
+  static auto utf16_to_utf8_neon(std::u16string_view utf16, Output &utf8, byte_order order) -> void;
+  template<typename Output>
+  static auto utf16_to_utf32_neon(std::u16string_view utf16, Output &utf32, byte_order from, byte_order to) -> void;
+  template<typename Output>
+  static auto utf32_to_utf16_neon(std::u32string_view utf32, Output &utf16, byte_order from, byte_order to) -> void;
+  template<typename Output>
+  static auto utf8_to_utf32_neon(std::string_view utf8, Output &utf32, byte_order order) -> void;
+  template<typename Output>
+  static auto utf32_to_utf8_neon(std::u32string_view utf32, Output &utf8, byte_order order) -> void;
+  static auto count_utf8_neon(const unsigned char *bytes, std::size_t length) -> std::size_t;
+  static auto count_utf16_neon(const char16_t *chars, std::size_t length, byte_order order) -> std::size_t;
+  static auto utf16_length_from_utf8_neon(const unsigned char *bytes, std::size_t length) -> std::size_t;
+  static auto utf8_length_from_utf16_neon(const char16_t *chars, std::size_t length, byte_order order) -> std::size_t;
+  static auto utf8_length_from_utf32_neon(const char32_t *chars, std::size_t length, byte_order order) -> std::size_t;
+  static auto utf16_length_from_utf32_neon(const char32_t *chars, std::size_t length, byte_order order) -> std::size_t;
+  static auto find_first_non_ascii_neon(const unsigned char *bytes, std::size_t length) -> std::size_t;
+  static auto utf8_char_width_neon(const unsigned char *bytes, std::size_t length) -> char_width;
 // #else
 #endif
-  static auto utf8_to_utf16_fallback(const std::string &utf8) -> std::u16string;
-  static auto utf16_to_utf8_fallback(const std::u16string &utf16) -> std::string;
-  static auto utf16_to_utf32_fallback(const std::u16string &utf16) -> std::u32string;
-  static auto utf32_to_utf16_fallback(const std::u32string &utf32) -> std::u16string;
-  static auto utf8_to_utf32_fallback(const std::string &utf8) -> std::u32string;
-  static auto utf32_to_utf8_fallback(const std::u32string &utf32) -> std::string;
+  template<typename Output>
+  static auto utf8_to_utf16_fallback(std::string_view utf8, Output &utf16, byte_order order) -> void;
+  template<typename Output>
+  static auto utf16_to_utf8_fallback(std::u16string_view utf16, Output &utf8, byte_order order) -> void;
+  template<typename Output>
+  static auto utf16_to_utf32_fallback(std::u16string_view utf16, Output &utf32, byte_order from, byte_order to) -> void;
+  template<typename Output>
+  static auto utf32_to_utf16_fallback(std::u32string_view utf32, Output &utf16, byte_order from, byte_order to) -> void;
+  template<typename Output>
+  static auto utf8_to_utf32_fallback(std::string_view utf8, Output &utf32, byte_order order) -> void;
+  template<typename Output>
+  static auto utf32_to_utf8_fallback(std::u32string_view utf32, Output &utf8, byte_order order) -> void;
+  static auto count_utf8_fallback(const unsigned char *bytes, std::size_t length) -> std::size_t;
+  static auto count_utf16_fallback(const char16_t *chars, std::size_t length, byte_order order) -> std::size_t;
+  static auto utf16_length_from_utf8_fallback(const unsigned char *bytes, std::size_t length) -> std::size_t;
+  static auto utf8_length_from_utf16_fallback(const char16_t *chars, std::size_t length, byte_order order) -> std::size_t;
+  static auto utf8_length_from_utf32_fallback(const char32_t *chars, std::size_t length, byte_order order) -> std::size_t;
+  static auto utf16_length_from_utf32_fallback(const char32_t *chars, std::size_t length, byte_order order) -> std::size_t;
+  static auto find_first_non_ascii_fallback(const unsigned char *bytes, std::size_t length) -> std::size_t;
+  static auto utf8_char_width_fallback(const unsigned char *bytes, std::size_t length) -> char_width;
 // #endif
 };
 
+namespace detail
+{
+
+// Internal testing hook, not part of the stable API: the kernels of one backend, callable without the dispatch
+// in the public entry points, so benchmarks and tests can run every compiled backend side by side
+struct kernel_table
+{
+  const char *backend;
+  auto (*utf8_to_utf16)(const std::string &utf8) -> std::u16string;
+  auto (*utf16_to_utf8)(const std::u16string &utf16) -> std::string;
+  auto (*utf16_to_utf32)(const std::u16string &utf16) -> std::u32string;
+  auto (*utf32_to_utf16)(const std::u32string &utf32) -> std::u16string;
+  auto (*utf8_to_utf32)(const std::string &utf8) -> std::u32string;
+  auto (*utf32_to_utf8)(const std::u32string &utf32) -> std::string;
+  auto (*count_utf8)(std::string_view utf8) -> std::size_t;
+  auto (*count_utf16)(std::u16string_view utf16) -> std::size_t;
+  auto (*find_first_non_ascii)(std::string_view utf8) -> std::size_t;
+};
+
+// Inputs up to this many code units are checked in the header and, when every unit maps one to one, converted
+// without a call into the library. Longer inputs go to the out-of-line dispatch and its kernels.
+constexpr std::size_t inline_input_limit = 16;
+
+// SWAR ASCII check of a short input: 8-byte words, the last one overlapping its predecessor instead of a byte loop.
+// Also used by the library for inputs below its small-input limit.
+inline auto is_short_ascii(const char *bytes, std::size_t length) -> bool
+{
+  constexpr std::uint64_t high_bits = 0x8080808080808080ULL;
+  std::uint64_t merged = 0;
+  if (length < 8)
+  {
+    for (std::size_t i = 0; i < length; ++i)
+    {
+      merged |= static_cast<unsigned char>(bytes[i]);
+    }
+    return (merged & high_bits) == 0;
+  }
+  std::uint64_t word = 0;
+  for (std::size_t i = 0; i + 8 <= length; i += 8)
+  {
+    std::memcpy(&word, bytes + i, 8);
+    merged |= word;
+  }
+  std::memcpy(&word, bytes + length - 8, 8);
+  return ((merged | word) & high_bits) == 0;
+}
+
+// Upper bound of the code units of a short input: every unit is at most the OR of all of them
+template<typename Unit>
+inline auto short_unit_bound(const Unit *units, std::size_t length) -> std::uint32_t
+{
+  std::uint32_t merged = 0;
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    merged |= static_cast<std::uint32_t>(units[i]);
+  }
+  return merged;
+}
+
+// Counted builds route every call through the library, so the counters also see the short inputs
+#if defined(RAPIDUTF_ENABLE_STATS)
+constexpr bool inline_short_inputs = false;
+#else
+constexpr bool inline_short_inputs = true;
+#endif
+
+// Decodes the UTF-8 sequence at `index` and moves past it; a plain byte loop, so it also runs in constant expressions
+template<typename Unit>
+constexpr auto decode_utf8_at(std::basic_string_view<Unit> utf8, std::size_t &index) -> char32_t
+{
+  const auto lead = static_cast<unsigned char>(utf8[index]);
+  if (lead < 0x80)
+  {
+    ++index;
+    return lead;
+  }
+  std::size_t trail = 0;
+  std::uint32_t code_point = 0;
+  std::uint32_t minimum = 0;
+  if ((lead & 0xE0U) == 0xC0U)
+  {
+    trail = 1;
+    code_point = lead & 0x1FU;
+    minimum = 0x80;
+  }
+  else if ((lead & 0xF0U) == 0xE0U)
+  {
+    trail = 2;
+    code_point = lead & 0x0FU;
+    minimum = 0x800;
+  }
+  else if ((lead & 0xF8U) == 0xF0U)
+  {
+    trail = 3;
+    code_point = lead & 0x07U;
+    minimum = 0x10000;
+  }
+  else
+  {
+    throw std::runtime_error("Invalid UTF-8 sequence");
+  }
+  if (utf8.length() - index <= trail)
+  {
+    throw std::runtime_error("Invalid UTF-8 sequence (truncated)");
+  }
+  for (std::size_t k = 1; k <= trail; ++k)
+  {
+    const auto byte = static_cast<unsigned char>(utf8[index + k]);
+    if ((byte & 0xC0U) != 0x80U)
+    {
+      throw std::runtime_error("Invalid UTF-8 sequence");
+    }
+    code_point = (code_point << 6U) | (byte & 0x3FU);
+  }
+  if (code_point < minimum || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF))
+  {
+    throw std::runtime_error("Invalid UTF-8 sequence");
+  }
+  index += trail + 1;
+  return static_cast<char32_t>(code_point);
+}
+
+template<typename Unit>
+constexpr auto decode_utf16_at(std::basic_string_view<Unit> utf16, std::size_t &index) -> char32_t
+{
+  const auto lead = static_cast<std::uint32_t>(utf16[index]);
+  if (lead < 0xD800 || lead > 0xDFFF)
+  {
+    ++index;
+    return static_cast<char32_t>(lead);
+  }
+  if (lead > 0xDBFF)
+  {
+    throw std::runtime_error("Invalid UTF-16 sequence (lone low surrogate)");
+  }
+  if (index + 1 >= utf16.length())
+  {
+    throw std::runtime_error("Invalid UTF-16 sequence (truncated surrogate pair)");
+  }
+  const auto trail = static_cast<std::uint32_t>(utf16[index + 1]);
+  if (trail < 0xDC00 || trail > 0xDFFF)
+  {
+    throw std::runtime_error("Invalid UTF-16 sequence (invalid surrogate pair)");
+  }
+  index += 2;
+  return static_cast<char32_t>(0x10000 + ((lead - 0xD800) << 10U) + (trail - 0xDC00));
+}
+
+template<typename Unit>
+constexpr auto decode_utf32_at(std::basic_string_view<Unit> utf32, std::size_t &index) -> char32_t
+{
+  const auto code_point = static_cast<std::uint32_t>(utf32[index]);
+  if (code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF))
+  {
+    throw std::runtime_error("Invalid UTF-32 code point");
+  }
+  ++index;
+  return static_cast<char32_t>(code_point);
+}
+
+template<typename Unit>
+constexpr auto decode_at(std::basic_string_view<Unit> units, std::size_t &index) -> char32_t
+{
+  if constexpr (sizeof(Unit) == 1)
+  {
+    return decode_utf8_at(units, index);
+  }
+  else if constexpr (sizeof(Unit) == 2)
+  {
+    return decode_utf16_at(units, index);
+  }
+  else
+  {
+    return decode_utf32_at(units, index);
+  }
+}
+
+// Writes a valid code point as one to four code units of the UTF form of Unit
+template<typename Unit, typename OutputIt>
+auto encode_to(char32_t code_point, OutputIt &out) -> void
+{
+  const auto value = static_cast<std::uint32_t>(code_point);
+  if constexpr (sizeof(Unit) == 1)
+  {
+    if (value < 0x80)
+    {
+      *out = static_cast<Unit>(value);
+      ++out;
+      return;
+    }
+    if (value < 0x800)
+    {
+      *out = static_cast<Unit>(0xC0U | (value >> 6U));
+      ++out;
+    }
+    else if (value < 0x10000)
+    {
+      *out = static_cast<Unit>(0xE0U | (value >> 12U));
+      ++out;
+      *out = static_cast<Unit>(0x80U | ((value >> 6U) & 0x3FU));
+      ++out;
+    }
+    else
+    {
+      *out = static_cast<Unit>(0xF0U | (value >> 18U));
+      ++out;
+      *out = static_cast<Unit>(0x80U | ((value >> 12U) & 0x3FU));
+      ++out;
+      *out = static_cast<Unit>(0x80U | ((value >> 6U) & 0x3FU));
+      ++out;
+    }
+    *out = static_cast<Unit>(0x80U | (value & 0x3FU));
+    ++out;
+  }
+  else if constexpr (sizeof(Unit) == 2)
+  {
+    if (value < 0x10000)
+    {
+      *out = static_cast<Unit>(value);
+      ++out;
+      return;
+    }
+    *out = static_cast<Unit>(0xD800 + ((value - 0x10000) >> 10U));
+    ++out;
+    *out = static_cast<Unit>(0xDC00 + ((value - 0x10000) & 0x3FFU));
+    ++out;
+  }
+  else
+  {
+    *out = static_cast<Unit>(value);
+    ++out;
+  }
+}
+
+}  // namespace detail
+
+inline auto converter::utf8_to_utf16(const std::string &utf8) -> std::u16string
+{
+  if (detail::inline_short_inputs && utf8.length() <= detail::inline_input_limit && detail::is_short_ascii(utf8.data(), utf8.length()))
+  {
+    return std::u16string(utf8.begin(), utf8.end());
+  }
+  std::u16string utf16;
+  utf8_to_utf16(utf8, utf16);
+  return utf16;
+}
+
+inline auto converter::utf16_to_utf8(const std::u16string &utf16) -> std::string
+{
+  if (detail::inline_short_inputs && utf16.length() <= detail::inline_input_limit && detail::short_unit_bound(utf16.data(), utf16.length()) < 0x80)
+  {
+    return std::string(utf16.begin(), utf16.end());
+  }
+  std::string utf8;
+  utf16_to_utf8(utf16, utf8);
+  return utf8;
+}
+
+inline auto converter::utf16_to_utf32(const std::u16string &utf16) -> std::u32string
+{
+  if (detail::inline_short_inputs && utf16.length() <= detail::inline_input_limit && detail::short_unit_bound(utf16.data(), utf16.length()) < 0xD800)
+  {
+    return std::u32string(utf16.begin(), utf16.end());
+  }
+  std::u32string utf32;
+  utf16_to_utf32(utf16, utf32);
+  return utf32;
+}
+
+inline auto converter::utf32_to_utf16(const std::u32string &utf32) -> std::u16string
+{
+  if (detail::inline_short_inputs && utf32.length() <= detail::inline_input_limit && detail::short_unit_bound(utf32.data(), utf32.length()) < 0xD800)
+  {
+    return std::u16string(utf32.begin(), utf32.end());
+  }
+  std::u16string utf16;
+  utf32_to_utf16(utf32, utf16);
+  return utf16;
+}
+
+inline auto converter::utf8_to_utf32(const std::string &utf8) -> std::u32string
+{
+  if (detail::inline_short_inputs && utf8.length() <= detail::inline_input_limit && detail::is_short_ascii(utf8.data(), utf8.length()))
+  {
+    return std::u32string(utf8.begin(), utf8.end());
+  }
+  std::u32string utf32;
+  utf8_to_utf32(utf8, utf32);
+  return utf32;
+}
+
+inline auto converter::utf32_to_utf8(const std::u32string &utf32) -> std::string
+{
+  if (detail::inline_short_inputs && utf32.length() <= detail::inline_input_limit && detail::short_unit_bound(utf32.data(), utf32.length()) < 0x80)
+  {
+    return std::string(utf32.begin(), utf32.end());
+  }
+  std::string utf8;
+  utf32_to_utf8(utf32, utf8);
+  return utf8;
+}
+
+constexpr auto converter::utf16_length_of(std::string_view utf8) -> std::size_t
+{
+  std::size_t length = 0;
+  for (std::size_t i = 0; i < utf8.length();)
+  {
+    length += detail::decode_utf8_at(utf8, i) > 0xFFFF ? 2U : 1U;
+  }
+  return length;
+}
+
+constexpr auto converter::utf32_length_of(std::string_view utf8) -> std::size_t
+{
+  std::size_t length = 0;
+  for (std::size_t i = 0; i < utf8.length(); ++length)
+  {
+    detail::decode_utf8_at(utf8, i);
+  }
+  return length;
+}
+
+template<std::size_t N>
+constexpr auto converter::utf8_to_utf16_array(std::string_view utf8) -> std::array<char16_t, N>
+{
+  std::array<char16_t, N> utf16 {};
+  std::size_t length = 0;
+  for (std::size_t i = 0; i < utf8.length();)
+  {
+    const char32_t code_point = detail::decode_utf8_at(utf8, i);
+    const std::size_t units = code_point > 0xFFFF ? 2U : 1U;
+    if (N - length < units)
+    {
+      throw std::runtime_error("UTF-16 array is too short for the input");
+    }
+    if (units == 1)
+    {
+      utf16[length++] = static_cast<char16_t>(code_point);
+    }
+    else
+    {
+      utf16[length++] = static_cast<char16_t>(0xD800 + ((code_point - 0x10000) >> 10U));
+      utf16[length++] = static_cast<char16_t>(0xDC00 + ((code_point - 0x10000) & 0x3FFU));
+    }
+  }
+  if (length != N)
+  {
+    throw std::runtime_error("UTF-16 array is longer than the input");
+  }
+  return utf16;
+}
+
+template<std::size_t N>
+constexpr auto converter::utf8_to_utf32_array(std::string_view utf8) -> std::array<char32_t, N>
+{
+  std::array<char32_t, N> utf32 {};
+  std::size_t length = 0;
+  for (std::size_t i = 0; i < utf8.length(); ++length)
+  {
+    const char32_t code_point = detail::decode_utf8_at(utf8, i);
+    if (length == N)
+    {
+      throw std::runtime_error("UTF-32 array is too short for the input");
+    }
+    utf32[length] = code_point;
+  }
+  if (length != N)
+  {
+    throw std::runtime_error("UTF-32 array is longer than the input");
+  }
+  return utf32;
+}
+
+template<typename Source, typename Target>
+auto converter::transcode_native(std::basic_string_view<Source> input, std::basic_string<Target> &output) -> void
+{
+  if constexpr (std::is_same_v<Source, Target>)
+  {
+    // Same UTF form on both sides: validated copy
+    validate_native(input);
+    output.assign(input.begin(), input.end());
+  }
+  else if constexpr (std::is_same_v<Source, char> && std::is_same_v<Target, char16_t>)
+  {
+    utf8_to_utf16(input, output);
+  }
+  else if constexpr (std::is_same_v<Source, char> && std::is_same_v<Target, char32_t>)
+  {
+    utf8_to_utf32(input, output);
+  }
+  else if constexpr (std::is_same_v<Source, char16_t> && std::is_same_v<Target, char>)
+  {
+    utf16_to_utf8(input, output);
+  }
+  else if constexpr (std::is_same_v<Source, char16_t> && std::is_same_v<Target, char32_t>)
+  {
+    utf16_to_utf32(input, output);
+  }
+  else if constexpr (std::is_same_v<Source, char32_t> && std::is_same_v<Target, char>)
+  {
+    utf32_to_utf8(input, output);
+  }
+  else
+  {
+    utf32_to_utf16(input, output);
+  }
+}
+
+template<typename Source, typename Target>
+auto converter::transcode_native(std::basic_string_view<Source> input, Target *output, std::size_t capacity) -> std::size_t
+{
+  if constexpr (std::is_same_v<Source, Target>)
+  {
+    validate_native(input);
+    if (input.length() > capacity)
+    {
+      throw std::runtime_error("Converted output does not fit the destination");
+    }
+    if (!input.empty())
+    {
+      std::memcpy(output, input.data(), input.length() * sizeof(Target));
+    }
+    return input.length();
+  }
+  else if constexpr (std::is_same_v<Source, char> && std::is_same_v<Target, char16_t>)
+  {
+    return utf8_to_utf16(input, output, capacity);
+  }
+  else if constexpr (std::is_same_v<Source, char> && std::is_same_v<Target, char32_t>)
+  {
+    return utf8_to_utf32(input, output, capacity);
+  }
+  else if constexpr (std::is_same_v<Source, char16_t> && std::is_same_v<Target, char>)
+  {
+    return utf16_to_utf8(input, output, capacity);
+  }
+  else if constexpr (std::is_same_v<Source, char16_t> && std::is_same_v<Target, char32_t>)
+  {
+    return utf16_to_utf32(input, output, capacity);
+  }
+  else if constexpr (std::is_same_v<Source, char32_t> && std::is_same_v<Target, char>)
+  {
+    return utf32_to_utf8(input, output, capacity);
+  }
+  else
+  {
+    return utf32_to_utf16(input, output, capacity);
+  }
+}
+
+template<typename Unit>
+auto converter::validate_native(std::basic_string_view<Unit> input) -> void
+{
+  if constexpr (std::is_same_v<Unit, char>)
+  {
+    if (utf8_valid_prefix(reinterpret_cast<const unsigned char *>(input.data()), input.length()) != input.length())  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    {
+      throw std::runtime_error("Invalid UTF-8 sequence");
+    }
+  }
+  else if constexpr (std::is_same_v<Unit, char16_t>)
+  {
+    if (!is_valid_utf16(input, byte_order::native))
+    {
+      throw std::runtime_error("Invalid UTF-16 sequence");
+    }
+  }
+  else if (!is_valid_utf32(input, byte_order::native))
+  {
+    throw std::runtime_error("Invalid UTF-32 string");
+  }
+}
+
+// Exact output length for well-formed input, from the counting kernels
+template<typename Source, typename Target>
+auto converter::transcode_length(std::basic_string_view<Source> input) -> std::size_t
+{
+  if constexpr (std::is_same_v<Source, Target>)
+  {
+    return input.length();
+  }
+  else if constexpr (std::is_same_v<Source, char> && std::is_same_v<Target, char16_t>)
+  {
+    return utf16_length_from_utf8(input);
+  }
+  else if constexpr (std::is_same_v<Source, char> && std::is_same_v<Target, char32_t>)
+  {
+    return count_utf8(input);
+  }
+  else if constexpr (std::is_same_v<Source, char16_t> && std::is_same_v<Target, char>)
+  {
+    return utf8_length_from_utf16(input);
+  }
+  else if constexpr (std::is_same_v<Source, char16_t> && std::is_same_v<Target, char32_t>)
+  {
+    return count_utf16(input);
+  }
+  else if constexpr (std::is_same_v<Source, char32_t> && std::is_same_v<Target, char>)
+  {
+    return utf8_length_from_utf32(input);
+  }
+  else
+  {
+    return utf16_length_from_utf32(input);
+  }
+}
+
+template<typename From, typename To, typename Input, typename Output>
+auto converter::transcode(const Input &input, Output &output) -> std::enable_if_t<detail::is_resizable_contiguous<Output>::value>
+{
+  static_assert(detail::is_code_unit<From> && detail::is_code_unit<To>, "From and To must be code unit types");
+  static_assert(std::is_same_v<std::remove_cv_t<std::remove_pointer_t<decltype(std::data(input))>>, From>, "input must be a contiguous range of From");
+  static_assert(std::is_same_v<typename Output::value_type, To>, "output must hold To");
+  using source = detail::native_unit_t<From>;
+  using target = detail::native_unit_t<To>;
+
+  // char8_t input is read as char, which may alias it; wchar_t may not be aliased and is widened or narrowed first
+  std::basic_string<source> copied;
+  std::basic_string_view<source> units;
+  if constexpr (std::is_same_v<From, source>)
+  {
+    units = {std::data(input), std::size(input)};
+  }
+  else if constexpr (sizeof(From) == 1)
+  {
+    units = {reinterpret_cast<const char *>(std::data(input)), std::size(input)};  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+  else
+  {
+    copied.assign(std::begin(input), std::end(input));
+    units = copied;
+  }
+
+  if constexpr (std::is_same_v<Output, std::basic_string<target>>)
+  {
+    transcode_native(units, output);
+  }
+  else if constexpr (std::is_same_v<To, target> || sizeof(To) == 1)
+  {
+    // Sized by the counting kernels and written by the conversion kernels in place; char8_t storage is written as char
+    output.resize(transcode_length<source, target>(units));
+    auto *const data = reinterpret_cast<target *>(output.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    output.resize(transcode_native(units, data, output.size()));
+  }
+  else
+  {
+    // wchar_t may not be aliased, so it receives a copy
+    std::basic_string<target> converted;
+    transcode_native(units, converted);
+    output.resize(converted.size());
+    if (!converted.empty())
+    {
+      std::memcpy(output.data(), converted.data(), converted.size() * sizeof(target));
+    }
+  }
+}
+
+template<typename From, typename To, typename Input, typename OutputIt>
+auto converter::transcode(const Input &input, OutputIt out) -> std::enable_if_t<!detail::is_resizable_contiguous<OutputIt>::value, OutputIt>
+{
+  static_assert(detail::is_code_unit<From> && detail::is_code_unit<To>, "From and To must be code unit types");
+  static_assert(std::is_same_v<std::remove_cv_t<std::remove_pointer_t<decltype(std::data(input))>>, From>, "input must be a contiguous range of From");
+
+  const std::basic_string_view<From> units(std::data(input), std::size(input));
+  for (std::size_t i = 0; i < units.length();)
+  {
+    detail::encode_to<To>(detail::decode_at(units, i), out);
+  }
+  return out;
+}
+
+// Forward range of the code points of UTF-8 (char) or UTF-16 (char16_t) text. Dereferencing decodes the sequence at
+// the iterator and throws on invalid input; incrementing only steps over it. advance(n) and next(n) skip n code
+// points with converter::skip_code_points, and subview() slices by code point without decoding the skipped part.
+template<typename Unit>
+class code_point_view
+{
+public:
+  class iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = char32_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = char32_t;
+
+    iterator() = default;
+    iterator(std::basic_string_view<Unit> units, std::size_t offset)
+        : units_(units)
+        , offset_(offset)
+    {
+    }
+
+    auto operator*() const -> char32_t
+    {
+      std::size_t next = offset_;
+      return detail::decode_at(units_, next);
+    }
+
+    auto operator++() -> iterator &
+    {
+      ++offset_;
+      while (offset_ < units_.length() && is_trail(units_[offset_]))
+      {
+        ++offset_;
+      }
+      return *this;
+    }
+
+    auto operator++(int) -> iterator
+    {
+      iterator previous = *this;
+      ++*this;
+      return previous;
+    }
+
+    auto advance(std::size_t count) -> iterator &
+    {
+      offset_ += converter::skip_code_points(units_.substr(offset_), count);
+      return *this;
+    }
+
+    auto next(std::size_t count) const -> iterator
+    {
+      iterator moved = *this;
+      return moved.advance(count);
+    }
+
+    // Position in code units, for slicing the underlying text
+    auto offset() const -> std::size_t { return offset_; }
+
+    friend auto operator==(const iterator &lhs, const iterator &rhs) -> bool { return lhs.offset_ == rhs.offset_; }
+    friend auto operator!=(const iterator &lhs, const iterator &rhs) -> bool { return lhs.offset_ != rhs.offset_; }
+
+  private:
+    static auto is_trail(Unit unit) -> bool
+    {
+      if constexpr (sizeof(Unit) == 1)
+      {
+        return (static_cast<unsigned char>(unit) & 0xC0U) == 0x80U;
+      }
+      else
+      {
+        return (static_cast<std::uint32_t>(unit) & 0xFC00U) == 0xDC00U;
+      }
+    }
+
+    std::basic_string_view<Unit> units_;
+    std::size_t offset_ = 0;
+  };
+
+  code_point_view() = default;
+  explicit code_point_view(std::basic_string_view<Unit> units)
+      : units_(units)
+  {
+  }
+
+  auto begin() const -> iterator { return {units_, 0}; }
+  auto end() const -> iterator { return {units_, units_.length()}; }
+  auto empty() const -> bool { return units_.empty(); }
+  auto units() const -> std::basic_string_view<Unit> { return units_; }
+
+  // Code points [first, first + count), clamped to the end of the text
+  auto subview(std::size_t first, std::size_t count = std::basic_string_view<Unit>::npos) const -> code_point_view
+  {
+    const std::basic_string_view<Unit> rest = units_.substr(converter::skip_code_points(units_, first));
+    return code_point_view(rest.substr(0, converter::skip_code_points(rest, count)));
+  }
+
+private:
+  std::basic_string_view<Unit> units_;
+};
+
+// Sparse index of code point positions in well-formed UTF-8: the byte and UTF-16 offsets of every `stride`-th code
+// point, found with the SIMD counting kernels in one pass over the text. A lookup starts at the nearest checkpoint and counts at
+// most `stride` code points, instead of scanning from the start. The index keeps a view of the text, which must stay
+// alive and unchanged; append() takes the text grown at its end, possibly moved, and indexes only what was added.
+class RAPIDUTF_EXPORT utf8_offset_index
+{
+public:
+  static constexpr std::size_t default_stride = 1024;
+
+  explicit utf8_offset_index(std::string_view utf8, std::size_t stride = default_stride);
+
+  // Byte offset of a code point; indexes past the end give the length of the text
+  auto byte_offset(std::size_t code_point) const -> std::size_t;
+  // Index of the code point starting at a byte offset; offsets inside a sequence round up to the next code point
+  auto code_point_index(std::size_t byte_offset) const -> std::size_t;
+  auto append(std::string_view utf8) -> void;
+
+  // converter::translate_offset and translate_range, counting from the checkpoint before the position
+  auto translate(std::size_t offset, offset_unit from, offset_unit to) const -> std::size_t;
+  auto translate(text_range range, offset_unit from, offset_unit to) const -> text_range;
+
+  auto size() const -> std::size_t { return size_; }
+  auto stride() const -> std::size_t { return stride_; }
+  auto text() const -> std::string_view { return text_; }
+
+private:
+  auto index_from_last_checkpoint() -> void;
+
+  std::string_view text_;
+  std::size_t stride_;
+  std::size_t size_ = 0;
+  std::vector<std::size_t> offsets_;
+  std::vector<std::size_t> utf16_offsets_;
+};
+
+inline auto converter::utf8_codepoints(std::string_view utf8) -> code_point_view<char>
+{
+  return code_point_view<char>(utf8);
+}
+
+inline auto converter::utf16_codepoints(std::u16string_view utf16) -> code_point_view<char16_t>
+{
+  return code_point_view<char16_t>(utf16);
+}
+
 }  // namespace rapidutf
 
+// Compile-time conversion of a UTF-8 string literal into an exactly sized std::array; the constexpr local makes an
+// invalid literal a compile error wherever the macro is used, also outside constant expressions
+#define RAPIDUTF_UTF16_LITERAL(text) \
+  ([] { constexpr auto rapidutf_utf16 = rapidutf::converter::utf8_to_utf16_array<rapidutf::converter::utf16_length_of(text)>(text); return rapidutf_utf16; }())
+#define RAPIDUTF_UTF32_LITERAL(text) \
+  ([] { constexpr auto rapidutf_utf32 = rapidutf::converter::utf8_to_utf32_array<rapidutf::converter::utf32_length_of(text)>(text); return rapidutf_utf32; }())
+
 #endif  // CONVERTER_HPP
@@ -1,6 +1,9 @@
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 #include <string>
 
@@ -12,6 +15,14 @@
 #  include <arm_neon.h>
 #endif
 
+#if defined(RAPIDUTF_ENABLE_STATS)
+#  include <atomic>
+#  include <exception>
+#  include <mutex>
+#  include <tuple>
+#  include <vector>
+#endif
+
 // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic)
 
 namespace rapidutf
@@ -29,1638 +40,4125 @@ static inline int ctz(uint32_t value)
   }
   return 32;
 }
+
+static inline auto popcount(uint32_t value) -> int
+{
+  return static_cast<int>(__popcnt(value));
+}
 #else
 // Implementation for GCC and Clang
 static inline auto ctz(uint32_t value) -> int
 {
   return __builtin_ctz(value);
 }
+
+static inline auto popcount(uint32_t value) -> int
+{
+  return __builtin_popcount(value);
+}
 #endif
 
-auto converter::is_valid_utf8_sequence(const unsigned char *bytes, int length) -> bool
+// Length of the sequence introduced by a UTF-8 lead byte, 0 for bytes that cannot start a sequence
+static inline auto utf8_sequence_length(unsigned char lead) -> std::size_t
 {
-  if (length == 1)
+  if ((lead & 0x80U) == 0)
   {
-    return (bytes[0] & 0x80U) == 0;
+    return 1;
   }
-  if (length == 2)
+  if ((lead & 0xE0U) == 0xC0U)
   {
-    if ((bytes[0] & 0xE0U) == 0xC0 && (bytes[1] & 0xC0U) == 0x80)
-    {
-      // Check for overlong encoding
-      const uint32_t code_point = ((bytes[0] & 0x1FU) << 6U) | (bytes[1] & 0x3FU);
-      return code_point >= 0x80;
-    }
-    return false;
+    return 2;
   }
-  if (length == 3)
+  if ((lead & 0xF0U) == 0xE0U)
   {
-    if ((bytes[0] & 0xF0U) == 0xE0 && (bytes[1] & 0xC0U) == 0x80 && (bytes[2] & 0xC0U) == 0x80)
-    {
-      // Check for overlong encoding
-      const uint32_t code_point = ((bytes[0] & 0x0FU) << 12U) | ((bytes[1] & 0x3FU) << 6U) | (bytes[2] & 0x3FU);
-      return code_point >= 0x800 && code_point <= 0xFFFF;
-    }
-    return false;
+    return 3;
   }
-  if (length == 4)
+  if ((lead & 0xF8U) == 0xF0U)
   {
-    if ((bytes[0] & 0xF8U) == 0xF0 && (bytes[1] & 0xC0U) == 0x80 && (bytes[2] & 0xC0U) == 0x80 && (bytes[3] & 0xC0U) == 0x80)
-    {
-      // Check for overlong encoding and valid Unicode code point
-      const uint32_t code_point = ((bytes[0] & 0x07U) << 18U) | ((bytes[1] & 0x3FU) << 12U) | ((bytes[2] & 0x3FU) << 6U) | (bytes[3] & 0x3FU);
-      return code_point >= 0x10000 && code_point <= 0x10FFFF;
-    }
-    return false;
+    return 4;
   }
-  return false;
+  return 0;
 }
 
-auto converter::is_valid_utf8(const std::string &utf8) -> bool
+// Table-driven UTF-8 decoder after Bjoern Hoehrmann's DFA. Bytes map to one of 12 classes, and each class moves the
+// decoder between 9 states: accept, reject, and the states awaiting continuation bytes. The continuation ranges allowed
+// after E0, ED, F0 and F4 keep sequences shortest-form, off the surrogates and at most U+10FFFF, so reaching accept
+// means a valid code point without any further checks.
+
+// clang-format off
+static constexpr std::array<uint8_t, 256> utf8_classes {
+   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+   1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,  9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+   7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,  7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+   8, 8, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+  10, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 3, 3, 11, 6, 6, 6, 5, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+};
+
+// Indexed by 12 * state + class
+static constexpr std::array<uint8_t, 108> utf8_transitions {
+   0, 12, 24, 36, 60, 96, 84, 12, 12, 12, 48, 72,  12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+  12,  0, 12, 12, 12, 12, 12,  0, 12,  0, 12, 12,  12, 24, 12, 12, 12, 12, 12, 24, 12, 24, 12, 12,
+  12, 12, 12, 12, 12, 12, 12, 24, 12, 12, 12, 12,  12, 24, 12, 12, 12, 12, 12, 12, 12, 24, 12, 12,
+  12, 12, 12, 12, 12, 12, 12, 36, 12, 36, 12, 12,  12, 36, 12, 12, 12, 12, 12, 36, 12, 36, 12, 12,
+  12, 36, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+};
+// clang-format on
+
+// The decoder runs the same automaton in shift form: a state is a multiple of 6, and the row of a byte holds the next
+// state for every state in 6-bit fields. The transition is then a shift of a row that was loaded without waiting for
+// the previous state, which keeps the dependency chain between bytes at one instruction.
+static constexpr auto utf8_shift_rows() -> std::array<uint64_t, 256>
 {
-  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-  const std::size_t length = utf8.length();
-
-  for (std::size_t i = 0; i < length;)
+  std::array<uint64_t, 256> rows {};
+  for (std::size_t byte = 0; byte < rows.size(); ++byte)
   {
-    if ((bytes[i] & 0x80U) == 0)
-    {
-      // ASCII character, one byte
-      i += 1;
-    }
-    else if ((bytes[i] & 0xE0U) == 0xC0)
-    {
-      // Two-byte character, check if the next byte is a valid continuation byte
-      if (i + 1 >= length || !is_valid_utf8_sequence(bytes + i, 2))
-      {
-        return false;
-      }
-      i += 2;
-    }
-    else if ((bytes[i] & 0xF0U) == 0xE0U)
-    {
-      // Three-byte character, check if the next two bytes are valid continuation bytes
-      if (i + 2 >= length || !is_valid_utf8_sequence(bytes + i, 3))
-      {
-        return false;
-      }
-      i += 3;
-    }
-    else if ((bytes[i] & 0xF8U) == 0xF0U)
-    {
-      // Four-byte character, check if the next three bytes are valid continuation bytes
-      if (i + 3 >= length || !is_valid_utf8_sequence(bytes + i, 4))
-      {
-        return false;
-      }
-      i += 4;
-    }
-    else
+    for (std::size_t state = 0; state < 9; ++state)
     {
-      // Invalid start byte
-      return false;
+      const std::size_t next = utf8_transitions.at((state * 12) + utf8_classes.at(byte)) / 12U;
+      rows.at(byte) |= static_cast<uint64_t>(next * 6) << (state * 6);
     }
   }
-  return true;
+  return rows;
 }
 
-auto converter::is_valid_utf16(const std::u16string &utf16) -> bool
+static constexpr std::array<uint64_t, 256> utf8_rows = utf8_shift_rows();
+static constexpr uint32_t utf8_accept = 0;
+static constexpr uint32_t utf8_reject = 6;  // Absorbing: once rejected, the state never changes again
+
+static inline auto utf8_next_state(uint32_t state, unsigned char byte) -> uint32_t
 {
-  const char16_t *chars = utf16.data();
-  const std::size_t length = utf16.length();
+  return static_cast<uint32_t>(utf8_rows[byte] >> state) & 0x3FU;
+}
 
-  for (std::size_t i = 0; i < length; ++i)
+// Code point bits of a byte, and which of the bits already gathered survive it: a continuation byte (classes 1, 7, 9)
+// shifts them up, any other byte starts over. Neither depends on the state, so decoding has no branches either.
+static constexpr auto utf8_bit_masks(bool carry) -> std::array<uint32_t, 256>
+{
+  std::array<uint32_t, 256> masks {};
+  for (std::size_t byte = 0; byte < masks.size(); ++byte)
   {
-    const char16_t chr = chars[i];
-    if (chr >= 0xD800 && chr <= 0xDBFF)
-    {
-      if (i + 1 >= length)
-      {
-        return false;
-      }
-      const char16_t next = chars[i + 1];
-      if (next < 0xDC00 || next > 0xDFFF)
-      {
-        return false;
-      }
-      ++i;
-    }
-    else if (chr >= 0xDC00 && chr <= 0xDFFF)
-    {
-      return false;
-    }
+    const uint8_t type = utf8_classes.at(byte);
+    const bool continuation = type == 1 || type == 7 || type == 9;
+    masks.at(byte) = carry ? (continuation ? 0xFFFFFFFFU : 0U) : (continuation ? 0x3FU : 0xFFU >> type);
   }
-  return true;
+  return masks;
 }
 
-auto converter::is_valid_utf32(const std::u32string &utf32) -> bool
+static constexpr std::array<uint32_t, 256> utf8_payload = utf8_bit_masks(false);
+static constexpr std::array<uint32_t, 256> utf8_carry = utf8_bit_masks(true);
+
+// Feeds one byte to the decoder; `codepoint` is complete whenever `state` is utf8_accept
+static inline auto utf8_decode_step(uint32_t &state, uint32_t &codepoint, unsigned char byte) -> void
 {
-  const char32_t *chars = utf32.data();
-  const std::size_t length = utf32.length();
+  codepoint = ((codepoint << 6U) & utf8_carry[byte]) | (byte & utf8_payload[byte]);
+  state = utf8_next_state(state, byte);
+}
 
-  for (std::size_t i = 0; i < length; ++i)
-  {
-    const char32_t chr = chars[i];
+// SWAR (SIMD within a register) helpers for the portable code: a 64-bit word holds 8 bytes, 4 UTF-16 or 2 UTF-32
+// units. Every test is confined to its own lane, so the results do not depend on the byte order of the host.
+static constexpr uint64_t swar_ones = 0x0101010101010101ULL;
+static constexpr uint64_t swar_high_bits = 0x8080808080808080ULL;
 
-    // Check if the code point is within the Unicode range
-    if (chr > 0x10FFFF)
-    {
-      return false;
-    }
+static inline auto load_word(const void *src) -> uint64_t
+{
+  uint64_t word = 0;
+  std::memcpy(&word, src, sizeof(word));
+  return word;
+}
 
-    // Surrogate pairs are not valid in UTF-32
-    if (chr >= 0xD800 && chr <= 0xDFFF)
-    {
-      return false;
-    }
-  }
+// Whether the 8 bytes at `bytes` are all ASCII
+static inline auto ascii_word(const unsigned char *bytes) -> bool
+{
+  return (load_word(bytes) & swar_high_bits) == 0;
+}
 
-  return true;
+// Flags the UTF-8 continuation bytes (10xxxxxx) of a word in the high bit of their lane
+static inline auto continuation_bytes(uint64_t word) -> uint64_t
+{
+  return word & ~(word << 1U) & swar_high_bits;
 }
 
-void converter::utf8_to_utf16_scalar(const unsigned char *bytes, std::size_t length, std::u16string &utf16)  // NOLINT(readability-function-cognitive-complexity)
+// Flags the lead bytes of four-byte sequences (11110xxx, and the invalid F8-FF) in the high bit of their lane
+static inline auto four_byte_leads(uint64_t word) -> uint64_t
 {
-  for (std::size_t i = 0; i < length;)
-  {
-    if ((bytes[i] & 0x80U) == 0)
-    {
-      // ASCII character, one byte
-      utf16.push_back(static_cast<char16_t>(bytes[i]));
-      i += 1;
-    }
-    else if ((bytes[i] & 0xE0U) == 0xC0U)
-    {
-      // Two-byte character, check if the next byte is a valid continuation byte
-      if (i + 1 >= length || !is_valid_utf8_sequence(bytes + i, 2))
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence");
-      }
-      utf16.push_back(static_cast<char16_t>(((bytes[i] & 0x1FU) << 6U) | (bytes[i + 1] & 0x3FU)));
-      i += 2;
-    }
-    else if ((bytes[i] & 0xF0U) == 0xE0U)
-    {
-      // Three-byte character, check if the next two bytes are valid continuation bytes
-      if (i + 2 >= length || !is_valid_utf8_sequence(bytes + i, 3))
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence");
-      }
-      utf16.push_back(static_cast<char16_t>(((bytes[i] & 0x0FU) << 12U) | ((bytes[i + 1] & 0x3FU) << 6U) | (bytes[i + 2] & 0x3FU)));
-      i += 3;
-    }
-    else if ((bytes[i] & 0xF8U) == 0xF0U)
-    {
-      // Four-byte character, check if the next three bytes are valid continuation bytes
-      if (i + 3 >= length || !is_valid_utf8_sequence(bytes + i, 4))
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence");
-      }
-      uint32_t codepoint = (static_cast<uint32_t>(bytes[i] & 0x07U) << 18U) | (static_cast<uint32_t>(bytes[i + 1] & 0x3FU) << 12U)
-        | (static_cast<uint32_t>(bytes[i + 2] & 0x3FU) << 6U) | (static_cast<uint32_t>(bytes[i + 3] & 0x3FU));
-      if (codepoint > 0x10FFFFU)
-      {
-        throw std::runtime_error("Invalid UTF-8 codepoint");
-      }
-      if (codepoint <= 0xFFFFU)
-      {
-        utf16.push_back(static_cast<char16_t>(codepoint));
-      }
-      else
-      {
-        // Encode as a surrogate pair
-        codepoint -= 0x10000;
-        utf16.push_back(static_cast<char16_t>((codepoint >> 10U) + 0xD800U));
-        utf16.push_back(static_cast<char16_t>((codepoint & 0x3FFU) + 0xDC00U));
-      }
-      i += 4;
-    }
-    else
-    {
-      throw std::runtime_error("Invalid UTF-8 sequence");
-    }
-  }
+  return word & (word << 1U) & (word << 2U) & (word << 3U) & swar_high_bits;
 }
 
-void converter::utf16_to_utf8_scalar(const char16_t *chars, std::size_t length, std::string &utf8)
+// Number of lanes flagged in the high bit of their byte
+static inline auto flagged_bytes(uint64_t flags) -> std::size_t
 {
-  for (std::size_t i = 0; i < length; ++i)
-  {
-    const char16_t chr = chars[i];
+  return static_cast<std::size_t>(((flags >> 7U) * swar_ones) >> 56U);
+}
 
-    if (chr < 0x80)
-    {
-      // 1-byte sequence (ASCII)
-      utf8.push_back(static_cast<char>(chr));
-    }
-    else if (chr < 0x800)
-    {
-      // 2-byte sequence
-      utf8.push_back(static_cast<char>(0xC0U | ((static_cast<unsigned int>(chr) >> 6U) & 0x1FU)));
-      utf8.push_back(static_cast<char>(0x80U | (static_cast<unsigned int>(chr) & 0x3FU)));
-    }
-    else if ((chr >= 0xD800U) && (chr <= 0xDBFFU))
-    {
-      // Handle UTF-16 surrogate pairs
-      if (i + 1 >= length)
-      {
-        throw std::runtime_error("Invalid UTF-16 sequence");
-      }
+// Bits that are clear in a word of UTF-16 or UTF-32 units when all four or both of them are ASCII
+static inline auto ascii_units_mask16(bool swap) -> uint64_t
+{
+  return swap ? 0x80FF80FF80FF80FFULL : 0xFF80FF80FF80FF80ULL;
+}
 
-      const char16_t chr2 = chars[i + 1];
-      if ((chr2 < 0xDC00U) || (chr2 > 0xDFFFU))
-      {
-        throw std::runtime_error("Invalid UTF-16 sequence");
-      }
+static inline auto ascii_units_mask32(bool swap) -> uint64_t
+{
+  return swap ? 0x80FFFFFF80FFFFFFULL : 0xFFFFFF80FFFFFF80ULL;
+}
 
-      const auto codepoint = static_cast<uint32_t>(((chr & 0x3FFU) << 10U) | (chr2 & 0x3FFU)) + 0x10000U;
-      utf8.push_back(static_cast<char>(0xF0U | ((codepoint >> 18U) & 0x07U)));
-      utf8.push_back(static_cast<char>(0x80U | ((codepoint >> 12U) & 0x3FU)));
-      utf8.push_back(static_cast<char>(0x80U | ((codepoint >> 6U) & 0x3FU)));
-      utf8.push_back(static_cast<char>(0x80U | (codepoint & 0x3FU)));
-      ++i;  // Skip the next character as it is part of the surrogate pair
-    }
-    else if ((chr >= 0xDC00U) && (chr <= 0xDFFFU))
-    {
-      // Lone low surrogate, not valid by itself
-      throw std::runtime_error("Invalid UTF-16 sequence");
-    }
-    else
-    {
-      // 3-byte sequence
-      utf8.push_back(static_cast<char>(0xE0U | ((static_cast<unsigned int>(chr) >> 12U) & 0x0FU)));
-      utf8.push_back(static_cast<char>(0x80U | ((static_cast<unsigned int>(chr) >> 6U) & 0x3FU)));
-      utf8.push_back(static_cast<char>(0x80U | (static_cast<unsigned int>(chr) & 0x3FU)));
-    }
-  }
+static inline auto byteswap16(char16_t value) -> char16_t
+{
+  return static_cast<char16_t>(((static_cast<uint32_t>(value) >> 8U) | (static_cast<uint32_t>(value) << 8U)) & 0xFFFFU);
 }
 
-void converter::utf16_to_utf32_scalar(const char16_t *chars, std::size_t length, std::u32string &utf32)
+static inline auto byteswap32(char32_t value) -> char32_t
 {
-  for (std::size_t i = 0; i < length; ++i)
-  {
-    const char16_t chr = chars[i];
+  const auto word = static_cast<uint32_t>(value);
+  return static_cast<char32_t>((word >> 24U) | ((word >> 8U) & 0xFF00U) | ((word << 8U) & 0xFF0000U) | (word << 24U));
+}
 
-    if (chr >= 0xD800U && chr <= 0xDBFFU)
-    {
-      // High surrogate, must be followed by a low surrogate
-      if (i + 1 >= length)
-      {
-        throw std::runtime_error("Invalid UTF-16 sequence (truncated surrogate pair)");
-      }
+// Reads a code unit, swapping its bytes when the input is not in host byte order
+static inline auto load_unit(const char16_t *chars, std::size_t index, bool swap) -> char16_t
+{
+  return swap ? byteswap16(chars[index]) : chars[index];
+}
 
-      const char16_t chr2 = chars[i + 1];
-      if (chr2 < 0xDC00U || chr2 > 0xDFFFU)
-      {
-        throw std::runtime_error("Invalid UTF-16 sequence (invalid surrogate pair)");
-      }
+static inline auto load_unit(const char32_t *chars, std::size_t index, bool swap) -> char32_t
+{
+  return swap ? byteswap32(chars[index]) : chars[index];
+}
 
-      const auto codepoint = static_cast<uint32_t>(((static_cast<unsigned int>(chr) & 0x3FFU) << 10U) | (static_cast<unsigned int>(chr2) & 0x3FFU)) + 0x10000U;
-      utf32.push_back(codepoint);
-      ++i;  // Skip the next character as it is part of the surrogate pair
-    }
-    else if (chr >= 0xDC00U && chr <= 0xDFFFU)
-    {
-      // Low surrogate without preceding high surrogate
-      throw std::runtime_error("Invalid UTF-16 sequence (lone low surrogate)");
-    }
-    else
-    {
-      // Valid BMP character
-      utf32.push_back(static_cast<char32_t>(chr));
-    }
-  }
+// Writes a code unit, swapping its bytes when the output is not in host byte order
+static inline auto store_unit(char16_t *chars, std::size_t index, char16_t value, bool swap) -> void
+{
+  chars[index] = swap ? byteswap16(value) : value;
 }
 
-void converter::utf32_to_utf16_scalar(const char32_t *chars, std::size_t length, std::u16string &utf16)
+static inline auto store_unit(char32_t *chars, std::size_t index, char32_t value, bool swap) -> void
 {
-  for (std::size_t i = 0; i < length; ++i)
-  {
-    char32_t codepoint = chars[i];
+  chars[index] = swap ? byteswap32(value) : value;
+}
 
-    if (codepoint <= 0xFFFFU)
-    {
-      // BMP character
-      utf16.push_back(static_cast<char16_t>(codepoint));
-    }
-    else if (codepoint <= 0x10FFFFU)
-    {
-      // Encode as a surrogate pair
-      codepoint -= 0x10000;
-      utf16.push_back(static_cast<char16_t>((codepoint >> 10U) + 0xD800U));
-      utf16.push_back(static_cast<char16_t>((codepoint & 0x3FFU) + 0xDC00U));
-    }
-    else
-    {
-      // Invalid Unicode range
-      throw std::runtime_error("Invalid UTF-32 code point: out of Unicode range");
-    }
-  }
+// A code unit in output byte order, for appending to the output
+static inline auto order_unit(char16_t value, bool swap) -> char16_t
+{
+  return swap ? byteswap16(value) : value;
 }
 
-void converter::utf8_to_utf32_scalar(const unsigned char *bytes, std::size_t length, std::u32string &utf32)  // NOLINT(readability-function-cognitive-complexity)
+static inline auto order_unit(char32_t value, bool swap) -> char32_t
 {
-  for (std::size_t i = 0; i < length;)
+  return swap ? byteswap32(value) : value;
+}
+
+#if defined(RAPIDUTF_USE_AVX2)
+// Byte swap fused into the load: a single in-lane shuffle per 32-byte register
+static inline auto load_utf16_avx2(const char16_t *src, bool swap) -> __m256i
+{
+  const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  if (!swap)
   {
-    const unsigned char chr1 = bytes[i];
+    return data;
+  }
+  const __m256i shuffle = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  return _mm256_shuffle_epi8(data, shuffle);
+}
 
-    if (chr1 < 0x80)
-    {
-      // 1-byte sequence (ASCII)
-      utf32.push_back(static_cast<char32_t>(chr1));
-      ++i;
-    }
-    else if ((chr1 & 0xE0U) == 0xC0U)
-    {
-      // 2-byte sequence
-      if (i + 1 >= length)
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence (truncated 2-byte sequence)");
-      }
+static inline auto swap_utf32_avx2(__m256i data) -> __m256i
+{
+  const __m256i shuffle = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  return _mm256_shuffle_epi8(data, shuffle);
+}
 
-      const unsigned char chr2 = bytes[i + 1];
-      if ((chr2 & 0xC0U) != 0x80U)
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence (invalid continuation byte in 2-byte sequence)");
-      }
-
-      utf32.push_back(static_cast<char32_t>(((chr1 & 0x1FU) << 6U) | (chr2 & 0x3FU)));
-      i += 2;
-    }
-    else if ((chr1 & 0xF0U) == 0xE0U)
-    {
-      // 3-byte sequence
-      if (i + 2 >= length)
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence (truncated 3-byte sequence)");
-      }
+static inline auto swap_utf16_sse(__m128i data) -> __m128i
+{
+  return _mm_or_si128(_mm_slli_epi16(data, 8), _mm_srli_epi16(data, 8));
+}
 
-      const unsigned char chr2 = bytes[i + 1];
-      const unsigned char chr3 = bytes[i + 2];
-      if ((chr2 & 0xC0U) != 0x80U || (chr3 & 0xC0U) != 0x80U)
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence (invalid continuation bytes in 3-byte sequence)");
-      }
+static inline auto load_utf32_avx2(const char32_t *src, bool swap) -> __m256i
+{
+  const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  return swap ? swap_utf32_avx2(data) : data;
+}
 
-      utf32.push_back(static_cast<char32_t>(((chr1 & 0x0FU) << 12U) | ((chr2 & 0x3FU) << 6U) | (chr3 & 0x3FU)));
-      i += 3;
-    }
-    else if ((chr1 & 0xF8U) == 0xF0U)
-    {
-      // 4-byte sequence
-      if (i + 3 >= length)
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence (truncated 4-byte sequence)");
-      }
+// Loads the first `count` (below 8) units and zeroes the other lanes. Masked-off lanes are not read, so the load
+// never touches memory past the end of the input.
+static inline auto load_utf32_partial_avx2(const char32_t *src, std::size_t count, bool swap) -> __m256i
+{
+  const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(count)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  const __m256i data = _mm256_maskload_epi32(reinterpret_cast<const int *>(src), mask);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  return swap ? swap_utf32_avx2(data) : data;
+}
 
-      const unsigned char chr2 = bytes[i + 1];
-      const unsigned char chr3 = bytes[i + 2];
-      const unsigned char chr4 = bytes[i + 3];
-      if ((chr2 & 0xC0U) != 0x80U || (chr3 & 0xC0U) != 0x80U || (chr4 & 0xC0U) != 0x80U)
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence (invalid continuation bytes in 4-byte sequence)");
-      }
+// All-ones lanes for units that are not code points. The upper bound is compared unsigned: a signed compare lets units
+// with the top bit set through, and the 16-bit pack then saturates them to zero.
+static inline auto invalid_utf32_avx2(__m256i input) -> __m256i
+{
+  const __m256i max_code_point = _mm256_set1_epi32(0x10FFFF);
+  const __m256i in_range = _mm256_cmpeq_epi32(_mm256_max_epu32(input, max_code_point), max_code_point);
+  const __m256i surrogate = _mm256_and_si256(_mm256_cmpgt_epi32(input, _mm256_set1_epi32(0xD7FF)), _mm256_cmpgt_epi32(_mm256_set1_epi32(0xE000), input));
+  return _mm256_or_si256(_mm256_andnot_si256(in_range, _mm256_set1_epi32(-1)), surrogate);
+}
 
-      utf32.push_back(static_cast<char32_t>(((chr1 & 0x07U) << 18U) | ((chr2 & 0x3FU) << 12U) | ((chr3 & 0x3FU) << 6U) | (chr4 & 0x3FU)));
-      i += 4;
-    }
-    else
-    {
-      throw std::runtime_error("Invalid UTF-8 sequence (invalid start byte)");
-    }
-  }
+// Movemask bits of the last `count` of `lanes` lanes, for a final block that overlaps `lanes - count` lanes already
+// processed. Each lane has `32 / lanes` bits.
+static inline auto tail_lanes(std::size_t count, std::size_t lanes) -> uint32_t
+{
+  return ~uint32_t {0} << ((lanes - count) * (32 / lanes));
+}
+#elif defined(RAPIDUTF_USE_NEON)
+static inline auto swap_utf16_neon(uint16x8_t data) -> uint16x8_t
+{
+  return vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(data)));
 }
 
-void converter::utf32_to_utf8_scalar(const char32_t *chars, std::size_t length, std::string &utf8)
+static inline auto swap_utf32_neon(uint32x4_t data) -> uint32x4_t
 {
-  for (std::size_t i = 0; i < length; ++i)
-  {
-    const char32_t codepoint = chars[i];
+  return vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(data)));
+}
 
-    if (codepoint < 0x80)
-    {
-      // 1-byte sequence (ASCII)
-      utf8.push_back(static_cast<char>(codepoint));
-    }
-    else if (codepoint < 0x800)
-    {
-      // 2-byte sequence
-      utf8.push_back(static_cast<char>(0xC0U | ((codepoint >> 6U) & 0x1FU)));
-      utf8.push_back(static_cast<char>(0x80U | (codepoint & 0x3FU)));
-    }
-    else if (codepoint < 0x10000)
-    {
-      // 3-byte sequence
-      utf8.push_back(static_cast<char>(0xE0U | ((codepoint >> 12U) & 0x0FU)));
-      utf8.push_back(static_cast<char>(0x80U | ((codepoint >> 6U) & 0x3FU)));
-      utf8.push_back(static_cast<char>(0x80U | (codepoint & 0x3FU)));
-    }
-    else if (codepoint <= 0x10FFFF)
-    {
-      // 4-byte sequence
-      utf8.push_back(static_cast<char>(0xF0U | ((codepoint >> 18U) & 0x07U)));
-      utf8.push_back(static_cast<char>(0x80U | ((codepoint >> 12U) & 0x3FU)));
-      utf8.push_back(static_cast<char>(0x80U | ((codepoint >> 6U) & 0x3FU)));
-      utf8.push_back(static_cast<char>(0x80U | (codepoint & 0x3FU)));
-    }
-    else
-    {
-      throw std::runtime_error("Invalid UTF-32 code point");
-    }
-  }
+static inline auto load_utf16_neon(const char16_t *src, bool swap) -> uint16x8_t
+{
+  const uint16x8_t data = vld1q_u16(reinterpret_cast<const uint16_t *>(src));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  return swap ? swap_utf16_neon(data) : data;
 }
 
-#if defined(RAPIDUTF_USE_AVX2)
+static inline auto load_utf32_neon(const char32_t *src, bool swap) -> uint32x4_t
+{
+  const uint32x4_t data = vld1q_u32(reinterpret_cast<const uint32_t *>(src));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  return swap ? swap_utf32_neon(data) : data;
+}
 
-auto converter::utf8_to_utf16_avx2(const std::string &utf8) -> std::u16string
+// Byte lanes holding the last `count` of 16 bytes, for a final block that overlaps bytes already processed
+static inline auto tail_lanes_neon(std::size_t count) -> uint8x16_t
 {
-  std::u16string utf16;
-  utf16.reserve(utf8.size());
+  static constexpr std::array<uint8_t, 16> index {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+  return vcgeq_u8(vld1q_u8(index.data()), vdupq_n_u8(static_cast<uint8_t>(16 - count)));
+}
+#endif
 
-  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-  std::size_t length = utf8.length();
+// Destination of the pointer variants: caller-owned storage of fixed capacity behind the part of the std::basic_string
+// interface the kernels use, so they are instantiated for both. Growing does not initialise the new units, and growing
+// past the capacity throws, which for a destination sized by the length functions only happens on invalid input.
+// Thrown when a fixed destination has no room left for the converted output
+[[noreturn]] static auto output_overflow() -> void
+{
+  throw std::runtime_error("Converted output does not fit the destination");
+}
 
-  for (std::size_t i = 0; i < length;)
+template<typename Unit>
+class unit_sink
+{
+public:
+  unit_sink(Unit *data, std::size_t capacity)
+      : data_(data)
+      , capacity_(capacity)
   {
-    if (length - i >= 32)
-    {
-      __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-      __m256i mask = _mm256_set1_epi8(static_cast<char>(0x80));
-      __m256i result = _mm256_cmpeq_epi8(_mm256_and_si256(chunk, mask), _mm256_setzero_si256());
-      int bitfield = _mm256_movemask_epi8(result);
-
-      if (bitfield == static_cast<int>(0xFFFFFFFF))
-      {
-        // All characters in the chunk are ASCII
-        __m256i ascii_chunk = chunk;
-
-        // Shift left by 8 bits to align ASCII values to high bytes
-        __m256i ascii_chunk_hi = _mm256_slli_epi16(ascii_chunk, 8);
+  }
 
-        // Combine low and high bytes
-        ascii_chunk = _mm256_or_si256(ascii_chunk, ascii_chunk_hi);
+  auto data() -> Unit * { return data_; }
+  auto size() const -> std::size_t { return size_; }
+  auto capacity() const -> std::size_t { return capacity_; }
+  auto operator[](std::size_t index) -> Unit & { return data_[index]; }
 
-        // Store the result directly into the utf16 string
-        utf16.resize(utf16.size() + 16);
-        _mm256_storeu_si256(reinterpret_cast<__m256i *>(&utf16[utf16.size() - 16]), ascii_chunk);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto clear() -> void { size_ = 0; }
+  auto reserve(std::size_t /*count*/) -> void {}
 
-        i += 32;
-      }
-      else
-      {
-        // Handle non-ASCII characters with AVX2
-        utf8_to_utf16_scalar(bytes + i, length - i, utf16);
-        break;
-      }
+  auto resize(std::size_t count) -> void
+  {
+    if (count > capacity_)
+    {
+      output_overflow();
     }
-    else
+    size_ = count;
+  }
+
+  auto push_back(Unit unit) -> void
+  {
+    if (size_ == capacity_)
     {
-      utf8_to_utf16_scalar(bytes + i, length - i, utf16);
-      break;
+      output_overflow();
     }
+    data_[size_++] = unit;
   }
 
-  return utf16;
+  auto append(const Unit *units, std::size_t count) -> void
+  {
+    const std::size_t offset = size_;
+    resize(size_ + count);
+    std::copy_n(units, count, data_ + offset);
+  }
+
+  template<typename Iterator>
+  auto assign(Iterator first, Iterator last) -> void
+  {
+    resize(static_cast<std::size_t>(std::distance(first, last)));
+    std::transform(first, last, data_, [](auto unit) { return static_cast<Unit>(unit); });
+  }
+
+private:
+  Unit *data_;
+  std::size_t size_ = 0;
+  std::size_t capacity_;
+};
+
+// Appends up to `count` units of scratch space for a decoder that trims the output afterwards, and returns how many it
+// got: a string grows by all of them, a fixed destination by what it has left
+template<typename Unit>
+static inline auto grow_scratch(std::basic_string<Unit> &output, std::size_t count) -> std::size_t
+{
+  output.resize(output.size() + count);
+  return count;
 }
 
-auto converter::utf16_to_utf8_avx2(const std::u16string &utf16) -> std::string
+template<typename Unit>
+static inline auto grow_scratch(unit_sink<Unit> &output, std::size_t count) -> std::size_t
 {
-  std::string utf8;
-  utf8.reserve(utf16.length() * 3);  // Reserve max possible size
+  const std::size_t room = std::min(count, output.capacity() - output.size());
+  output.resize(output.size() + room);
+  return room;
+}
 
-  const char16_t *src = utf16.data();
-  size_t len = utf16.length();
+// Only caller-owned destinations take streaming stores. Growing a string value-initializes the new units first, which
+// brings the very cache lines into the cache that streaming stores are meant to bypass.
+template<typename Output>
+static constexpr bool writes_uninitialized = false;
 
-  while (len >= 16)
-  {
-    __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+template<typename Unit>
+static constexpr bool writes_uninitialized<unit_sink<Unit>> = true;
 
-    // Check for surrogate pairs
-    __m256i surrogates =
-      _mm256_and_si256(_mm256_cmpgt_epi16(input, _mm256_set1_epi16(static_cast<int16_t>(0xD7FF))), _mm256_cmpgt_epi16(_mm256_set1_epi16(static_cast<int16_t>(0xE000)), input));
+static auto swap_units(char16_t *chars, std::size_t length) -> void
+{
+  std::size_t i = 0;
 
-    auto surrogate_mask = static_cast<uint32_t>(_mm256_movemask_epi8(surrogates));
+#if defined(RAPIDUTF_USE_AVX2)
+  for (; i + 16 <= length; i += 16)
+  {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(chars + i), load_utf16_avx2(chars + i, true));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+#elif defined(RAPIDUTF_USE_NEON)
+  for (; i + 8 <= length; i += 8)
+  {
+    vst1q_u16(reinterpret_cast<uint16_t *>(chars + i), load_utf16_neon(chars + i, true));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+#endif
 
-    if (surrogate_mask == 0)
-    {
-      // No surrogate pairs, process 16 characters at once
-      __m256i mask1 = _mm256_cmpgt_epi16(input, _mm256_set1_epi16(0x7F));
-      __m256i mask2 = _mm256_cmpgt_epi16(input, _mm256_set1_epi16(0x7FF));
+  for (; i < length; ++i)
+  {
+    chars[i] = byteswap16(chars[i]);
+  }
+}
 
-      __m256i bytes1 = _mm256_or_si256(_mm256_and_si256(input, _mm256_set1_epi16(0x3F)), _mm256_set1_epi16(0x80));
-      __m256i bytes2 = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(input, 6), _mm256_set1_epi16(0x3F)), _mm256_set1_epi16(0x80));
-      __m256i bytes3 = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(input, 12), _mm256_set1_epi16(0x0F)), _mm256_set1_epi16(0xE0));
+static auto swap_units(char32_t *chars, std::size_t length) -> void
+{
+  std::size_t i = 0;
 
-      __m256i result1 = _mm256_blendv_epi8(input, bytes1, mask1);
-      __m256i result2 = _mm256_blendv_epi8(bytes2, bytes3, mask2);
+#if defined(RAPIDUTF_USE_AVX2)
+  for (; i + 8 <= length; i += 8)
+  {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(chars + i), load_utf32_avx2(chars + i, true));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+#elif defined(RAPIDUTF_USE_NEON)
+  for (; i + 4 <= length; i += 4)
+  {
+    vst1q_u32(reinterpret_cast<uint32_t *>(chars + i), load_utf32_neon(chars + i, true));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+#endif
 
-      __m256i output = _mm256_packus_epi16(result1, result2);
-      output = _mm256_permutevar8x32_epi32(output, _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7));
+  for (; i < length; ++i)
+  {
+    chars[i] = byteswap32(chars[i]);
+  }
+}
 
-      std::array<char, 32> buffer {0};
-      _mm256_storeu_si256(reinterpret_cast<__m256i *>(buffer.data()), output);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+#if defined(RAPIDUTF_ENABLE_STATS)
 
-      size_t output_size = 16 + static_cast<size_t>(_mm256_movemask_epi8(mask1)) + static_cast<size_t>(_mm256_movemask_epi8(mask2));
-      utf8.append(buffer.data(), output_size);
+// Runtime statistics. Each thread counts into its own block with relaxed loads and stores, so counting never
+// contends on a cache line; converter::stats() adds up the blocks of live threads and the totals of exited ones.
+enum class stat : std::size_t
+{
+  calls,
+  invalid_input,
+  small_input_bytes,
+  simd_bytes,
+  simd_scalar_bytes,
+  scalar_transitions,
+  fallback_bytes,
+  count,
+};
 
-      src += 16;
-      len -= 16;
-    }
-    else
-    {
-      // Process characters one by one when surrogate pairs are present
-      break;
-    }
-  }
+static constexpr std::size_t conversion_count = std::tuple_size<decltype(runtime_stats::conversions)>::value;
+static constexpr auto stat_count = static_cast<std::size_t>(stat::count);
 
-  // Handle remaining characters
-  utf16_to_utf8_scalar(utf16.data(), len, utf8);
+using stat_totals = std::array<std::array<uint64_t, stat_count>, conversion_count>;
 
-  return utf8;
-}
+struct stats_block;
 
-auto converter::utf16_to_utf32_avx2(const std::u16string &utf16) -> std::u32string  // NOLINT(readability-function-cognitive-complexity)
+struct stats_registry
 {
-  std::u32string utf32;
-  utf32.reserve(utf16.size());
+  std::mutex mutex;
+  std::vector<const stats_block *> blocks;
+  stat_totals retired {};
+};
 
-  const char16_t *input = utf16.data();
-  const size_t length = utf16.size();
+static auto registry() -> stats_registry &
+{
+  // Never destroyed: threads may still exit and retire their counts during static destruction
+  static stats_registry &instance = *new stats_registry;  // NOLINT(cppcoreguidelines-owning-memory)
+  return instance;
+}
 
-  std::array<char32_t, 16> buffer {0};
-  size_t i = 0;
+struct stats_block
+{
+  std::array<std::array<std::atomic<uint64_t>, stat_count>, conversion_count> values {};
 
-  for (; i + 15 < length; i += 16)
+  stats_block()
   {
-    __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-
-    // Check for surrogates
-    __m256i surr_mask = _mm256_set1_epi16(static_cast<int16_t>(0xF800));
-    __m256i surr_test = _mm256_set1_epi16(static_cast<int16_t>(0xD800));
-    __m256i is_surrogate = _mm256_cmpeq_epi16(_mm256_and_si256(data, surr_mask), surr_test);
-    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(is_surrogate));
-
-    if (mask == 0)
-    {
-      // No surrogates: we can safely expand directly to UTF-32
-      __m256i low = _mm256_unpacklo_epi16(data, _mm256_setzero_si256());
-      __m256i high = _mm256_unpackhi_epi16(data, _mm256_setzero_si256());
+    const std::lock_guard<std::mutex> lock(registry().mutex);
+    registry().blocks.push_back(this);
+  }
 
-      _mm256_storeu_si256(reinterpret_cast<__m256i *>(buffer.data()), low);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-      _mm256_storeu_si256(reinterpret_cast<__m256i *>(buffer.data() + 8), high);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-      utf32.insert(utf32.end(), buffer.data(), buffer.data() + 16);
-    }
-    else
-    {
-      // Handle surrogates and irregular data with scalar approach
-      for (std::size_t j = 0; j < 16; ++j)
-      {
-        char16_t part = input[i + j];
-        if (part < 0xD800 || part > 0xDFFF)
-        {
-          utf32.push_back(part);
-        }
-        else if (part >= 0xD800 && part <= 0xDBFF)
-        {
-          if (i + j + 1 >= length)
-          {
-            throw std::runtime_error("Invalid UTF-16: Unexpected end of input after high surrogate");
-          }
-          char16_t low_surrogate = input[i + j + 1];
-          if (low_surrogate < 0xDC00 || low_surrogate > 0xDFFF)
-          {
-            throw std::runtime_error("Invalid UTF-16: Invalid low surrogate");
-          }
-          uint32_t surrogate_pair = 0x10000U + ((static_cast<uint32_t>(part) - 0xD800U) << 10U) + (static_cast<uint32_t>(low_surrogate) - 0xDC00U);
-          utf32.push_back(surrogate_pair);
-          ++j;  // skip the next code unit
-        }
-        else
-        {
-          throw std::runtime_error("Invalid UTF-16: Unexpected low surrogate");
-        }
-      }
-    }
+  ~stats_block()
+  {
+    stats_registry &shared = registry();
+    const std::lock_guard<std::mutex> lock(shared.mutex);
+    add_to(shared.retired);
+    shared.blocks.erase(std::find(shared.blocks.begin(), shared.blocks.end(), this));
   }
 
-  // Handle any leftover characters that didn't fit into a 16-character block
-  for (; i < length; i++)
+  stats_block(const stats_block &) = delete;
+  stats_block(stats_block &&) = delete;
+  auto operator=(const stats_block &) -> stats_block & = delete;
+  auto operator=(stats_block &&) -> stats_block & = delete;
+
+  auto add_to(stat_totals &totals) const -> void
   {
-    char16_t part = input[i];
-    if (part < 0xD800 || part > 0xDFFF)
-    {
-      utf32.push_back(part);
-    }
-    else if (part >= 0xD800 && part <= 0xDBFF)
+    for (std::size_t direction = 0; direction < conversion_count; ++direction)
     {
-      if (i + 1 >= length)
-      {
-        throw std::runtime_error("Invalid UTF-16: Unexpected end of input after high surrogate");
-      }
-      char16_t low_surrogate = input[i + 1];
-      if (low_surrogate < 0xDC00 || low_surrogate > 0xDFFF)
+      for (std::size_t field = 0; field < stat_count; ++field)
       {
-        throw std::runtime_error("Invalid UTF-16: Invalid low surrogate");
+        totals.at(direction).at(field) += values.at(direction).at(field).load(std::memory_order_relaxed);
       }
-      uint32_t surrogate_pair = 0x10000U + ((static_cast<uint32_t>(part) - 0xD800U) << 10U) + (static_cast<uint32_t>(low_surrogate) - 0xDC00U);
-      utf32.push_back(surrogate_pair);
-      ++i;  // skip the next code unit
-    }
-    else
-    {
-      throw std::runtime_error("Invalid UTF-16: Unexpected low surrogate");
     }
   }
+};
 
-  return utf32;
+static inline auto stats_add(conversion direction, stat field, uint64_t amount) -> void
+{
+  thread_local stats_block block;
+  std::atomic<uint64_t> &value = block.values.at(static_cast<std::size_t>(direction)).at(static_cast<std::size_t>(field));
+  value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
 }
 
-auto converter::utf32_to_utf16_avx2(const std::u32string &utf32) -> std::u16string
+// Counts a range a SIMD kernel hands to scalar code
+static inline auto stats_scalar(conversion direction, uint64_t amount) -> void
 {
-  std::u16string utf16;
-  utf16.reserve(utf32.size());
+  if (amount != 0)
+  {
+    stats_add(direction, stat::simd_scalar_bytes, amount);
+    stats_add(direction, stat::scalar_transitions, 1);
+  }
+}
 
-  const auto *src = reinterpret_cast<const uint32_t *>(utf32.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-  size_t len = utf32.size();
+// Counts a call of a public conversion, and an invalid input when the call leaves by an exception
+class stats_call
+{
+public:
+  explicit stats_call(conversion direction)
+    : m_direction(direction)
+    , m_exceptions(std::uncaught_exceptions())
+  {
+    stats_add(direction, stat::calls, 1);
+  }
 
-  while (len > 0)
+  ~stats_call()
   {
-    if (len >= 8)
+    if (std::uncaught_exceptions() > m_exceptions)
     {
-      __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      stats_add(m_direction, stat::invalid_input, 1);
+    }
+  }
 
-      // Check if all code points are valid (0 <= x <= 0x10FFFF, excluding surrogates)
-      __m256i too_large = _mm256_cmpgt_epi32(input, _mm256_set1_epi32(0x10FFFF));
-      __m256i surrogate_range = _mm256_and_si256(_mm256_cmpgt_epi32(input, _mm256_set1_epi32(0xD7FF)), _mm256_cmpgt_epi32(_mm256_set1_epi32(0xE000), input));
-      __m256i invalid_mask = _mm256_or_si256(too_large, surrogate_range);
+  stats_call(const stats_call &) = delete;
+  stats_call(stats_call &&) = delete;
+  auto operator=(const stats_call &) -> stats_call & = delete;
+  auto operator=(stats_call &&) -> stats_call & = delete;
 
-      if (_mm256_movemask_ps(_mm256_castsi256_ps(invalid_mask)) != 0)
-      {
-        throw std::runtime_error("Invalid UTF-32 input");
-      }
+private:
+  conversion m_direction;
+  int m_exceptions;
+};
 
-      // Check if all code points are below 0x10000
-      __m256i mask = _mm256_cmpgt_epi32(input, _mm256_set1_epi32(0xFFFF));
-      int mask_result = _mm256_movemask_ps(_mm256_castsi256_ps(mask));
+#  define RAPIDUTF_STATS_CALL(direction) const stats_call call_stats(conversion::direction)
+#  define RAPIDUTF_STATS_ADD(direction, field, amount) stats_add(conversion::direction, stat::field, static_cast<uint64_t>(amount))
+#  define RAPIDUTF_STATS_SCALAR(direction, amount) stats_scalar(conversion::direction, static_cast<uint64_t>(amount))
 
-      if (mask_result == 0)
-      {
-        // All code points are below 0x10000, direct conversion
-        __m128i low = _mm256_castsi256_si128(input);
-        __m128i high = _mm256_extracti128_si256(input, 1);
-        __m128i result = _mm_packus_epi32(low, high);
+#else
 
-        // char16_t buffer[8];
-        std::array<char16_t, 8> buffer {0};
-        _mm_storeu_si128(reinterpret_cast<__m128i *>(buffer.data()), result);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-        utf16.append(buffer.data(), 8);
+#  define RAPIDUTF_STATS_CALL(direction) static_cast<void>(0)
+#  define RAPIDUTF_STATS_ADD(direction, field, amount) static_cast<void>(0)
+#  define RAPIDUTF_STATS_SCALAR(direction, amount) static_cast<void>(0)
 
-        src += 8;
-        len -= 8;
-      }
-      else
-      {
-        // Some code points are above 0xFFFF, handle individually
-        break;
-      }
-    }
-    else
-    {
-      break;
-    }
-  }
+#endif
 
-  // Handle remaining characters
-  for (; len > 0; --len, ++src)
+auto converter::is_valid_utf8_sequence(const unsigned char *bytes, int length) -> bool
+{
+  if (length == 1)
   {
-    uint32_t codepoint = *src;
-    if (codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+    return (bytes[0] & 0x80U) == 0;
+  }
+  if (length == 2)
+  {
+    if ((bytes[0] & 0xE0U) == 0xC0 && (bytes[1] & 0xC0U) == 0x80)
     {
-      throw std::runtime_error("Invalid UTF-32 input");
+      // Check for overlong encoding
+      const uint32_t code_point = ((bytes[0] & 0x1FU) << 6U) | (bytes[1] & 0x3FU);
+      return code_point >= 0x80;
     }
-    if (codepoint <= 0xFFFF)
+    return false;
+  }
+  if (length == 3)
+  {
+    if ((bytes[0] & 0xF0U) == 0xE0 && (bytes[1] & 0xC0U) == 0x80 && (bytes[2] & 0xC0U) == 0x80)
     {
-      utf16.push_back(static_cast<char16_t>(codepoint));
+      // Check for overlong encoding
+      const uint32_t code_point = ((bytes[0] & 0x0FU) << 12U) | ((bytes[1] & 0x3FU) << 6U) | (bytes[2] & 0x3FU);
+      return code_point >= 0x800 && code_point <= 0xFFFF;
     }
-    else
+    return false;
+  }
+  if (length == 4)
+  {
+    if ((bytes[0] & 0xF8U) == 0xF0 && (bytes[1] & 0xC0U) == 0x80 && (bytes[2] & 0xC0U) == 0x80 && (bytes[3] & 0xC0U) == 0x80)
     {
-      codepoint -= 0x10000;
-      utf16.push_back(static_cast<char16_t>((codepoint >> 10U) + 0xD800U));
-      utf16.push_back(static_cast<char16_t>((codepoint & 0x3FFU) + 0xDC00U));
+      // Check for overlong encoding and valid Unicode code point
+      const uint32_t code_point = ((bytes[0] & 0x07U) << 18U) | ((bytes[1] & 0x3FU) << 12U) | ((bytes[2] & 0x3FU) << 6U) | (bytes[3] & 0x3FU);
+      return code_point >= 0x10000 && code_point <= 0x10FFFF;
     }
+    return false;
   }
-
-  return utf16;
+  return false;
 }
 
-auto converter::utf8_to_utf32_avx2(const std::string &utf8) -> std::u32string  // NOLINT(readability-function-cognitive-complexity)
+auto converter::is_valid_utf8(std::string_view utf8) -> bool
 {
-  std::u32string utf32;
-  utf32.reserve(utf8.size());  // Reserve space for worst case scenario
-
-  const auto *input = reinterpret_cast<const uint8_t *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-  const uint8_t *end = input + utf8.size();
-
-  __m256i mask_1 = _mm256_set1_epi8(static_cast<char>(0x80));
+  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  return utf8_valid_prefix(bytes, utf8.length()) == utf8.length();
+}
 
-  while (input + 32 <= end)
+// Returns the length of the longest prefix made of complete, valid UTF-8 sequences
+auto converter::utf8_valid_prefix(const unsigned char *bytes, std::size_t length) -> std::size_t
+{
+  std::size_t i = 0;
+  while (i < length)
   {
-    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-    auto ascii_mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(chunk, mask_1), _mm256_setzero_si256())));
-
-    if (ascii_mask == 0xFFFFFFFF)
+#if defined(RAPIDUTF_USE_AVX2)
+    // Skip whole blocks of ASCII
+    while (length - i >= 32 && _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i))) == 0)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
     {
-      // All bytes are ASCII
-      size_t current_size = utf32.size();
-      utf32.resize(current_size + 32);
-      char32_t *output = &utf32[current_size];
-
-      _mm_storeu_si128(reinterpret_cast<__m128i *>(output), _mm256_castsi256_si128(chunk));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-      _mm_storeu_si128(reinterpret_cast<__m128i *>(output + 16), _mm256_extracti128_si256(chunk, 1));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-
-      input += 32;
+      i += 32;
     }
-    else
+    const std::size_t stop = std::min(length, i + 32);
+#elif defined(RAPIDUTF_USE_NEON)
+    while (length - i >= 16 && vmaxvq_u8(vld1q_u8(bytes + i)) < 0x80)
     {
-      // Process ASCII characters in bulk
-      int ascii_count = ctz(~ascii_mask);
-      if (ascii_count > 0)
-      {
-        size_t current_size = utf32.size();
-        utf32.resize(current_size + static_cast<size_t>(ascii_count));
-        char32_t *output = &utf32[current_size];
-
-        for (int i = 0; i < ascii_count; ++i)
-        {
-          output[i] = input[i];
-        }
-        input += ascii_count;
-      }
-
-      // Process the first non-ASCII character
-      if (input >= end)
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence");
-      }
-      if ((*input & 0xE0U) == 0xC0U)
-      {
-        if (input + 1 >= end || (input[1] & 0xC0U) != 0x80U)
-        {
-          throw std::runtime_error("Invalid UTF-8 sequence");
-        }
-        auto codepoint = static_cast<uint32_t>(((*input & 0x1FU) << 6U) | (*(input + 1U) & 0x3FU));
-        if (codepoint < 0x80)
-        {
-          throw std::runtime_error("Invalid UTF-8 sequence");  // Overlong encoding
-        }
-        utf32.push_back(codepoint);
-        input += 2;
-      }
-      else if ((*input & 0xF0U) == 0xE0U)
-      {
-        if (input + 2 >= end || (input[1] & 0xC0U) != 0x80U || (input[2] & 0xC0U) != 0x80U)
-        {
-          throw std::runtime_error("Invalid UTF-8 sequence");
-        }
-        auto codepoint = (static_cast<uint32_t>(*input & 0x0FU) << 12U) | (static_cast<uint32_t>(*(input + 1U) & 0x3FU) << 6U) | (static_cast<uint32_t>(*(input + 2) & 0x3FU));
-        if (codepoint < 0x800U || (codepoint >= 0xD800U && codepoint <= 0xDFFFU))
-        {
-          throw std::runtime_error("Invalid UTF-8 sequence");  // Overlong encoding or surrogate
-        }
-        utf32.push_back(codepoint);
-        input += 3;
-      }
-      else if ((*input & 0xF8U) == 0xF0U)
-      {
-        if (input + 3 >= end || (input[1] & 0xC0U) != 0x80U || (input[2] & 0xC0U) != 0x80U || (input[3] & 0xC0U) != 0x80U)
-        {
-          throw std::runtime_error("Invalid UTF-8 sequence");
-        }
-        auto codepoint = static_cast<uint32_t>(((*input & 0x07U) << 18U) | ((*(input + 1) & 0x3FU) << 12U) | ((*(input + 2) & 0x3FU) << 6U) | (*(input + 3) & 0x3FU));
-        if (codepoint < 0x10000 || codepoint > 0x10FFFF)
-        {
-          throw std::runtime_error("Invalid UTF-8 sequence");  // Overlong encoding or out of Unicode range
-        }
-        utf32.push_back(codepoint);
-        input += 4;
-      }
-      else
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence");
-      }
+      i += 16;
     }
-  }
+    const std::size_t stop = std::min(length, i + 16);
+#else
+    const std::size_t stop = length;
+#endif
 
-  // Handle remaining bytes
-  while (input < end)
-  {
-    if (*input < 0x80)
+    // Run the DFA over the block containing non-ASCII bytes and on until its last sequence is complete. Reject is
+    // absorbing, so tracking where the last complete sequence ended is enough to report the valid prefix afterwards.
+    uint32_t state = utf8_accept;
+    std::size_t valid_end = i;
+    for (; i < length && (i < stop || (state != utf8_accept && state != utf8_reject)); ++i)
     {
-      utf32.push_back(*input++);
+      state = utf8_next_state(state, bytes[i]);
+      valid_end = state == utf8_accept ? i + 1 : valid_end;
     }
-    else if ((*input & 0xE0U) == 0xC0U)
+    if (state != utf8_accept)
     {
-      if (input + 1 >= end || (input[1] & 0xC0U) != 0x80U)
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence");
-      }
-      auto codepoint = (static_cast<uint32_t>(*input & 0x1FU) << 6U) | (static_cast<uint32_t>(*(input + 1) & 0x3FU));
-      if (codepoint < 0x80)
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence");  // Overlong encoding
-      }
-      utf32.push_back(codepoint);
-      input += 2;
+      return valid_end;
     }
-    else if ((*input & 0xF0U) == 0xE0U)
-    {
-      if (input + 2 >= end || (input[1] & 0xC0U) != 0x80U || (input[2] & 0xC0U) != 0x80U)
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence");
-      }
-      auto codepoint = (static_cast<uint32_t>(*reinterpret_cast<const uint8_t *>(input) & 0x0FU) << 12U)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-        | (static_cast<uint32_t>(*reinterpret_cast<const uint8_t *>(input + 1) & 0x3FU) << 6U)
-        | (static_cast<uint32_t>(*reinterpret_cast<const uint8_t *>(input + 2) & 0x3FU));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+  return length;
+}
 
-      if (codepoint < 0x800 || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
-      {
-        throw std::runtime_error("Invalid UTF-8 sequence");  // Overlong encoding or surrogate
-      }
-      utf32.push_back(codepoint);
-      input += 3;
-    }
-    else if ((*input & 0xF8U) == 0xF0U)
+auto converter::is_valid_utf16(const std::u16string &utf16) -> bool
+{
+  return is_valid_utf16(utf16, byte_order::native);
+}
+
+auto converter::is_valid_utf16(std::u16string_view utf16, byte_order order) -> bool
+{
+  const char16_t *chars = utf16.data();
+  const std::size_t length = utf16.length();
+  const bool swap = order != byte_order::native;
+
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    const char16_t chr = load_unit(chars, i, swap);
+    if (chr >= 0xD800 && chr <= 0xDBFF)
     {
-      if (input + 3 >= end || (input[1] & 0xC0U) != 0x80U || (input[2] & 0xC0U) != 0x80U || (input[3] & 0xC0U) != 0x80U)
+      if (i + 1 >= length)
       {
-        throw std::runtime_error("Invalid UTF-8 sequence");
+        return false;
       }
-      uint32_t codepoint = (static_cast<uint32_t>(*input & 0x07U) << 18U) | (static_cast<uint32_t>(*(input + 1) & 0x3FU) << 12U)
-        | (static_cast<uint32_t>(*(input + 2) & 0x3FU) << 6U) | (static_cast<uint32_t>(*(input + 3) & 0x3FU));
-      if (codepoint < 0x10000 || codepoint > 0x10FFFFU)
+      const char16_t next = load_unit(chars, i + 1, swap);
+      if (next < 0xDC00 || next > 0xDFFF)
       {
-        throw std::runtime_error("Invalid UTF-8 sequence");  // Overlong encoding or out of Unicode range
+        return false;
       }
-      utf32.push_back(codepoint);
-      input += 4;
+      ++i;
     }
-    else
+    else if (chr >= 0xDC00 && chr <= 0xDFFF)
     {
-      throw std::runtime_error("Invalid UTF-8 sequence");
+      return false;
     }
   }
+  return true;
+}
 
-  return utf32;
+auto converter::is_valid_utf32(const std::u32string &utf32) -> bool
+{
+  return is_valid_utf32(utf32, byte_order::native);
 }
 
-auto converter::utf32_to_utf8_avx2(const std::u32string &utf32) -> std::string
+auto converter::is_valid_utf32(std::u32string_view utf32, byte_order order) -> bool
 {
-  const char32_t *src = utf32.data();
-  size_t len = utf32.length();
-  std::string utf8;
-  utf8.reserve(len * 4);  // Reserve space for worst-case scenario
+  const char32_t *chars = utf32.data();
+  const std::size_t length = utf32.length();
+  const bool swap = order != byte_order::native;
 
-  size_t i = 0;
-  for (; i + 8 <= len; i += 8)
+  for (std::size_t i = 0; i < length; ++i)
   {
-    __m256i codepoints = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const char32_t chr = load_unit(chars, i, swap);
 
-    // Check for invalid codepoints
-    __m256i invalid = _mm256_or_si256(_mm256_cmpgt_epi32(codepoints, _mm256_set1_epi32(0x10FFFF)),
-                                      _mm256_and_si256(_mm256_cmpgt_epi32(codepoints, _mm256_set1_epi32(0xD7FF)), _mm256_cmpgt_epi32(_mm256_set1_epi32(0xE000), codepoints)));
-
-    if (_mm256_testz_si256(invalid, invalid) == 0)
+    // Check if the code point is within the Unicode range
+    if (chr > 0x10FFFF)
     {
-      throw std::runtime_error("Invalid UTF-32 codepoint detected");
+      return false;
     }
 
-    // Compute the lengths of UTF-8 sequences for each codepoint
-    __m256i lengths = _mm256_set1_epi32(1);
-    lengths = _mm256_add_epi32(lengths, _mm256_and_si256(_mm256_cmpgt_epi32(codepoints, _mm256_set1_epi32(0x7F)), _mm256_set1_epi32(1)));
-    lengths = _mm256_add_epi32(lengths, _mm256_and_si256(_mm256_cmpgt_epi32(codepoints, _mm256_set1_epi32(0x7FF)), _mm256_set1_epi32(1)));
-    lengths = _mm256_add_epi32(lengths, _mm256_and_si256(_mm256_cmpgt_epi32(codepoints, _mm256_set1_epi32(0xFFFF)), _mm256_set1_epi32(1)));
-
-    // Compute the total length of the UTF-8 sequences
-    __m256i sum = _mm256_hadd_epi32(lengths, lengths);
-    sum = _mm256_hadd_epi32(sum, sum);
-    int total_length = _mm256_extract_epi32(sum, 0) + _mm256_extract_epi32(sum, 4);
-
-    // Resize the output string to accommodate the new UTF-8 sequences
-    size_t prev_size = utf8.size();
-    utf8.resize(prev_size + static_cast<size_t>(total_length));
-
-    char *dst = &utf8[prev_size];
-
-    // Process each codepoint and generate the corresponding UTF-8 sequence
-    for (std::size_t j = 0; j < 8; ++j)
+    // Surrogate pairs are not valid in UTF-32
+    if (chr >= 0xD800 && chr <= 0xDFFF)
     {
-      char32_t codepoint = src[i + j];
-      if (codepoint <= 0x7F)
-      {
-        *dst++ = static_cast<char>(codepoint);
-      }
-      else if (codepoint <= 0x7FF)
-      {
-        *dst++ = static_cast<char>(0xC0U | (codepoint >> 6U));
-        *dst++ = static_cast<char>(0x80U | (codepoint & 0x3FU));
-      }
-      else if (codepoint <= 0xFFFF)
-      {
-        *dst++ = static_cast<char>(0xE0U | (codepoint >> 12U));
-        *dst++ = static_cast<char>(0x80U | ((codepoint >> 6U) & 0x3FU));
-        *dst++ = static_cast<char>(0x80U | (codepoint & 0x3FU));
-      }
-      else
-      {
-        *dst++ = static_cast<char>(0xF0U | (codepoint >> 18U));
-        *dst++ = static_cast<char>(0x80U | ((codepoint >> 12U) & 0x3FU));
-        *dst++ = static_cast<char>(0x80U | ((codepoint >> 6U) & 0x3FU));
-        *dst++ = static_cast<char>(0x80U | (codepoint & 0x3FU));
-      }
+      return false;
     }
   }
 
-  // Process the remaining codepoints (less than 8)
-  for (; i < len; ++i)
+  return true;
+}
+
+template<typename Output>
+void converter::utf8_to_utf16_scalar(const unsigned char *bytes, std::size_t length, Output &utf16, byte_order order)
+{
+  // Every input byte yields at most one code unit, so the output is sized once and trimmed at the end. The extra unit
+  // is room for the second half of a surrogate pair, which is written on every byte. A fixed destination may have
+  // less room than that, and its last units are then decoded through a spare pair and copied once complete.
+  const std::size_t offset = utf16.size();
+  const std::size_t room = grow_scratch(utf16, length + 1);
+  char16_t *out = utf16.data() + offset;
+  const char16_t *const limit = out + room;
+  const bool swap = order != byte_order::native;
+
+  // Branch-free per byte: the decoder always writes, and the output only advances when a code point is complete.
+  // Invalid input leaves the DFA in the absorbing reject state, so it is enough to check the state once at the end.
+  uint32_t state = utf8_accept;
+  uint32_t codepoint = 0;
+  const auto decode = [&](unsigned char byte)
   {
-    char32_t codepoint = src[i];
-    if (codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
-    {
-      throw std::runtime_error("Invalid UTF-32 codepoint detected");
-    }
-    if (codepoint <= 0x7F)
+    utf8_decode_step(state, codepoint, byte);
+    const uint32_t supplementary = codepoint > 0xFFFFU ? 1U : 0U;
+    const uint32_t offset_codepoint = codepoint - 0x10000U;
+    store_unit(out, 0, static_cast<char16_t>(supplementary != 0 ? (offset_codepoint >> 10U) + 0xD800U : codepoint), swap);
+    store_unit(out, 1, static_cast<char16_t>((offset_codepoint & 0x3FFU) + 0xDC00U), swap);
+    out += state == utf8_accept ? 1 + supplementary : 0;
+  };
+
+  // A word writes at most 10 units: 9 when it completes a sequence that started before it, and the spare one
+  std::size_t i = 0;
+  for (; i + 8 <= length && limit - out >= 10;)
+  {
+    // Whole words of ASCII between sequences skip the decoder
+    if (ascii_word(bytes + i) && state == utf8_accept)
     {
-      utf8 += static_cast<char>(codepoint);
+      for (std::size_t k = 0; k < 8; ++k)
+      {
+        store_unit(out, k, static_cast<char16_t>(bytes[i + k]), swap);
+      }
+      out += 8;
+      i += 8;
+      continue;
     }
-    else if (codepoint <= 0x7FF)
+    for (const std::size_t word_end = i + 8; i < word_end; ++i)
     {
-      utf8 += static_cast<char>(0xC0U | (codepoint >> 6U));
-      utf8 += static_cast<char>(0x80U | (codepoint & 0x3FU));
+      decode(bytes[i]);
     }
-    else if (codepoint <= 0xFFFF)
+  }
+  for (; i < length; ++i)
+  {
+    if (limit - out >= 2)
     {
-      utf8 += static_cast<char>(0xE0U | (codepoint >> 12U));
-      utf8 += static_cast<char>(0x80U | ((codepoint >> 6U) & 0x3FU));
-      utf8 += static_cast<char>(0x80U | (codepoint & 0x3FU));
+      decode(bytes[i]);
+      continue;
     }
-    else
+    std::array<char16_t, 2> spare {};
+    char16_t *const at = out;
+    out = spare.data();
+    decode(bytes[i]);
+    const auto units = static_cast<std::size_t>(out - spare.data());
+    if (units > static_cast<std::size_t>(limit - at))
     {
-      utf8 += static_cast<char>(0xF0U | (codepoint >> 18U));
-      utf8 += static_cast<char>(0x80U | ((codepoint >> 12U) & 0x3FU));
-      utf8 += static_cast<char>(0x80U | ((codepoint >> 6U) & 0x3FU));
-      utf8 += static_cast<char>(0x80U | (codepoint & 0x3FU));
+      output_overflow();
     }
+    std::copy_n(spare.data(), units, at);
+    out = at + units;
   }
 
-  return utf8;
+  if (state != utf8_accept)
+  {
+    throw std::runtime_error(state == utf8_reject ? "Invalid UTF-8 sequence" : "Invalid UTF-8 sequence (truncated)");
+  }
+  utf16.resize(static_cast<std::size_t>(out - utf16.data()));
 }
 
-#elif defined(RAPIDUTF_USE_NEON)
-
-auto converter::utf8_to_utf16_neon(const std::string &utf8) -> std::u16string
+template<typename Output>
+void converter::utf16_to_utf8_scalar(const char16_t *chars, std::size_t length, Output &utf8, byte_order order)
 {
-  std::u16string utf16;
-  utf16.reserve(utf8.size());  // Reserve initial capacity
-  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-  const std::size_t length = utf8.length();
-  for (std::size_t i = 0; i < length;)
+  const bool swap = order != byte_order::native;
+  const uint64_t ascii_mask = ascii_units_mask16(swap);
+
+  for (std::size_t i = 0; i < length; ++i)
   {
-    if (length - i >= 16)
+    // Runs of ASCII, found four units at a time, are narrowed in one step
+    std::size_t run_end = i;
+    while (length - run_end >= 4 && (load_word(chars + run_end) & ascii_mask) == 0)
     {
-      const uint8x16_t chunk = vld1q_u8(bytes + i);
-      const uint8x16_t mask = vdupq_n_u8(0x80);
-      const uint8x16_t result = vceqq_u8(vandq_u8(chunk, mask), vdupq_n_u8(0));
-      const uint64_t bitfield_lo = vgetq_lane_u64(vreinterpretq_u64_u8(result), 0);
-      const uint64_t bitfield_hi = vgetq_lane_u64(vreinterpretq_u64_u8(result), 1);
-      const uint64_t bitfield = bitfield_lo | (bitfield_hi << 8U);
-      if (bitfield == 0xFFFFFFFFFFFFFFFF)
+      run_end += 4;
+    }
+    if (run_end != i)
+    {
+      const std::size_t offset = utf8.size();
+      utf8.resize(offset + run_end - i);
+      for (std::size_t k = i; k < run_end; ++k)
       {
-        // All characters in the chunk are ASCII
-        const uint16x8_t chunk_lo = vmovl_u8(vget_low_u8(chunk));
-        const uint16x8_t chunk_hi = vmovl_u8(vget_high_u8(chunk));
-        const size_t old_size = utf16.size();
-        utf16.resize(old_size + 16);  // Resize before writing
-        vst1q_u16(reinterpret_cast<uint16_t *>(&utf16[old_size]), chunk_lo);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-        vst1q_u16(reinterpret_cast<uint16_t *>(&utf16[old_size + 8]), chunk_hi);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-        i += 16;
+        utf8[offset + k - i] = static_cast<char>(load_unit(chars, k, swap));
       }
-      else
+      i = run_end;
+      if (i == length)
       {
-        // Handle non-ASCII characters
-        utf8_to_utf16_scalar(bytes + i, length - i, utf16);
         break;
       }
     }
-    else
+
+    const char16_t chr = load_unit(chars, i, swap);
+
+    if (chr < 0x80)
     {
-      utf8_to_utf16_scalar(bytes + i, length - i, utf16);
-      break;
+      // 1-byte sequence (ASCII)
+      utf8.push_back(static_cast<char>(chr));
     }
-  }
-  return utf16;
-}
-
-auto converter::utf16_to_utf8_neon(const std::u16string &utf16) -> std::string
-{
-  std::string utf8;
-  utf8.reserve(utf16.size() * 3);  // Reserve initial capacity
-  const char16_t *chars = utf16.data();
-  const std::size_t length = utf16.length();
-  for (std::size_t i = 0; i < length;)
-  {
-    if (length - i >= 16)
+    else if (chr < 0x800)
+    {
+      // 2-byte sequence
+      utf8.push_back(static_cast<char>(0xC0U | ((static_cast<unsigned int>(chr) >> 6U) & 0x1FU)));
+      utf8.push_back(static_cast<char>(0x80U | (static_cast<unsigned int>(chr) & 0x3FU)));
+    }
+    else if ((chr >= 0xD800U) && (chr <= 0xDBFFU))
     {
-      const uint16x8_t chunk1 = vld1q_u16(reinterpret_cast<const uint16_t *>(chars + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-      const uint16x8_t chunk2 = vld1q_u16(reinterpret_cast<const uint16_t *>(chars + i + 8));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-      const uint16x8_t mask = vdupq_n_u16(0x7F);
-      const uint16x8_t result1 = vceqq_u16(vandq_u16(chunk1, mask), chunk1);
-      const uint16x8_t result2 = vceqq_u16(vandq_u16(chunk2, mask), chunk2);
-      const uint64_t bitfield1 = vgetq_lane_u64(vreinterpretq_u64_u16(result1), 0);
-      const uint64_t bitfield2 = vgetq_lane_u64(vreinterpretq_u64_u16(result2), 0);
-      if (bitfield1 == 0xFFFFFFFFFFFFFFFF && bitfield2 == 0xFFFFFFFFFFFFFFFF)
+      // Handle UTF-16 surrogate pairs
+      if (i + 1 >= length)
       {
-        // All characters in the chunk are ASCII
-        const uint8x8_t chunk1_lo = vmovn_u16(chunk1);
-        const uint8x8_t chunk1_hi = vmovn_u16(vshrq_n_u16(chunk1, 8));
-        const uint8x8_t chunk2_lo = vmovn_u16(chunk2);
-        const uint8x8_t chunk2_hi = vmovn_u16(vshrq_n_u16(chunk2, 8));
-        // Widen the 8-bit vectors to 16-bit vectors
-        const uint8x16_t chunk1_lo_wide = vcombine_u8(chunk1_lo, chunk1_lo);
-        const uint8x16_t chunk1_hi_wide = vcombine_u8(chunk1_hi, chunk1_hi);
-        const uint8x16_t chunk2_lo_wide = vcombine_u8(chunk2_lo, chunk2_lo);
-        const uint8x16_t chunk2_hi_wide = vcombine_u8(chunk2_hi, chunk2_hi);
-        const size_t old_size = utf8.size();
-        utf8.resize(old_size + 64);  // Resize before writing
-        vst1q_u8(reinterpret_cast<uint8_t *>(&utf8[old_size]), chunk1_lo_wide);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-        vst1q_u8(reinterpret_cast<uint8_t *>(&utf8[old_size + 16]), chunk1_hi_wide);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-        vst1q_u8(reinterpret_cast<uint8_t *>(&utf8[old_size + 32]), chunk2_lo_wide);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-        vst1q_u8(reinterpret_cast<uint8_t *>(&utf8[old_size + 48]), chunk2_hi_wide);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-        i += 16;
+        throw std::runtime_error("Invalid UTF-16 sequence");
       }
-      else
+
+      const char16_t chr2 = load_unit(chars, i + 1, swap);
+      if ((chr2 < 0xDC00U) || (chr2 > 0xDFFFU))
       {
-        // Handle non-ASCII characters with NEON
-        utf16_to_utf8_scalar(chars + i, length - i, utf8);
-        break;
+        throw std::runtime_error("Invalid UTF-16 sequence");
       }
+
+      const auto codepoint = static_cast<uint32_t>(((chr & 0x3FFU) << 10U) | (chr2 & 0x3FFU)) + 0x10000U;
+      utf8.push_back(static_cast<char>(0xF0U | ((codepoint >> 18U) & 0x07U)));
+      utf8.push_back(static_cast<char>(0x80U | ((codepoint >> 12U) & 0x3FU)));
+      utf8.push_back(static_cast<char>(0x80U | ((codepoint >> 6U) & 0x3FU)));
+      utf8.push_back(static_cast<char>(0x80U | (codepoint & 0x3FU)));
+      ++i;  // Skip the next character as it is part of the surrogate pair
+    }
+    else if ((chr >= 0xDC00U) && (chr <= 0xDFFFU))
+    {
+      // Lone low surrogate, not valid by itself
+      throw std::runtime_error("Invalid UTF-16 sequence");
     }
     else
     {
-      utf16_to_utf8_scalar(chars + i, length - i, utf8);
-      break;
+      // 3-byte sequence
+      utf8.push_back(static_cast<char>(0xE0U | ((static_cast<unsigned int>(chr) >> 12U) & 0x0FU)));
+      utf8.push_back(static_cast<char>(0x80U | ((static_cast<unsigned int>(chr) >> 6U) & 0x3FU)));
+      utf8.push_back(static_cast<char>(0x80U | (static_cast<unsigned int>(chr) & 0x3FU)));
     }
   }
-  return utf8;
 }
 
-auto converter::utf16_to_utf32_neon(const std::u16string &utf16) -> std::u32string
+template<typename Output>
+void converter::utf16_to_utf32_scalar(const char16_t *chars, std::size_t length, Output &utf32, byte_order from, byte_order to)
 {
-  std::u32string utf32;
-  utf32.reserve(utf16.size());  // Reserve enough space initially
+  const bool swap = from != byte_order::native;
+  const bool swap_out = to != byte_order::native;
 
-  const char16_t *chars = utf16.data();
-  const std::size_t length = utf16.length();
-
-  std::size_t i = 0;
-  while (i < length)
+  for (std::size_t i = 0; i < length; ++i)
   {
-    if (length - i >= 8)
-    {
-      const uint16x8_t chunk = vld1q_u16(reinterpret_cast<const uint16_t *>(chars + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-      const uint16x8_t high_surrogate = vandq_u16(chunk, vdupq_n_u16(0xFC00));
-      const uint16x8_t is_surrogate = vceqq_u16(high_surrogate, vdupq_n_u16(0xD800));
-      const uint64_t bitfield = vgetq_lane_u64(vreinterpretq_u64_u16(is_surrogate), 0);
+    const char16_t chr = load_unit(chars, i, swap);
 
-      if (bitfield == 0)
+    if (chr >= 0xD800U && chr <= 0xDBFFU)
+    {
+      // High surrogate, must be followed by a low surrogate
+      if (i + 1 >= length)
       {
-        // No surrogates in the chunk, so we can directly convert the UTF-16 characters to UTF-32
-        const uint16x4_t chunk_lo = vget_low_u16(chunk);
-        const uint16x4_t chunk_hi = vget_high_u16(chunk);
-        utf32.resize(utf32.size() + 8);  // Resize once
-        utf32[utf32.size() - 8] = static_cast<char32_t>(vget_lane_u16(chunk_lo, 0));
-        utf32[utf32.size() - 7] = static_cast<char32_t>(vget_lane_u16(chunk_lo, 1));
-        utf32[utf32.size() - 6] = static_cast<char32_t>(vget_lane_u16(chunk_lo, 2));
-        utf32[utf32.size() - 5] = static_cast<char32_t>(vget_lane_u16(chunk_lo, 3));
-        utf32[utf32.size() - 4] = static_cast<char32_t>(vget_lane_u16(chunk_hi, 0));
-        utf32[utf32.size() - 3] = static_cast<char32_t>(vget_lane_u16(chunk_hi, 1));
-        utf32[utf32.size() - 2] = static_cast<char32_t>(vget_lane_u16(chunk_hi, 2));
-        utf32[utf32.size() - 1] = static_cast<char32_t>(vget_lane_u16(chunk_hi, 3));
-        i += 8;
+        throw std::runtime_error("Invalid UTF-16 sequence (truncated surrogate pair)");
       }
-      else
+
+      const char16_t chr2 = load_unit(chars, i + 1, swap);
+      if (chr2 < 0xDC00U || chr2 > 0xDFFFU)
       {
-        // Surrogates present in the chunk, so we need to handle them separately
-        utf16_to_utf32_scalar(chars + i, length - i, utf32);
-        break;
+        throw std::runtime_error("Invalid UTF-16 sequence (invalid surrogate pair)");
       }
+
+      const auto codepoint = static_cast<uint32_t>(((static_cast<unsigned int>(chr) & 0x3FFU) << 10U) | (static_cast<unsigned int>(chr2) & 0x3FFU)) + 0x10000U;
+      utf32.push_back(order_unit(static_cast<char32_t>(codepoint), swap_out));
+      ++i;  // Skip the next character as it is part of the surrogate pair
+    }
+    else if (chr >= 0xDC00U && chr <= 0xDFFFU)
+    {
+      // Low surrogate without preceding high surrogate
+      throw std::runtime_error("Invalid UTF-16 sequence (lone low surrogate)");
     }
     else
     {
-      utf16_to_utf32_scalar(chars + i, length - i, utf32);
-      break;
+      // Valid BMP character
+      utf32.push_back(order_unit(static_cast<char32_t>(chr), swap_out));
     }
   }
-
-  return utf32;
 }
 
-auto converter::utf32_to_utf16_neon(const std::u32string &utf32) -> std::u16string  // NOLINT(readability-function-cognitive-complexity)
+template<typename Output>
+void converter::utf32_to_utf16_scalar(const char32_t *chars, std::size_t length, Output &utf16, byte_order from, byte_order to)
 {
-  if (!is_valid_utf32(utf32))
+  const bool swap = from != byte_order::native;
+  const bool swap_out = to != byte_order::native;
+
+  for (std::size_t i = 0; i < length; ++i)
   {
-    throw std::runtime_error("Invalid UTF-32 string");
-  }
+    char32_t codepoint = load_unit(chars, i, swap);
 
-  std::u16string utf16;
-  utf16.reserve(utf32.size() * 2);
+    if (codepoint >= 0xD800U && codepoint <= 0xDFFFU)
+    {
+      // Surrogates are not scalar values
+      throw std::runtime_error("Invalid UTF-32 code point");
+    }
+    if (codepoint <= 0xFFFFU)
+    {
+      // BMP character
+      utf16.push_back(order_unit(static_cast<char16_t>(codepoint), swap_out));
+    }
+    else if (codepoint <= 0x10FFFFU)
+    {
+      // Encode as a surrogate pair
+      codepoint -= 0x10000;
+      utf16.push_back(order_unit(static_cast<char16_t>((codepoint >> 10U) + 0xD800U), swap_out));
+      utf16.push_back(order_unit(static_cast<char16_t>((codepoint & 0x3FFU) + 0xDC00U), swap_out));
+    }
+    else
+    {
+      // Invalid Unicode range
+      throw std::runtime_error("Invalid UTF-32 code point: out of Unicode range");
+    }
+  }
+}
 
-  const char32_t *chars = utf32.data();
-  const std::size_t length = utf32.length();
+template<typename Output>
+void converter::utf8_to_utf32_scalar(const unsigned char *bytes, std::size_t length, Output &utf32, byte_order order)
+{
+  // Every input byte yields at most one code point, so the output is sized once and trimmed at the end. The last units
+  // of a fixed destination with less room go through a spare unit, as in utf8_to_utf16_scalar.
+  const std::size_t offset = utf32.size();
+  const std::size_t room = grow_scratch(utf32, length);
+  char32_t *out = utf32.data() + offset;
+  const char32_t *const limit = out + room;
+  const bool swap = order != byte_order::native;
+
+  // Branch-free per byte, as in utf8_to_utf16_scalar
+  uint32_t state = utf8_accept;
+  uint32_t codepoint = 0;
+  const auto decode = [&](unsigned char byte)
+  {
+    utf8_decode_step(state, codepoint, byte);
+    store_unit(out, 0, static_cast<char32_t>(codepoint), swap);
+    out += state == utf8_accept ? 1 : 0;
+  };
 
-  if (length >= 16)
+  std::size_t i = 0;
+  for (; i + 8 <= length && limit - out >= 8;)
   {
-    // Process blocks of 16 characters
-    std::size_t i = 0;
-    for (; i + 16 <= length; i += 16)
+    if (ascii_word(bytes + i) && state == utf8_accept)
     {
-      const uint32x4_t chunk1 = vld1q_u32(reinterpret_cast<const uint32_t *>(chars + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-      const uint32x4_t chunk2 = vld1q_u32(reinterpret_cast<const uint32_t *>(chars + i + 4));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-      const uint32x4_t chunk3 = vld1q_u32(reinterpret_cast<const uint32_t *>(chars + i + 8));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-      const uint32x4_t chunk4 = vld1q_u32(reinterpret_cast<const uint32_t *>(chars + i + 12));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-
-      const uint32x4_t mask1 = vcgtq_u32(chunk1, vdupq_n_u32(0xFFFF));
-      const uint32x4_t mask2 = vcgtq_u32(chunk2, vdupq_n_u32(0xFFFF));
-      const uint32x4_t mask3 = vcgtq_u32(chunk3, vdupq_n_u32(0xFFFF));
-      const uint32x4_t mask4 = vcgtq_u32(chunk4, vdupq_n_u32(0xFFFF));
-
-      const uint64x2_t result1 = vreinterpretq_u64_u32(mask1);
-      const uint64x2_t result2 = vreinterpretq_u64_u32(mask2);
-      const uint64x2_t result3 = vreinterpretq_u64_u32(mask3);
-      const uint64x2_t result4 = vreinterpretq_u64_u32(mask4);
-
-      const uint64_t combined = vgetq_lane_u64(result1, 0) | vgetq_lane_u64(result1, 1) | vgetq_lane_u64(result2, 0) | vgetq_lane_u64(result2, 1) | vgetq_lane_u64(result3, 0)
-        | vgetq_lane_u64(result3, 1) | vgetq_lane_u64(result4, 0) | vgetq_lane_u64(result4, 1);
-
-      if (combined == 0)
+      for (std::size_t k = 0; k < 8; ++k)
       {
-        // All characters are <= 0xFFFF
-        const uint16x8_t utf16_chunk1 = vcombine_u16(vmovn_u32(chunk1), vmovn_u32(chunk2));
-        const uint16x8_t utf16_chunk2 = vcombine_u16(vmovn_u32(chunk3), vmovn_u32(chunk4));
-
-        std::array<char16_t, 16> temp {0};
-        vst1q_u16(reinterpret_cast<uint16_t *>(temp.data()), utf16_chunk1);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-        vst1q_u16(reinterpret_cast<uint16_t *>(temp.data() + 8), utf16_chunk2);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-        utf16.append(temp.data(), 16);
+        store_unit(out, k, static_cast<char32_t>(bytes[i + k]), swap);
       }
-      else
-      {
-        // Handle characters > 0xFFFF
-        auto process_chunk = [&utf16](uint32x4_t chunk)
-        {
-          const char32_t ch0 = vgetq_lane_u32(chunk, 0);
-          const char32_t ch1 = vgetq_lane_u32(chunk, 1);
-          const char32_t ch2 = vgetq_lane_u32(chunk, 2);
-          const char32_t ch3 = vgetq_lane_u32(chunk, 3);
+      out += 8;
+      i += 8;
+      continue;
+    }
+    for (const std::size_t word_end = i + 8; i < word_end; ++i)
+    {
+      decode(bytes[i]);
+    }
+  }
+  for (; i < length; ++i)
+  {
+    if (limit - out >= 1)
+    {
+      decode(bytes[i]);
+      continue;
+    }
+    char32_t spare = 0;
+    char32_t *const at = out;
+    out = &spare;
+    decode(bytes[i]);
+    if (out != &spare)
+    {
+      output_overflow();
+    }
+    out = at;
+  }
 
-          for (char32_t ch : {ch0, ch1, ch2, ch3})
-          {
-            if (ch <= 0xFFFF)
-            {
-              utf16.push_back(static_cast<char16_t>(ch));
-            }
-            else
-            {
-              ch -= 0x10000;
-              utf16.push_back(static_cast<char16_t>((ch >> 10U) + 0xD800U));
-              utf16.push_back(static_cast<char16_t>((ch & 0x3FFU) + 0xDC00U));
-            }
-          }
-        };
+  if (state != utf8_accept)
+  {
+    throw std::runtime_error(state == utf8_reject ? "Invalid UTF-8 sequence" : "Invalid UTF-8 sequence (truncated)");
+  }
+  utf32.resize(static_cast<std::size_t>(out - utf32.data()));
+}
 
-        process_chunk(chunk1);
-        process_chunk(chunk2);
-        process_chunk(chunk3);
-        process_chunk(chunk4);
-      }
-    }
+template<typename Output>
+void converter::utf32_to_utf8_scalar(const char32_t *chars, std::size_t length, Output &utf8, byte_order order)
+{
+  const bool swap = order != byte_order::native;
+  const uint64_t ascii_mask = ascii_units_mask32(swap);
 
-    // Process remaining characters
-    for (; i < length; ++i)
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    // Runs of ASCII, found two units at a time, are narrowed in one step
+    std::size_t run_end = i;
+    while (length - run_end >= 2 && (load_word(chars + run_end) & ascii_mask) == 0)
     {
-      char32_t ch = chars[i];
-      if (ch <= 0xFFFF)
+      run_end += 2;
+    }
+    if (run_end != i)
+    {
+      const std::size_t offset = utf8.size();
+      utf8.resize(offset + run_end - i);
+      for (std::size_t k = i; k < run_end; ++k)
       {
-        utf16.push_back(static_cast<char16_t>(ch));
+        utf8[offset + k - i] = static_cast<char>(load_unit(chars, k, swap));
       }
-      else
+      i = run_end;
+      if (i == length)
       {
-        ch -= 0x10000;
-        utf16.push_back(static_cast<char16_t>((ch >> 10U) + 0xD800U));
-        utf16.push_back(static_cast<char16_t>((ch & 0x3FFU) + 0xDC00U));
+        break;
       }
     }
-  }
-  else if (length >= 8)
-  {
-    // Process 8 characters using NEON
-    const uint32x4_t chunk1 = vld1q_u32(reinterpret_cast<const uint32_t *>(chars));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-    const uint32x4_t chunk2 = vld1q_u32(reinterpret_cast<const uint32_t *>(chars + 4));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-
-    const uint32x4_t mask1 = vcgtq_u32(chunk1, vdupq_n_u32(0xFFFF));
-    const uint32x4_t mask2 = vcgtq_u32(chunk2, vdupq_n_u32(0xFFFF));
-
-    const uint64x2_t result1 = vreinterpretq_u64_u32(mask1);
-    const uint64x2_t result2 = vreinterpretq_u64_u32(mask2);
 
-    const uint64_t combined = vgetq_lane_u64(result1, 0) | vgetq_lane_u64(result1, 1) | vgetq_lane_u64(result2, 0) | vgetq_lane_u64(result2, 1);
+    const char32_t codepoint = load_unit(chars, i, swap);
 
-    if (combined == 0)
+    if (codepoint < 0x80)
     {
-      const uint16x8_t utf16_chunk = vcombine_u16(vmovn_u32(chunk1), vmovn_u32(chunk2));
-      std::array<char16_t, 8> temp {0};
-      vst1q_u16(reinterpret_cast<uint16_t *>(temp.data()), utf16_chunk);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-      utf16.append(temp.data(), 8);
+      // 1-byte sequence (ASCII)
+      utf8.push_back(static_cast<char>(codepoint));
+    }
+    else if (codepoint < 0x800)
+    {
+      // 2-byte sequence
+      utf8.push_back(static_cast<char>(0xC0U | ((codepoint >> 6U) & 0x1FU)));
+      utf8.push_back(static_cast<char>(0x80U | (codepoint & 0x3FU)));
+    }
+    else if (codepoint >= 0xD800 && codepoint <= 0xDFFF)
+    {
+      // Surrogates are not code points; the short-input path reaches here without is_valid_utf32
+      throw std::runtime_error("Invalid UTF-32 code point");
+    }
+    else if (codepoint < 0x10000)
+    {
+      // 3-byte sequence
+      utf8.push_back(static_cast<char>(0xE0U | ((codepoint >> 12U) & 0x0FU)));
+      utf8.push_back(static_cast<char>(0x80U | ((codepoint >> 6U) & 0x3FU)));
+      utf8.push_back(static_cast<char>(0x80U | (codepoint & 0x3FU)));
+    }
+    else if (codepoint <= 0x10FFFF)
+    {
+      // 4-byte sequence
+      utf8.push_back(static_cast<char>(0xF0U | ((codepoint >> 18U) & 0x07U)));
+      utf8.push_back(static_cast<char>(0x80U | ((codepoint >> 12U) & 0x3FU)));
+      utf8.push_back(static_cast<char>(0x80U | ((codepoint >> 6U) & 0x3FU)));
+      utf8.push_back(static_cast<char>(0x80U | (codepoint & 0x3FU)));
     }
     else
     {
-      // Process each character individually
-      auto process_chunk = [&utf16](uint32x4_t chunk)
-      {
-        const char32_t ch0 = vgetq_lane_u32(chunk, 0);
-        const char32_t ch1 = vgetq_lane_u32(chunk, 1);
-        const char32_t ch2 = vgetq_lane_u32(chunk, 2);
-        const char32_t ch3 = vgetq_lane_u32(chunk, 3);
+      throw std::runtime_error("Invalid UTF-32 code point");
+    }
+  }
+}
 
-        for (char32_t ch : {ch0, ch1, ch2, ch3})
-        {
-          if (ch <= 0xFFFF)
-          {
-            utf16.push_back(static_cast<char16_t>(ch));
-          }
-          else
-          {
-            ch -= 0x10000;
-            utf16.push_back(static_cast<char16_t>((ch >> 10U) + 0xD800U));
-            utf16.push_back(static_cast<char16_t>((ch & 0x3FFU) + 0xDC00U));
-          }
-        }
-      };
+// Decodes UTF-8 whose code points are all below 0x100; every character takes one byte of output
+void converter::utf8_to_latin1_scalar(const unsigned char *bytes, std::size_t length, char *latin1)
+{
+  std::size_t out = 0;
+  for (std::size_t i = 0; i < length;)
+  {
+    // Copy ASCII runs in bulk
+    const std::size_t ascii = find_first_non_ascii({reinterpret_cast<const char *>(bytes + i), length - i});  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    std::copy(bytes + i, bytes + i + ascii, latin1 + out);
+    i += ascii;
+    out += ascii;
+    if (i >= length)
+    {
+      break;
+    }
 
-      process_chunk(chunk1);
+    // Only C2 and C3 lead bytes encode U+0080 to U+00FF
+    if ((bytes[i] != 0xC2U && bytes[i] != 0xC3U) || i + 1 >= length || (bytes[i + 1] & 0xC0U) != 0x80U)
+    {
+      throw std::runtime_error("Invalid UTF-8 sequence");
+    }
+    latin1[out++] = static_cast<char>(((bytes[i] & 0x1FU) << 6U) | (bytes[i + 1] & 0x3FU));
+    i += 2;
+  }
+}
+
+#if defined(RAPIDUTF_USE_AVX2)
+
+// Output size above which conversions run in large-input mode: the input is prefetched ahead and, when the output is
+// caller-owned storage, ASCII runs are widened with streaming stores that bypass the cache. Below it the output likely
+// fits the last-level cache and is read again soon, so it is better left there.
+static constexpr std::size_t nontemporal_store_threshold = std::size_t {1} << 22U;
+
+// Shortest ASCII run worth streaming in large-input mode, enough for whole cache lines after aligning the destination
+static constexpr std::size_t nontemporal_min_run = 1024;
+
+// How many input bytes ahead of the current position large-input mode prefetches
+static constexpr std::size_t prefetch_distance = 1024;
+
+static inline auto prefetch_ahead(const unsigned char *bytes, std::size_t remaining) -> void
+{
+  if (remaining > prefetch_distance)
+  {
+    _mm_prefetch(reinterpret_cast<const char *>(bytes + prefetch_distance), _MM_HINT_T0);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+}
+
+// Widened ASCII has a zero high byte, so swapping the bytes of a unit is a shift by all but one of its bytes
+static inline auto order_utf16_avx2(__m256i units, bool swap) -> __m256i
+{
+  return swap ? _mm256_slli_epi16(units, 8) : units;
+}
+
+static inline auto order_utf32_avx2(__m256i units, bool swap) -> __m256i
+{
+  return swap ? _mm256_slli_epi32(units, 24) : units;
+}
+
+// Widens ASCII bytes to UTF-16 code units, 64 bytes per unrolled step. `stream` selects streaming stores for long runs,
+// `swap` writes the units in the opposite byte order.
+static auto widen_ascii_avx2(const unsigned char *bytes, std::size_t length, char16_t *out, bool stream, bool swap) -> void
+{
+  std::size_t i = 0;
+
+  if (stream && length >= nontemporal_min_run)
+  {
+    // Streaming stores need a 32-byte aligned destination
+    for (; i < length && (reinterpret_cast<std::uintptr_t>(out + i) & 31U) != 0; ++i)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    {
+      store_unit(out, i, bytes[i], swap);
+    }
+    for (; i + 64 <= length; i += 64)
+    {
+      prefetch_ahead(bytes + i, length - i);
+      const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i + 32));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      _mm256_stream_si256(reinterpret_cast<__m256i *>(out + i), order_utf16_avx2(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(lo)), swap));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      _mm256_stream_si256(reinterpret_cast<__m256i *>(out + i + 16), order_utf16_avx2(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(lo, 1)), swap));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      _mm256_stream_si256(reinterpret_cast<__m256i *>(out + i + 32), order_utf16_avx2(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(hi)), swap));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      _mm256_stream_si256(reinterpret_cast<__m256i *>(out + i + 48), order_utf16_avx2(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(hi, 1)), swap));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    }
+    _mm_sfence();
+  }
+
+  for (; i + 64 <= length; i += 64)
+  {
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i + 32));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), order_utf16_avx2(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(lo)), swap));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 16), order_utf16_avx2(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(lo, 1)), swap));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 32), order_utf16_avx2(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(hi)), swap));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 48), order_utf16_avx2(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(hi, 1)), swap));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+  for (; i + 16 <= length; i += 16)
+  {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), order_utf16_avx2(_mm256_cvtepu8_epi16(chunk), swap));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+  if (i != length && length >= 16)
+  {
+    // The last block overlaps bytes already widened, which are stored again with the same values
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + length - 16));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + length - 16), order_utf16_avx2(_mm256_cvtepu8_epi16(chunk), swap));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    return;
+  }
+  for (; i < length; ++i)
+  {
+    store_unit(out, i, bytes[i], swap);
+  }
+}
+
+// Widens ASCII bytes to UTF-32 code units, 64 bytes per unrolled step. `stream` selects streaming stores for long runs,
+// `swap` writes the units in the opposite byte order.
+static auto widen_ascii_avx2(const unsigned char *bytes, std::size_t length, char32_t *out, bool stream, bool swap) -> void
+{
+  std::size_t i = 0;
+
+  if (stream && length >= nontemporal_min_run)
+  {
+    // Streaming stores need a 32-byte aligned destination
+    for (; i < length && (reinterpret_cast<std::uintptr_t>(out + i) & 31U) != 0; ++i)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    {
+      store_unit(out, i, bytes[i], swap);
+    }
+    for (; i + 64 <= length; i += 64)
+    {
+      prefetch_ahead(bytes + i, length - i);
+      for (std::size_t j = 0; j < 64; j += 8)
+      {
+        const __m128i chunk = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(bytes + i + j));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        _mm256_stream_si256(reinterpret_cast<__m256i *>(out + i + j), order_utf32_avx2(_mm256_cvtepu8_epi32(chunk), swap));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      }
+    }
+    _mm_sfence();
+  }
+
+  for (; i + 64 <= length; i += 64)
+  {
+    for (std::size_t j = 0; j < 64; j += 8)
+    {
+      const __m128i chunk = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(bytes + i + j));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + j), order_utf32_avx2(_mm256_cvtepu8_epi32(chunk), swap));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    }
+  }
+  for (; i + 8 <= length; i += 8)
+  {
+    const __m128i chunk = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(bytes + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), order_utf32_avx2(_mm256_cvtepu8_epi32(chunk), swap));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+  if (i != length && length >= 8)
+  {
+    // The last block overlaps bytes already widened, which are stored again with the same values
+    const __m128i chunk = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(bytes + length - 8));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + length - 8), order_utf32_avx2(_mm256_cvtepu8_epi32(chunk), swap));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    return;
+  }
+  for (; i < length; ++i)
+  {
+    store_unit(out, i, bytes[i], swap);
+  }
+}
+
+template<typename Output>
+auto converter::utf8_to_utf16_avx2(std::string_view utf8, Output &utf16, byte_order order) -> void
+{
+  utf16.reserve(utf8.size());
+
+  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  std::size_t length = utf8.length();
+  const bool large = length * sizeof(char16_t) >= nontemporal_store_threshold;
+  const bool stream = large && writes_uninitialized<Output>;
+  const bool swap = order != byte_order::native;
+
+  // ASCII fast mode: the leading ASCII run is widened in bulk
+  std::size_t i = find_first_non_ascii_avx2(bytes, length);
+  utf16.resize(i);
+  widen_ascii_avx2(bytes, i, utf16.data(), stream, swap);
+
+  while (i < length)
+  {
+    if (length - i >= 32)
+    {
+      if (large)
+      {
+        prefetch_ahead(bytes + i, length - i);
+      }
+      __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+      if (_mm256_movemask_epi8(chunk) == 0)
+      {
+        // All characters in the chunk are ASCII, so the run it starts is widened as a whole
+        const std::size_t run = 32 + find_first_non_ascii_avx2(bytes + i + 32, length - i - 32);
+        const std::size_t old_size = utf16.size();
+        utf16.resize(old_size + run);
+        widen_ascii_avx2(bytes + i, run, &utf16[old_size], stream, swap);
+        i += run;
+      }
+      else
+      {
+        // Decode this chunk and the non-ASCII chunks after it with the scalar path, extended to the next sequence
+        // boundary, then resume vector processing
+        std::size_t stop = i + 32;
+        while (length - stop >= 32 && _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + stop))) != 0)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        {
+          stop += 32;
+        }
+        while (stop < length && (bytes[stop] & 0xC0U) == 0x80U)
+        {
+          ++stop;
+        }
+        RAPIDUTF_STATS_SCALAR(utf8_to_utf16, stop - i);
+        utf8_to_utf16_scalar(bytes + i, stop - i, utf16, order);
+        i = stop;
+      }
+    }
+    else
+    {
+      // When the last 32 bytes are ASCII, the ones before the tail were already widened to the last units of the
+      // output, so the whole block is widened again over them
+      if (length >= 32 && _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + length - 32))) == 0)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      {
+        utf16.resize(utf16.size() + length - i);
+        widen_ascii_avx2(bytes + length - 32, 32, &utf16[utf16.size() - 32], false, swap);
+        break;
+      }
+      RAPIDUTF_STATS_SCALAR(utf8_to_utf16, length - i);
+      utf8_to_utf16_scalar(bytes + i, length - i, utf16, order);
+      break;
+    }
+  }
+}
+
+template<typename Output>
+auto converter::utf16_to_utf8_avx2(std::u16string_view utf16, Output &utf8, byte_order order) -> void
+{
+  utf8.reserve(utf16.length() * 3);  // Reserve max possible size
+
+  const char16_t *chars = utf16.data();
+  const std::size_t length = utf16.length();
+  const bool swap = order != byte_order::native;
+  std::size_t i = 0;
+
+  while (i + 16 <= length)
+  {
+    const __m256i chunk = load_utf16_avx2(chars + i, swap);
+    if (_mm256_testz_si256(chunk, _mm256_set1_epi16(static_cast<int16_t>(0xFF80))) != 0)
+    {
+      // All ASCII: narrow the 16 units to bytes, packus leaves them in the even quadwords
+      const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(chunk, chunk), 0xD8);
+      const std::size_t offset = utf8.size();
+      utf8.resize(offset + 16);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(&utf8[offset]), _mm256_castsi256_si128(packed));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      i += 16;
+      continue;
+    }
+
+    // Other blocks go through the scalar path, extended by a unit so a surrogate pair is never split
+    std::size_t end = i + 16;
+    if (end < length && (load_unit(chars, end - 1, swap) & 0xFC00U) == 0xD800U)
+    {
+      ++end;
+    }
+    RAPIDUTF_STATS_SCALAR(utf16_to_utf8, (end - i) * sizeof(char16_t));
+    utf16_to_utf8_scalar(chars + i, end - i, utf8, order);
+    i = end;
+  }
+
+  if (i == length)
+  {
+    return;
+  }
+
+  // When the last 16 units are ASCII, the ones before the tail were already narrowed to the last bytes of the output,
+  // so the whole block is narrowed again over them
+  if (length >= 16)
+  {
+    const __m256i chunk = load_utf16_avx2(chars + length - 16, swap);
+    if (_mm256_testz_si256(chunk, _mm256_set1_epi16(static_cast<int16_t>(0xFF80))) != 0)
+    {
+      const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(chunk, chunk), 0xD8);
+      utf8.resize(utf8.size() + length - i);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(&utf8[utf8.size() - 16]), _mm256_castsi256_si128(packed));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      return;
+    }
+  }
+
+  // Handle remaining characters
+  RAPIDUTF_STATS_SCALAR(utf16_to_utf8, (length - i) * sizeof(char16_t));
+  utf16_to_utf8_scalar(chars + i, length - i, utf8, order);
+}
+
+template<typename Output>
+auto converter::utf16_to_utf32_avx2(std::u16string_view utf16, Output &utf32, byte_order from, byte_order to) -> void  // NOLINT(readability-function-cognitive-complexity)
+{
+  utf32.reserve(utf16.size());
+
+  const char16_t *input = utf16.data();
+  const size_t length = utf16.size();
+  const bool swap = from != byte_order::native;
+  const bool swap_out = to != byte_order::native;
+
+  std::array<char32_t, 16> buffer {0};
+  size_t i = 0;
+
+  while (i + 15 < length)
+  {
+    __m256i data = load_utf16_avx2(input + i, swap);
+
+    // Check for surrogates
+    __m256i surr_mask = _mm256_set1_epi16(static_cast<int16_t>(0xF800));
+    __m256i surr_test = _mm256_set1_epi16(static_cast<int16_t>(0xD800));
+    __m256i is_surrogate = _mm256_cmpeq_epi16(_mm256_and_si256(data, surr_mask), surr_test);
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(is_surrogate));
+
+    if (mask == 0)
+    {
+      // No surrogates: we can safely expand directly to UTF-32
+      __m256i low = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(data));
+      __m256i high = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(data, 1));
+      if (swap_out)
+      {
+        low = swap_utf32_avx2(low);
+        high = swap_utf32_avx2(high);
+      }
+
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(buffer.data()), low);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(buffer.data() + 8), high);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      utf32.append(buffer.data(), 16);
+      i += 16;
+    }
+    else
+    {
+      // Handle surrogates and irregular data with scalar approach
+      std::size_t j = 0;
+      for (; j < 16; ++j)
+      {
+        char16_t part = load_unit(input, i + j, swap);
+        if (part < 0xD800 || part > 0xDFFF)
+        {
+          utf32.push_back(order_unit(static_cast<char32_t>(part), swap_out));
+        }
+        else if (part >= 0xD800 && part <= 0xDBFF)
+        {
+          if (i + j + 1 >= length)
+          {
+            throw std::runtime_error("Invalid UTF-16: Unexpected end of input after high surrogate");
+          }
+          char16_t low_surrogate = load_unit(input, i + j + 1, swap);
+          if (low_surrogate < 0xDC00 || low_surrogate > 0xDFFF)
+          {
+            throw std::runtime_error("Invalid UTF-16: Invalid low surrogate");
+          }
+          uint32_t surrogate_pair = 0x10000U + ((static_cast<uint32_t>(part) - 0xD800U) << 10U) + (static_cast<uint32_t>(low_surrogate) - 0xDC00U);
+          utf32.push_back(order_unit(static_cast<char32_t>(surrogate_pair), swap_out));
+          ++j;  // skip the next code unit
+        }
+        else
+        {
+          throw std::runtime_error("Invalid UTF-16: Unexpected low surrogate");
+        }
+      }
+      RAPIDUTF_STATS_SCALAR(utf16_to_utf32, j * sizeof(char16_t));
+      i += j;  // A surrogate pair may straddle the block boundary
+    }
+  }
+
+  // When the last 16 units have no surrogates, each one before the tail was already widened to one of the last units
+  // of the output, so the whole block is widened again over them
+  if (i != length && length >= 16)
+  {
+    const __m256i data = load_utf16_avx2(input + length - 16, swap);
+    const __m256i is_surrogate = _mm256_cmpeq_epi16(_mm256_and_si256(data, _mm256_set1_epi16(static_cast<int16_t>(0xF800))), _mm256_set1_epi16(static_cast<int16_t>(0xD800)));
+    if (_mm256_movemask_epi8(is_surrogate) == 0)
+    {
+      utf32.resize(utf32.size() + length - i);
+      char32_t *out = &utf32[utf32.size() - 16];
+      const __m256i low = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(data));
+      const __m256i high = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(data, 1));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), swap_out ? swap_utf32_avx2(low) : low);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 8), swap_out ? swap_utf32_avx2(high) : high);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      return;
+    }
+  }
+
+  // Handle any leftover characters that didn't fit into a 16-character block
+  RAPIDUTF_STATS_SCALAR(utf16_to_utf32, (length - i) * sizeof(char16_t));
+  for (; i < length; i++)
+  {
+    char16_t part = load_unit(input, i, swap);
+    if (part < 0xD800 || part > 0xDFFF)
+    {
+      utf32.push_back(order_unit(static_cast<char32_t>(part), swap_out));
+    }
+    else if (part >= 0xD800 && part <= 0xDBFF)
+    {
+      if (i + 1 >= length)
+      {
+        throw std::runtime_error("Invalid UTF-16: Unexpected end of input after high surrogate");
+      }
+      char16_t low_surrogate = load_unit(input, i + 1, swap);
+      if (low_surrogate < 0xDC00 || low_surrogate > 0xDFFF)
+      {
+        throw std::runtime_error("Invalid UTF-16: Invalid low surrogate");
+      }
+      uint32_t surrogate_pair = 0x10000U + ((static_cast<uint32_t>(part) - 0xD800U) << 10U) + (static_cast<uint32_t>(low_surrogate) - 0xDC00U);
+      utf32.push_back(order_unit(static_cast<char32_t>(surrogate_pair), swap_out));
+      ++i;  // skip the next code unit
+    }
+    else
+    {
+      throw std::runtime_error("Invalid UTF-16: Unexpected low surrogate");
+    }
+  }
+}
+
+template<typename Output>
+auto converter::utf32_to_utf16_avx2(std::u32string_view utf32, Output &utf16, byte_order from, byte_order to) -> void
+{
+  utf16.reserve(utf32.size());
+
+  const char32_t *src = utf32.data();
+  size_t len = utf32.size();
+  const bool swap = from != byte_order::native;
+  const bool swap_out = to != byte_order::native;
+
+  while (len > 0)
+  {
+    if (len >= 8)
+    {
+      __m256i input = load_utf32_avx2(src, swap);
+
+      // Check if all code points are valid (0 <= x <= 0x10FFFF, excluding surrogates)
+      __m256i invalid_mask = invalid_utf32_avx2(input);
+
+      if (_mm256_movemask_ps(_mm256_castsi256_ps(invalid_mask)) != 0)
+      {
+        throw std::runtime_error("Invalid UTF-32 input");
+      }
+
+      // Check if all code points are below 0x10000
+      __m256i mask = _mm256_cmpgt_epi32(input, _mm256_set1_epi32(0xFFFF));
+      int mask_result = _mm256_movemask_ps(_mm256_castsi256_ps(mask));
+
+      if (mask_result == 0)
+      {
+        // All code points are below 0x10000, direct conversion
+        __m128i low = _mm256_castsi256_si128(input);
+        __m128i high = _mm256_extracti128_si256(input, 1);
+        __m128i result = _mm_packus_epi32(low, high);
+        if (swap_out)
+        {
+          result = swap_utf16_sse(result);
+        }
+
+        // char16_t buffer[8];
+        std::array<char16_t, 8> buffer {0};
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(buffer.data()), result);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        utf16.append(buffer.data(), 8);
+
+        src += 8;
+        len -= 8;
+      }
+      else
+      {
+        // Some code points are above 0xFFFF, handle individually
+        break;
+      }
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  // A tail shorter than a block is loaded with a mask, its zeroed lanes are valid and left out of the output
+  if (len > 0 && len < 8)
+  {
+    const __m256i input = load_utf32_partial_avx2(src, len, swap);
+    if (_mm256_movemask_ps(_mm256_castsi256_ps(invalid_utf32_avx2(input))) != 0)
+    {
+      throw std::runtime_error("Invalid UTF-32 input");
+    }
+    if (_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(input, _mm256_set1_epi32(0xFFFF)))) == 0)
+    {
+      std::array<char16_t, 8> buffer {0};
+      const __m128i result = _mm_packus_epi32(_mm256_castsi256_si128(input), _mm256_extracti128_si256(input, 1));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(buffer.data()), swap_out ? swap_utf16_sse(result) : result);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      utf16.append(buffer.data(), len);
+      return;
+    }
+  }
+
+  // Handle remaining characters
+  RAPIDUTF_STATS_SCALAR(utf32_to_utf16, len * sizeof(char32_t));
+  for (; len > 0; --len, ++src)
+  {
+    uint32_t codepoint = load_unit(src, 0, swap);
+    if (codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+    {
+      throw std::runtime_error("Invalid UTF-32 input");
+    }
+    if (codepoint <= 0xFFFF)
+    {
+      utf16.push_back(order_unit(static_cast<char16_t>(codepoint), swap_out));
+    }
+    else
+    {
+      codepoint -= 0x10000;
+      utf16.push_back(order_unit(static_cast<char16_t>((codepoint >> 10U) + 0xD800U), swap_out));
+      utf16.push_back(order_unit(static_cast<char16_t>((codepoint & 0x3FFU) + 0xDC00U), swap_out));
+    }
+  }
+}
+
+template<typename Output>
+auto converter::utf8_to_utf32_avx2(std::string_view utf8, Output &utf32, byte_order order) -> void  // NOLINT(readability-function-cognitive-complexity)
+{
+  utf32.reserve(utf8.size());  // Reserve space for worst case scenario
+
+  const auto *input = reinterpret_cast<const uint8_t *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  const uint8_t *end = input + utf8.size();
+
+  const bool large = utf8.size() * sizeof(char32_t) >= nontemporal_store_threshold;
+  const bool stream = large && writes_uninitialized<Output>;
+  const bool swap = order != byte_order::native;
+
+  // ASCII fast mode: the leading ASCII run is widened in bulk
+  const std::size_t ascii_prefix = find_first_non_ascii_avx2(input, utf8.size());
+  utf32.resize(ascii_prefix);
+  widen_ascii_avx2(input, ascii_prefix, utf32.data(), stream, swap);
+  input += ascii_prefix;
+
+  __m256i mask_1 = _mm256_set1_epi8(static_cast<char>(0x80));
+
+  while (input + 32 <= end)
+  {
+    if (large)
+    {
+      prefetch_ahead(input, static_cast<std::size_t>(end - input));
+    }
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto ascii_mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(chunk, mask_1), _mm256_setzero_si256())));
+
+    if (ascii_mask == 0xFFFFFFFF)
+    {
+      // All bytes are ASCII, so the run they start is widened as a whole
+      const std::size_t run = 32 + find_first_non_ascii_avx2(input + 32, static_cast<std::size_t>(end - input) - 32);
+      size_t current_size = utf32.size();
+      utf32.resize(current_size + run);
+      widen_ascii_avx2(input, run, &utf32[current_size], stream, swap);
+
+      input += run;
+    }
+    else
+    {
+      // Decode this chunk and the non-ASCII chunks after it with the scalar path, extended to the next sequence
+      // boundary, then resume vector processing
+      const uint8_t *stop = input + 32;
+      while (end - stop >= 32 && _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(stop))) != 0)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      {
+        stop += 32;
+      }
+      while (stop < end && (*stop & 0xC0U) == 0x80U)
+      {
+        ++stop;
+      }
+      RAPIDUTF_STATS_SCALAR(utf8_to_utf32, stop - input);
+      utf8_to_utf32_scalar(input, static_cast<std::size_t>(stop - input), utf32, order);
+      input = stop;
+    }
+  }
+
+  // When the last 32 bytes are ASCII, the ones before the tail were already widened to the last units of the
+  // output, so the whole block is widened again over them
+  if (input != end && utf8.size() >= 32 && _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(end - 32))) == 0)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  {
+    utf32.resize(utf32.size() + static_cast<std::size_t>(end - input));
+    widen_ascii_avx2(end - 32, 32, &utf32[utf32.size() - 32], false, swap);
+    return;
+  }
+
+  // Handle remaining bytes
+  RAPIDUTF_STATS_SCALAR(utf8_to_utf32, end - input);
+  utf8_to_utf32_scalar(input, static_cast<std::size_t>(end - input), utf32, order);
+}
+
+template<typename Output>
+auto converter::utf32_to_utf8_avx2(std::u32string_view utf32, Output &utf8, byte_order order) -> void
+{
+  const char32_t *src = utf32.data();
+  size_t len = utf32.length();
+  const bool swap = order != byte_order::native;
+  utf8.reserve(len * 4);  // Reserve space for worst-case scenario
+
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8)
+  {
+    __m256i codepoints = load_utf32_avx2(src + i, swap);
+
+    // Check for invalid codepoints
+    __m256i invalid = invalid_utf32_avx2(codepoints);
+
+    if (_mm256_testz_si256(invalid, invalid) == 0)
+    {
+      throw std::runtime_error("Invalid UTF-32 codepoint detected");
+    }
+
+    // Compute the lengths of UTF-8 sequences for each codepoint
+    __m256i lengths = _mm256_set1_epi32(1);
+    lengths = _mm256_add_epi32(lengths, _mm256_and_si256(_mm256_cmpgt_epi32(codepoints, _mm256_set1_epi32(0x7F)), _mm256_set1_epi32(1)));
+    lengths = _mm256_add_epi32(lengths, _mm256_and_si256(_mm256_cmpgt_epi32(codepoints, _mm256_set1_epi32(0x7FF)), _mm256_set1_epi32(1)));
+    lengths = _mm256_add_epi32(lengths, _mm256_and_si256(_mm256_cmpgt_epi32(codepoints, _mm256_set1_epi32(0xFFFF)), _mm256_set1_epi32(1)));
+
+    // Compute the total length of the UTF-8 sequences
+    __m256i sum = _mm256_hadd_epi32(lengths, lengths);
+    sum = _mm256_hadd_epi32(sum, sum);
+    int total_length = _mm256_extract_epi32(sum, 0) + _mm256_extract_epi32(sum, 4);
+
+    // Resize the output string to accommodate the new UTF-8 sequences
+    size_t prev_size = utf8.size();
+    utf8.resize(prev_size + static_cast<size_t>(total_length));
+
+    char *dst = &utf8[prev_size];
+
+    // Process each codepoint and generate the corresponding UTF-8 sequence
+    for (std::size_t j = 0; j < 8; ++j)
+    {
+      char32_t codepoint = load_unit(src, i + j, swap);
+      if (codepoint <= 0x7F)
+      {
+        *dst++ = static_cast<char>(codepoint);
+      }
+      else if (codepoint <= 0x7FF)
+      {
+        *dst++ = static_cast<char>(0xC0U | (codepoint >> 6U));
+        *dst++ = static_cast<char>(0x80U | (codepoint & 0x3FU));
+      }
+      else if (codepoint <= 0xFFFF)
+      {
+        *dst++ = static_cast<char>(0xE0U | (codepoint >> 12U));
+        *dst++ = static_cast<char>(0x80U | ((codepoint >> 6U) & 0x3FU));
+        *dst++ = static_cast<char>(0x80U | (codepoint & 0x3FU));
+      }
+      else
+      {
+        *dst++ = static_cast<char>(0xF0U | (codepoint >> 18U));
+        *dst++ = static_cast<char>(0x80U | ((codepoint >> 12U) & 0x3FU));
+        *dst++ = static_cast<char>(0x80U | ((codepoint >> 6U) & 0x3FU));
+        *dst++ = static_cast<char>(0x80U | (codepoint & 0x3FU));
+      }
+    }
+  }
+
+  // Process the remaining codepoints (less than 8)
+  RAPIDUTF_STATS_SCALAR(utf32_to_utf8, (len - i) * sizeof(char32_t));
+  for (; i < len; ++i)
+  {
+    char32_t codepoint = load_unit(src, i, swap);
+    if (codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+    {
+      throw std::runtime_error("Invalid UTF-32 codepoint detected");
+    }
+    if (codepoint <= 0x7F)
+    {
+      utf8.push_back(static_cast<char>(codepoint));
+    }
+    else if (codepoint <= 0x7FF)
+    {
+      utf8.push_back(static_cast<char>(0xC0U | (codepoint >> 6U)));
+      utf8.push_back(static_cast<char>(0x80U | (codepoint & 0x3FU)));
+    }
+    else if (codepoint <= 0xFFFF)
+    {
+      utf8.push_back(static_cast<char>(0xE0U | (codepoint >> 12U)));
+      utf8.push_back(static_cast<char>(0x80U | ((codepoint >> 6U) & 0x3FU)));
+      utf8.push_back(static_cast<char>(0x80U | (codepoint & 0x3FU)));
+    }
+    else
+    {
+      utf8.push_back(static_cast<char>(0xF0U | (codepoint >> 18U)));
+      utf8.push_back(static_cast<char>(0x80U | ((codepoint >> 12U) & 0x3FU)));
+      utf8.push_back(static_cast<char>(0x80U | ((codepoint >> 6U) & 0x3FU)));
+      utf8.push_back(static_cast<char>(0x80U | (codepoint & 0x3FU)));
+    }
+  }
+}
+
+auto converter::count_utf8_avx2(const unsigned char *bytes, std::size_t length) -> std::size_t
+{
+  std::size_t continuation = 0;
+  std::size_t i = 0;
+
+  while (length - i >= 32)
+  {
+    // Per-byte counters saturate after 255 blocks, fold them into the total before that
+    const std::size_t blocks = std::min<std::size_t>((length - i) / 32, 255);
+    __m256i counters = _mm256_setzero_si256();
+    for (std::size_t block = 0; block < blocks; ++block, i += 32)
+    {
+      const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      // Continuation bytes 0x80-0xBF are the signed bytes below -64; the compare yields -1 for each of them
+      counters = _mm256_sub_epi8(counters, _mm256_cmpgt_epi8(_mm256_set1_epi8(-64), chunk));
+    }
+    const __m256i sums = _mm256_sad_epu8(counters, _mm256_setzero_si256());
+    continuation += static_cast<std::size_t>(_mm256_extract_epi64(sums, 0)) + static_cast<std::size_t>(_mm256_extract_epi64(sums, 1))
+      + static_cast<std::size_t>(_mm256_extract_epi64(sums, 2)) + static_cast<std::size_t>(_mm256_extract_epi64(sums, 3));
+  }
+
+  if (i != length && length >= 32)
+  {
+    // The last block overlaps bytes already counted, their lanes are masked off
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + length - 32));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto is_continuation = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_set1_epi8(-64), chunk)));
+    return length - continuation - static_cast<std::size_t>(popcount(is_continuation & tail_lanes(length - i, 32)));
+  }
+
+  return (i - continuation) + count_utf8_fallback(bytes + i, length - i);
+}
+
+auto converter::count_utf16_avx2(const char16_t *chars, std::size_t length, byte_order order) -> std::size_t
+{
+  const bool swap = order != byte_order::native;
+  std::size_t low_surrogates = 0;
+  std::size_t i = 0;
+
+  for (; i + 16 <= length; i += 16)
+  {
+    const __m256i chunk = load_utf16_avx2(chars + i, swap);
+    const __m256i is_low = _mm256_cmpeq_epi16(_mm256_and_si256(chunk, _mm256_set1_epi16(static_cast<int16_t>(0xFC00))), _mm256_set1_epi16(static_cast<int16_t>(0xDC00)));
+    // Two mask bits per code unit
+    low_surrogates += static_cast<std::size_t>(popcount(static_cast<uint32_t>(_mm256_movemask_epi8(is_low)))) / 2;
+  }
+
+  if (i != length && length >= 16)
+  {
+    // The last block overlaps units already counted, their lanes are masked off
+    const __m256i chunk = load_utf16_avx2(chars + length - 16, swap);
+    const __m256i is_low = _mm256_cmpeq_epi16(_mm256_and_si256(chunk, _mm256_set1_epi16(static_cast<int16_t>(0xFC00))), _mm256_set1_epi16(static_cast<int16_t>(0xDC00)));
+    low_surrogates += static_cast<std::size_t>(popcount(static_cast<uint32_t>(_mm256_movemask_epi8(is_low)) & tail_lanes(length - i, 16))) / 2;
+    return length - low_surrogates;
+  }
+
+  return (i - low_surrogates) + count_utf16_fallback(chars + i, length - i, order);
+}
+
+auto converter::find_first_non_ascii_avx2(const unsigned char *bytes, std::size_t length) -> std::size_t
+{
+  std::size_t i = 0;
+
+  // OR four registers together so the common all-ASCII case costs one test per 128 bytes
+  for (; i + 128 <= length; i += 128)
+  {
+    const __m256i chunk1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const __m256i chunk2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i + 32));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const __m256i chunk3 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i + 64));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const __m256i chunk4 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i + 96));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const __m256i combined = _mm256_or_si256(_mm256_or_si256(chunk1, chunk2), _mm256_or_si256(chunk3, chunk4));
+    if (_mm256_movemask_epi8(combined) != 0)
+    {
+      break;
+    }
+  }
+  for (; i + 32 <= length; i += 32)
+  {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(chunk));
+    if (mask != 0)
+    {
+      return i + static_cast<std::size_t>(ctz(mask));
+    }
+  }
+  if (i != length && length >= 32)
+  {
+    // The last block overlaps bytes already known to be ASCII
+    const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + length - 32))));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    return mask == 0 ? length : length - 32 + static_cast<std::size_t>(ctz(mask));
+  }
+
+  return i + find_first_non_ascii_fallback(bytes + i, length - i);
+}
+
+// Classifies by the largest byte: leads below C4 encode at most U+00FF, leads below F0 stay in the BMP
+auto converter::utf8_char_width_avx2(const unsigned char *bytes, std::size_t length) -> char_width
+{
+  __m256i above_latin1 = _mm256_setzero_si256();
+  std::size_t i = 0;
+
+  while (i + 32 <= length)
+  {
+    // Check for four-byte leads once per 1 KiB so UCS-4 input stops scanning early
+    __m256i above_bmp = _mm256_setzero_si256();
+    const std::size_t stop = std::min(length, i + 1024);
+    for (; i + 32 <= stop; i += 32)
+    {
+      const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      above_latin1 = _mm256_or_si256(above_latin1, _mm256_subs_epu8(chunk, _mm256_set1_epi8(static_cast<char>(0xC3))));
+      above_bmp = _mm256_or_si256(above_bmp, _mm256_subs_epu8(chunk, _mm256_set1_epi8(static_cast<char>(0xEF))));
+    }
+    if (_mm256_testz_si256(above_bmp, above_bmp) == 0)
+    {
+      return char_width::ucs4;
+    }
+  }
+
+  if (i != length && length >= 32)
+  {
+    // The last block overlaps bytes already classified, which changes nothing
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + length - 32));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const __m256i above_bmp = _mm256_subs_epu8(chunk, _mm256_set1_epi8(static_cast<char>(0xEF)));
+    if (_mm256_testz_si256(above_bmp, above_bmp) == 0)
+    {
+      return char_width::ucs4;
+    }
+    above_latin1 = _mm256_or_si256(above_latin1, _mm256_subs_epu8(chunk, _mm256_set1_epi8(static_cast<char>(0xC3))));
+    i = length;
+  }
+
+  const char_width tail = utf8_char_width_fallback(bytes + i, length - i);
+  if (tail == char_width::latin1 && _mm256_testz_si256(above_latin1, above_latin1) == 0)
+  {
+    return char_width::ucs2;
+  }
+  return tail;
+}
+
+auto converter::utf16_length_from_utf8_avx2(const unsigned char *bytes, std::size_t length) -> std::size_t
+{
+  std::size_t units = 0;
+  std::size_t i = 0;
+
+  while (length - i >= 32)
+  {
+    // Each byte adds at most 2 to its counter, fold them into the total before they saturate
+    const std::size_t blocks = std::min<std::size_t>((length - i) / 32, 127);
+    __m256i counters = _mm256_setzero_si256();
+    for (std::size_t block = 0; block < blocks; ++block, i += 32)
+    {
+      const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      // One unit per lead or ASCII byte (signed above -65), a second one per four-byte lead (0xF0 and above)
+      const __m256i is_lead = _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(-65));
+      const __m256i is_four = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, _mm256_set1_epi8(static_cast<char>(0xF0))), chunk);
+      counters = _mm256_sub_epi8(_mm256_sub_epi8(counters, is_lead), is_four);
+    }
+    const __m256i sums = _mm256_sad_epu8(counters, _mm256_setzero_si256());
+    units += static_cast<std::size_t>(_mm256_extract_epi64(sums, 0)) + static_cast<std::size_t>(_mm256_extract_epi64(sums, 1))
+      + static_cast<std::size_t>(_mm256_extract_epi64(sums, 2)) + static_cast<std::size_t>(_mm256_extract_epi64(sums, 3));
+  }
+
+  if (i != length && length >= 32)
+  {
+    // The last block overlaps bytes already counted, their lanes are masked off
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + length - 32));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const __m256i is_lead = _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(-65));
+    const __m256i is_four = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, _mm256_set1_epi8(static_cast<char>(0xF0))), chunk);
+    const uint32_t lanes = tail_lanes(length - i, 32);
+    return units + static_cast<std::size_t>(popcount(static_cast<uint32_t>(_mm256_movemask_epi8(is_lead)) & lanes) + popcount(static_cast<uint32_t>(_mm256_movemask_epi8(is_four)) & lanes));
+  }
+
+  return units + utf16_length_from_utf8_fallback(bytes + i, length - i);
+}
+
+auto converter::utf8_length_from_utf16_avx2(const char16_t *chars, std::size_t length, byte_order order) -> std::size_t
+{
+  const bool swap = order != byte_order::native;
+  std::size_t bytes = 0;
+  std::size_t i = 0;
+
+  for (; i + 16 <= length; i += 16)
+  {
+    const __m256i chunk = load_utf16_avx2(chars + i, swap);
+    // Every unit starts at 3 bytes: one less below 0x800, another below 0x80, and a surrogate half is 2 of a pair's 4
+    const __m256i high = _mm256_and_si256(chunk, _mm256_set1_epi16(static_cast<int16_t>(0xF800)));
+    const __m256i is_ascii = _mm256_cmpeq_epi16(_mm256_and_si256(chunk, _mm256_set1_epi16(static_cast<int16_t>(0xFF80))), _mm256_setzero_si256());
+    const __m256i is_two = _mm256_cmpeq_epi16(high, _mm256_setzero_si256());
+    const __m256i is_surrogate = _mm256_cmpeq_epi16(high, _mm256_set1_epi16(static_cast<int16_t>(0xD800)));
+    // Two mask bits per code unit
+    const int fewer = popcount(static_cast<uint32_t>(_mm256_movemask_epi8(is_ascii))) + popcount(static_cast<uint32_t>(_mm256_movemask_epi8(is_two)))
+      + popcount(static_cast<uint32_t>(_mm256_movemask_epi8(is_surrogate)));
+    bytes += 48 - static_cast<std::size_t>(fewer) / 2;
+  }
+
+  if (i != length && length >= 16)
+  {
+    // The last block overlaps units already counted, their lanes are masked off
+    const __m256i chunk = load_utf16_avx2(chars + length - 16, swap);
+    const __m256i high = _mm256_and_si256(chunk, _mm256_set1_epi16(static_cast<int16_t>(0xF800)));
+    const __m256i is_ascii = _mm256_cmpeq_epi16(_mm256_and_si256(chunk, _mm256_set1_epi16(static_cast<int16_t>(0xFF80))), _mm256_setzero_si256());
+    const __m256i is_two = _mm256_cmpeq_epi16(high, _mm256_setzero_si256());
+    const __m256i is_surrogate = _mm256_cmpeq_epi16(high, _mm256_set1_epi16(static_cast<int16_t>(0xD800)));
+    const uint32_t lanes = tail_lanes(length - i, 16);
+    const int fewer = popcount(static_cast<uint32_t>(_mm256_movemask_epi8(is_ascii)) & lanes) + popcount(static_cast<uint32_t>(_mm256_movemask_epi8(is_two)) & lanes)
+      + popcount(static_cast<uint32_t>(_mm256_movemask_epi8(is_surrogate)) & lanes);
+    return bytes + 3 * (length - i) - static_cast<std::size_t>(fewer) / 2;
+  }
+
+  return bytes + utf8_length_from_utf16_fallback(chars + i, length - i, order);
+}
+
+auto converter::utf8_length_from_utf32_avx2(const char32_t *chars, std::size_t length, byte_order order) -> std::size_t
+{
+  const bool swap = order != byte_order::native;
+  std::size_t bytes = 0;
+  std::size_t i = 0;
+
+  for (; i < length; i += 8)
+  {
+    // Well-formed code points are positive, so signed compares are enough. The last block is loaded with a mask, its
+    // zeroed lanes add nothing.
+    const std::size_t count = std::min<std::size_t>(length - i, 8);
+    const __m256i chunk = count == 8 ? load_utf32_avx2(chars + i, swap) : load_utf32_partial_avx2(chars + i, count, swap);
+    const int above_ascii = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(chunk, _mm256_set1_epi32(0x7F))));
+    const int above_two = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(chunk, _mm256_set1_epi32(0x7FF))));
+    const int above_bmp = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(chunk, _mm256_set1_epi32(0xFFFF))));
+    bytes += count + static_cast<std::size_t>(popcount(static_cast<uint32_t>(above_ascii)) + popcount(static_cast<uint32_t>(above_two)) + popcount(static_cast<uint32_t>(above_bmp)));
+  }
+
+  return bytes;
+}
+
+auto converter::utf16_length_from_utf32_avx2(const char32_t *chars, std::size_t length, byte_order order) -> std::size_t
+{
+  const bool swap = order != byte_order::native;
+  std::size_t units = 0;
+  std::size_t i = 0;
+
+  for (; i < length; i += 8)
+  {
+    // The last block is loaded with a mask, its zeroed lanes add nothing
+    const std::size_t count = std::min<std::size_t>(length - i, 8);
+    const __m256i chunk = count == 8 ? load_utf32_avx2(chars + i, swap) : load_utf32_partial_avx2(chars + i, count, swap);
+    const int above_bmp = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(chunk, _mm256_set1_epi32(0xFFFF))));
+    units += count + static_cast<std::size_t>(popcount(static_cast<uint32_t>(above_bmp)));
+  }
+
+  return units;
+}
+
+#elif defined(RAPIDUTF_USE_NEON)
+
+template<typename Output>
+auto converter::utf8_to_utf16_neon(std::string_view utf8, Output &utf16, byte_order order) -> void
+{
+  utf16.reserve(utf8.size());  // Reserve initial capacity
+  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  const std::size_t length = utf8.length();
+  const bool swap = order != byte_order::native;
+
+  // Widened ASCII has a zero high byte, so swapping the bytes of a unit is a shift
+  const auto widen = [swap](uint8x8_t half) { return swap ? vshlq_n_u16(vmovl_u8(half), 8) : vmovl_u8(half); };
+  for (std::size_t i = 0; i < length;)
+  {
+    if (length - i >= 16)
+    {
+      const uint8x16_t chunk = vld1q_u8(bytes + i);
+      if (vmaxvq_u8(chunk) < 0x80)
+      {
+        // All characters in the chunk are ASCII
+        const uint16x8_t chunk_lo = widen(vget_low_u8(chunk));
+        const uint16x8_t chunk_hi = widen(vget_high_u8(chunk));
+        const size_t old_size = utf16.size();
+        utf16.resize(old_size + 16);  // Resize before writing
+        vst1q_u16(reinterpret_cast<uint16_t *>(&utf16[old_size]), chunk_lo);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        vst1q_u16(reinterpret_cast<uint16_t *>(&utf16[old_size + 8]), chunk_hi);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        i += 16;
+      }
+      else
+      {
+        // Handle non-ASCII characters
+        RAPIDUTF_STATS_SCALAR(utf8_to_utf16, length - i);
+        utf8_to_utf16_scalar(bytes + i, length - i, utf16, order);
+        break;
+      }
+    }
+    else
+    {
+      // When the last 16 bytes are ASCII, the ones before the tail were already widened to the last units of the
+      // output, so the whole block is widened again over them
+      if (length >= 16 && vmaxvq_u8(vld1q_u8(bytes + length - 16)) < 0x80)
+      {
+        const uint8x16_t chunk = vld1q_u8(bytes + length - 16);
+        utf16.resize(utf16.size() + length - i);
+        vst1q_u16(reinterpret_cast<uint16_t *>(&utf16[utf16.size() - 16]), widen(vget_low_u8(chunk)));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        vst1q_u16(reinterpret_cast<uint16_t *>(&utf16[utf16.size() - 8]), widen(vget_high_u8(chunk)));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        break;
+      }
+      RAPIDUTF_STATS_SCALAR(utf8_to_utf16, length - i);
+      utf8_to_utf16_scalar(bytes + i, length - i, utf16, order);
+      break;
+    }
+  }
+}
+
+template<typename Output>
+auto converter::utf16_to_utf8_neon(std::u16string_view utf16, Output &utf8, byte_order order) -> void
+{
+  utf8.reserve(utf16.size() * 3);  // Reserve initial capacity
+  const char16_t *chars = utf16.data();
+  const std::size_t length = utf16.length();
+  const bool swap = order != byte_order::native;
+  std::size_t i = 0;
+
+  while (i + 16 <= length)
+  {
+    const uint16x8_t chunk1 = load_utf16_neon(chars + i, swap);
+    const uint16x8_t chunk2 = load_utf16_neon(chars + i + 8, swap);
+    if (vmaxvq_u16(vorrq_u16(chunk1, chunk2)) < 0x80)
+    {
+      // All characters in the chunk are ASCII
+      const size_t old_size = utf8.size();
+      utf8.resize(old_size + 16);  // Resize before writing
+      vst1q_u8(reinterpret_cast<uint8_t *>(&utf8[old_size]), vcombine_u8(vmovn_u16(chunk1), vmovn_u16(chunk2)));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      i += 16;
+      continue;
+    }
+
+    // Other blocks go through the scalar path, extended by a unit so a surrogate pair is never split
+    std::size_t end = i + 16;
+    if (end < length && (load_unit(chars, end - 1, swap) & 0xFC00U) == 0xD800U)
+    {
+      ++end;
+    }
+    RAPIDUTF_STATS_SCALAR(utf16_to_utf8, (end - i) * sizeof(char16_t));
+    utf16_to_utf8_scalar(chars + i, end - i, utf8, order);
+    i = end;
+  }
+
+  // When the last 16 units are ASCII, the ones before the tail were already narrowed to the last bytes of the output,
+  // so the whole block is narrowed again over them
+  if (i != length && length >= 16)
+  {
+    const uint16x8_t chunk1 = load_utf16_neon(chars + length - 16, swap);
+    const uint16x8_t chunk2 = load_utf16_neon(chars + length - 8, swap);
+    if (vmaxvq_u16(vorrq_u16(chunk1, chunk2)) < 0x80)
+    {
+      utf8.resize(utf8.size() + length - i);
+      vst1q_u8(reinterpret_cast<uint8_t *>(&utf8[utf8.size() - 16]), vcombine_u8(vmovn_u16(chunk1), vmovn_u16(chunk2)));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      return;
+    }
+  }
+
+  RAPIDUTF_STATS_SCALAR(utf16_to_utf8, (length - i) * sizeof(char16_t));
+  utf16_to_utf8_scalar(chars + i, length - i, utf8, order);
+}
+
+template<typename Output>
+auto converter::utf16_to_utf32_neon(std::u16string_view utf16, Output &utf32, byte_order from, byte_order to) -> void
+{
+  utf32.reserve(utf16.size());  // Reserve enough space initially
+
+  const char16_t *chars = utf16.data();
+  const std::size_t length = utf16.length();
+  const bool swap = from != byte_order::native;
+  const bool swap_out = to != byte_order::native;
+  const auto widen = [swap_out](uint16x4_t half) { return swap_out ? swap_utf32_neon(vmovl_u16(half)) : vmovl_u16(half); };
+
+  std::size_t i = 0;
+  while (i < length)
+  {
+    if (length - i >= 8)
+    {
+      const uint16x8_t chunk = load_utf16_neon(chars + i, swap);
+      if (vmaxvq_u16(vceqq_u16(vandq_u16(chunk, vdupq_n_u16(0xF800)), vdupq_n_u16(0xD800))) == 0)
+      {
+        // No surrogates in the chunk, so we can directly convert the UTF-16 characters to UTF-32
+        utf32.resize(utf32.size() + 8);  // Resize once
+        vst1q_u32(reinterpret_cast<uint32_t *>(&utf32[utf32.size() - 8]), widen(vget_low_u16(chunk)));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        vst1q_u32(reinterpret_cast<uint32_t *>(&utf32[utf32.size() - 4]), widen(vget_high_u16(chunk)));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        i += 8;
+      }
+      else
+      {
+        // Surrogates present in the chunk, so we need to handle them separately
+        RAPIDUTF_STATS_SCALAR(utf16_to_utf32, (length - i) * sizeof(char16_t));
+        utf16_to_utf32_scalar(chars + i, length - i, utf32, from, to);
+        break;
+      }
+    }
+    else
+    {
+      // When the last 8 units have no surrogates, each one before the tail was already widened to one of the last
+      // units of the output, so the whole block is widened again over them
+      if (length >= 8)
+      {
+        const uint16x8_t chunk = load_utf16_neon(chars + length - 8, swap);
+        if (vmaxvq_u16(vceqq_u16(vandq_u16(chunk, vdupq_n_u16(0xF800)), vdupq_n_u16(0xD800))) == 0)
+        {
+          utf32.resize(utf32.size() + length - i);
+          vst1q_u32(reinterpret_cast<uint32_t *>(&utf32[utf32.size() - 8]), widen(vget_low_u16(chunk)));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+          vst1q_u32(reinterpret_cast<uint32_t *>(&utf32[utf32.size() - 4]), widen(vget_high_u16(chunk)));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+          break;
+        }
+      }
+      RAPIDUTF_STATS_SCALAR(utf16_to_utf32, (length - i) * sizeof(char16_t));
+      utf16_to_utf32_scalar(chars + i, length - i, utf32, from, to);
+      break;
+    }
+  }
+}
+
+template<typename Output>
+auto converter::utf32_to_utf16_neon(std::u32string_view utf32, Output &utf16, byte_order from, byte_order to) -> void  // NOLINT(readability-function-cognitive-complexity)
+{
+  if (!is_valid_utf32(utf32, from))
+  {
+    throw std::runtime_error("Invalid UTF-32 string");
+  }
+
+  utf16.reserve(utf32.size() * 2);
+
+  const char32_t *chars = utf32.data();
+  const std::size_t length = utf32.length();
+  const bool swap = from != byte_order::native;
+  const bool swap_out = to != byte_order::native;
+
+  if (length >= 16)
+  {
+    // Process blocks of 16 characters
+    std::size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+      const uint32x4_t chunk1 = load_utf32_neon(chars + i, swap);
+      const uint32x4_t chunk2 = load_utf32_neon(chars + i + 4, swap);
+      const uint32x4_t chunk3 = load_utf32_neon(chars + i + 8, swap);
+      const uint32x4_t chunk4 = load_utf32_neon(chars + i + 12, swap);
+
+      const uint32x4_t mask1 = vcgtq_u32(chunk1, vdupq_n_u32(0xFFFF));
+      const uint32x4_t mask2 = vcgtq_u32(chunk2, vdupq_n_u32(0xFFFF));
+      const uint32x4_t mask3 = vcgtq_u32(chunk3, vdupq_n_u32(0xFFFF));
+      const uint32x4_t mask4 = vcgtq_u32(chunk4, vdupq_n_u32(0xFFFF));
+
+      const uint64x2_t result1 = vreinterpretq_u64_u32(mask1);
+      const uint64x2_t result2 = vreinterpretq_u64_u32(mask2);
+      const uint64x2_t result3 = vreinterpretq_u64_u32(mask3);
+      const uint64x2_t result4 = vreinterpretq_u64_u32(mask4);
+
+      const uint64_t combined = vgetq_lane_u64(result1, 0) | vgetq_lane_u64(result1, 1) | vgetq_lane_u64(result2, 0) | vgetq_lane_u64(result2, 1) | vgetq_lane_u64(result3, 0)
+        | vgetq_lane_u64(result3, 1) | vgetq_lane_u64(result4, 0) | vgetq_lane_u64(result4, 1);
+
+      if (combined == 0)
+      {
+        // All characters are <= 0xFFFF
+        const uint16x8_t utf16_chunk1 = vcombine_u16(vmovn_u32(chunk1), vmovn_u32(chunk2));
+        const uint16x8_t utf16_chunk2 = vcombine_u16(vmovn_u32(chunk3), vmovn_u32(chunk4));
+
+        std::array<char16_t, 16> temp {0};
+        vst1q_u16(reinterpret_cast<uint16_t *>(temp.data()), swap_out ? swap_utf16_neon(utf16_chunk1) : utf16_chunk1);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        vst1q_u16(reinterpret_cast<uint16_t *>(temp.data() + 8), swap_out ? swap_utf16_neon(utf16_chunk2) : utf16_chunk2);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        utf16.append(temp.data(), 16);
+      }
+      else
+      {
+        // Handle characters > 0xFFFF
+        auto process_chunk = [&utf16, swap_out](uint32x4_t chunk)
+        {
+          const char32_t ch0 = vgetq_lane_u32(chunk, 0);
+          const char32_t ch1 = vgetq_lane_u32(chunk, 1);
+          const char32_t ch2 = vgetq_lane_u32(chunk, 2);
+          const char32_t ch3 = vgetq_lane_u32(chunk, 3);
+
+          for (char32_t ch : {ch0, ch1, ch2, ch3})
+          {
+            if (ch <= 0xFFFF)
+            {
+              utf16.push_back(order_unit(static_cast<char16_t>(ch), swap_out));
+            }
+            else
+            {
+              ch -= 0x10000;
+              utf16.push_back(order_unit(static_cast<char16_t>((ch >> 10U) + 0xD800U), swap_out));
+              utf16.push_back(order_unit(static_cast<char16_t>((ch & 0x3FFU) + 0xDC00U), swap_out));
+            }
+          }
+        };
+
+        RAPIDUTF_STATS_SCALAR(utf32_to_utf16, 16 * sizeof(char32_t));
+        process_chunk(chunk1);
+        process_chunk(chunk2);
+        process_chunk(chunk3);
+        process_chunk(chunk4);
+      }
+    }
+
+    // Process remaining characters
+    RAPIDUTF_STATS_SCALAR(utf32_to_utf16, (length - i) * sizeof(char32_t));
+    for (; i < length; ++i)
+    {
+      char32_t ch = load_unit(chars, i, swap);
+      if (ch <= 0xFFFF)
+      {
+        utf16.push_back(order_unit(static_cast<char16_t>(ch), swap_out));
+      }
+      else
+      {
+        ch -= 0x10000;
+        utf16.push_back(order_unit(static_cast<char16_t>((ch >> 10U) + 0xD800U), swap_out));
+        utf16.push_back(order_unit(static_cast<char16_t>((ch & 0x3FFU) + 0xDC00U), swap_out));
+      }
+    }
+  }
+  else if (length >= 8)
+  {
+    // Process 8 characters using NEON
+    const uint32x4_t chunk1 = load_utf32_neon(chars, swap);
+    const uint32x4_t chunk2 = load_utf32_neon(chars + 4, swap);
+
+    const uint32x4_t mask1 = vcgtq_u32(chunk1, vdupq_n_u32(0xFFFF));
+    const uint32x4_t mask2 = vcgtq_u32(chunk2, vdupq_n_u32(0xFFFF));
+
+    const uint64x2_t result1 = vreinterpretq_u64_u32(mask1);
+    const uint64x2_t result2 = vreinterpretq_u64_u32(mask2);
+
+    const uint64_t combined = vgetq_lane_u64(result1, 0) | vgetq_lane_u64(result1, 1) | vgetq_lane_u64(result2, 0) | vgetq_lane_u64(result2, 1);
+
+    if (combined == 0)
+    {
+      const uint16x8_t utf16_chunk = vcombine_u16(vmovn_u32(chunk1), vmovn_u32(chunk2));
+      std::array<char16_t, 8> temp {0};
+      vst1q_u16(reinterpret_cast<uint16_t *>(temp.data()), swap_out ? swap_utf16_neon(utf16_chunk) : utf16_chunk);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      utf16.append(temp.data(), 8);
+    }
+    else
+    {
+      // Process each character individually
+      auto process_chunk = [&utf16, swap_out](uint32x4_t chunk)
+      {
+        const char32_t ch0 = vgetq_lane_u32(chunk, 0);
+        const char32_t ch1 = vgetq_lane_u32(chunk, 1);
+        const char32_t ch2 = vgetq_lane_u32(chunk, 2);
+        const char32_t ch3 = vgetq_lane_u32(chunk, 3);
+
+        for (char32_t ch : {ch0, ch1, ch2, ch3})
+        {
+          if (ch <= 0xFFFF)
+          {
+            utf16.push_back(order_unit(static_cast<char16_t>(ch), swap_out));
+          }
+          else
+          {
+            ch -= 0x10000;
+            utf16.push_back(order_unit(static_cast<char16_t>((ch >> 10U) + 0xD800U), swap_out));
+            utf16.push_back(order_unit(static_cast<char16_t>((ch & 0x3FFU) + 0xDC00U), swap_out));
+          }
+        }
+      };
+
+      process_chunk(chunk1);
       process_chunk(chunk2);
     }
 
-    // Process remaining characters
-    for (std::size_t i = 8; i < length; ++i)
+    // Process remaining characters
+    for (std::size_t i = 8; i < length; ++i)
+    {
+      char32_t ch = load_unit(chars, i, swap);
+      if (ch <= 0xFFFF)
+      {
+        utf16.push_back(order_unit(static_cast<char16_t>(ch), swap_out));
+      }
+      else
+      {
+        ch -= 0x10000;
+        utf16.push_back(order_unit(static_cast<char16_t>((ch >> 10U) + 0xD800U), swap_out));
+        utf16.push_back(order_unit(static_cast<char16_t>((ch & 0x3FFU) + 0xDC00U), swap_out));
+      }
+    }
+  }
+  else if (length >= 4)
+  {
+    // Process 4 characters using NEON
+    const uint32x4_t chunk = load_utf32_neon(chars, swap);
+    const uint32x4_t mask = vcgtq_u32(chunk, vdupq_n_u32(0xFFFF));
+    const uint64x2_t result = vreinterpretq_u64_u32(mask);
+    const uint64_t combined = vgetq_lane_u64(result, 0) | vgetq_lane_u64(result, 1);
+
+    if (combined == 0)
+    {
+      const uint16x4_t utf16_chunk = vmovn_u32(chunk);
+      std::array<char16_t, 4> temp {0};
+      vst1_u16(reinterpret_cast<uint16_t *>(temp.data()), swap_out ? vreinterpret_u16_u8(vrev16_u8(vreinterpret_u8_u16(utf16_chunk))) : utf16_chunk);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      utf16.append(temp.data(), 4);
+    }
+    else
+    {
+      // Process each character individually
+      const char32_t ch0 = vgetq_lane_u32(chunk, 0);
+      const char32_t ch1 = vgetq_lane_u32(chunk, 1);
+      const char32_t ch2 = vgetq_lane_u32(chunk, 2);
+      const char32_t ch3 = vgetq_lane_u32(chunk, 3);
+
+      for (char32_t ch : {ch0, ch1, ch2, ch3})
+      {
+        if (ch <= 0xFFFF)
+        {
+          utf16.push_back(order_unit(static_cast<char16_t>(ch), swap_out));
+        }
+        else
+        {
+          ch -= 0x10000;
+          utf16.push_back(order_unit(static_cast<char16_t>((ch >> 10U) + 0xD800U), swap_out));
+          utf16.push_back(order_unit(static_cast<char16_t>((ch & 0x3FFU) + 0xDC00U), swap_out));
+        }
+      }
+    }
+
+    // Process remaining characters
+    for (std::size_t i = 4; i < length; ++i)
+    {
+      char32_t ch = load_unit(chars, i, swap);
+      if (ch <= 0xFFFF)
+      {
+        utf16.push_back(order_unit(static_cast<char16_t>(ch), swap_out));
+      }
+      else
+      {
+        ch -= 0x10000;
+        utf16.push_back(order_unit(static_cast<char16_t>((ch >> 10U) + 0xD800U), swap_out));
+        utf16.push_back(order_unit(static_cast<char16_t>((ch & 0x3FFU) + 0xDC00U), swap_out));
+      }
+    }
+  }
+  else
+  {
+    // Process all characters individually without NEON
+    for (std::size_t i = 0; i < length; ++i)
+    {
+      char32_t ch = load_unit(chars, i, swap);
+      if (ch <= 0xFFFF)
+      {
+        utf16.push_back(order_unit(static_cast<char16_t>(ch), swap_out));
+      }
+      else
+      {
+        ch -= 0x10000;
+        utf16.push_back(order_unit(static_cast<char16_t>((ch >> 10U) + 0xD800U), swap_out));
+        utf16.push_back(order_unit(static_cast<char16_t>((ch & 0x3FFU) + 0xDC00U), swap_out));
+      }
+    }
+  }
+}
+
+template<typename Output>
+auto converter::utf8_to_utf32_neon(std::string_view utf8, Output &utf32, byte_order order) -> void
+{
+  utf32.reserve(utf8.size());
+
+  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  const std::size_t length = utf8.length();
+  const bool swap = order != byte_order::native;
+
+  // Widened ASCII has a zero high byte, so swapping the bytes of a unit is a shift
+  const auto widen = [swap](uint16x4_t quarter) { return swap ? vshlq_n_u32(vmovl_u16(quarter), 24) : vmovl_u16(quarter); };
+
+  std::array<char32_t, 16> buffer {0};  // Temporary buffer to hold 16 char32_t values
+
+  for (std::size_t i = 0; i < length;)
+  {
+    if (length - i >= 16)
+    {
+      const uint8x16_t chunk = vld1q_u8(bytes + i);
+      if (vmaxvq_u8(chunk) < 0x80)
+      {
+        // All characters in the chunk are ASCII
+        const uint16x8_t lo_chars = vmovl_u8(vget_low_u8(chunk));
+        const uint16x8_t hi_chars = vmovl_u8(vget_high_u8(chunk));
+        const uint32x4_t lo_lo_chars = widen(vget_low_u16(lo_chars));
+        const uint32x4_t lo_hi_chars = widen(vget_high_u16(lo_chars));
+        const uint32x4_t hi_lo_chars = widen(vget_low_u16(hi_chars));
+        const uint32x4_t hi_hi_chars = widen(vget_high_u16(hi_chars));
+
+        vst1q_u32(reinterpret_cast<uint32_t *>(buffer.data()), lo_lo_chars);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        vst1q_u32(reinterpret_cast<uint32_t *>(buffer.data()) + 4, lo_hi_chars);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        vst1q_u32(reinterpret_cast<uint32_t *>(buffer.data()) + 8, hi_lo_chars);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        vst1q_u32(reinterpret_cast<uint32_t *>(buffer.data()) + 12, hi_hi_chars);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+        utf32.append(buffer.data(), buffer.size());
+
+        i += 16;
+      }
+      else
+      {
+        // Handle non-ASCII characters with NEON
+        RAPIDUTF_STATS_SCALAR(utf8_to_utf32, length - i);
+        utf8_to_utf32_scalar(bytes + i, length - i, utf32, order);
+        break;
+      }
+    }
+    else
+    {
+      // When the last 16 bytes are ASCII, the ones before the tail were already widened to the last units of the
+      // output, so the whole block is widened again over them
+      if (length >= 16 && vmaxvq_u8(vld1q_u8(bytes + length - 16)) < 0x80)
+      {
+        const uint8x16_t chunk = vld1q_u8(bytes + length - 16);
+        const uint16x8_t lo_chars = vmovl_u8(vget_low_u8(chunk));
+        const uint16x8_t hi_chars = vmovl_u8(vget_high_u8(chunk));
+        utf32.resize(utf32.size() + length - i);
+        auto *out = reinterpret_cast<uint32_t *>(&utf32[utf32.size() - 16]);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        vst1q_u32(out, widen(vget_low_u16(lo_chars)));
+        vst1q_u32(out + 4, widen(vget_high_u16(lo_chars)));
+        vst1q_u32(out + 8, widen(vget_low_u16(hi_chars)));
+        vst1q_u32(out + 12, widen(vget_high_u16(hi_chars)));
+        break;
+      }
+      RAPIDUTF_STATS_SCALAR(utf8_to_utf32, length - i);
+      utf8_to_utf32_scalar(bytes + i, length - i, utf32, order);
+      break;
+    }
+  }
+}
+
+template<typename Output>
+auto converter::utf32_to_utf8_neon(std::u32string_view utf32, Output &utf8, byte_order order) -> void
+{
+  if (!is_valid_utf32(utf32, order))
+  {
+    throw std::runtime_error("Invalid UTF-32 string");
+  }
+
+  utf8.reserve(utf32.size() * 4);
+
+  const char32_t *chars = utf32.data();
+  const std::size_t length = utf32.length();
+  const bool swap = order != byte_order::native;
+
+  for (std::size_t i = 0; i < length;)
+  {
+    if (length - i >= 4)
+    {
+      const uint32x4_t chunk = load_utf32_neon(chars + i, swap);
+      if (vmaxvq_u32(chunk) < 0x80)
+      {
+        std::array<char, 4> temp {0};
+        temp[0] = static_cast<char>(vgetq_lane_u32(chunk, 0));
+        temp[1] = static_cast<char>(vgetq_lane_u32(chunk, 1));
+        temp[2] = static_cast<char>(vgetq_lane_u32(chunk, 2));
+        temp[3] = static_cast<char>(vgetq_lane_u32(chunk, 3));
+        utf8.append(temp.data(), 4);
+
+        i += 4;
+      }
+      else
+      {
+        // Handle non-ASCII characters with NEON
+        RAPIDUTF_STATS_SCALAR(utf32_to_utf8, (length - i) * sizeof(char32_t));
+        utf32_to_utf8_scalar(chars + i, length - i, utf8, order);
+        break;
+      }
+    }
+    else
+    {
+      // When the last 4 units are ASCII, the ones before the tail were already narrowed to the last bytes of the
+      // output, so the whole block is narrowed again over them
+      if (length >= 4)
+      {
+        const uint32x4_t chunk = load_utf32_neon(chars + length - 4, swap);
+        if (vmaxvq_u32(chunk) < 0x80)
+        {
+          utf8.resize(utf8.size() + length - i);
+          char *out = &utf8[utf8.size() - 4];
+          out[0] = static_cast<char>(vgetq_lane_u32(chunk, 0));
+          out[1] = static_cast<char>(vgetq_lane_u32(chunk, 1));
+          out[2] = static_cast<char>(vgetq_lane_u32(chunk, 2));
+          out[3] = static_cast<char>(vgetq_lane_u32(chunk, 3));
+          break;
+        }
+      }
+      RAPIDUTF_STATS_SCALAR(utf32_to_utf8, (length - i) * sizeof(char32_t));
+      utf32_to_utf8_scalar(chars + i, length - i, utf8, order);
+      break;
+    }
+  }
+}
+
+auto converter::count_utf8_neon(const unsigned char *bytes, std::size_t length) -> std::size_t
+{
+  std::size_t continuation = 0;
+  std::size_t i = 0;
+
+  while (length - i >= 16)
+  {
+    // Per-byte counters saturate after 255 blocks, fold them into the total before that
+    const std::size_t blocks = std::min<std::size_t>((length - i) / 16, 255);
+    uint8x16_t counters = vdupq_n_u8(0);
+    for (std::size_t block = 0; block < blocks; ++block, i += 16)
+    {
+      const int8x16_t chunk = vreinterpretq_s8_u8(vld1q_u8(bytes + i));
+      counters = vsubq_u8(counters, vcltq_s8(chunk, vdupq_n_s8(-64)));
+    }
+    continuation += vaddlvq_u8(counters);
+  }
+
+  if (i != length && length >= 16)
+  {
+    // The last block overlaps bytes already counted, their lanes are masked off
+    const int8x16_t chunk = vreinterpretq_s8_u8(vld1q_u8(bytes + length - 16));
+    const uint8x16_t is_continuation = vandq_u8(vcltq_s8(chunk, vdupq_n_s8(-64)), tail_lanes_neon(length - i));
+    return length - continuation - vaddvq_u8(vshrq_n_u8(is_continuation, 7));
+  }
+
+  return (i - continuation) + count_utf8_fallback(bytes + i, length - i);
+}
+
+auto converter::count_utf16_neon(const char16_t *chars, std::size_t length, byte_order order) -> std::size_t
+{
+  const bool swap = order != byte_order::native;
+  std::size_t low_surrogates = 0;
+  std::size_t i = 0;
+
+  for (; i + 8 <= length; i += 8)
+  {
+    const uint16x8_t chunk = load_utf16_neon(chars + i, swap);
+    const uint16x8_t is_low = vceqq_u16(vandq_u16(chunk, vdupq_n_u16(0xFC00)), vdupq_n_u16(0xDC00));
+    low_surrogates += vaddvq_u16(vshrq_n_u16(is_low, 15));
+  }
+
+  if (i != length && length >= 8)
+  {
+    // The last block overlaps units already counted, their lanes are masked off
+    const uint16x8_t chunk = load_utf16_neon(chars + length - 8, swap);
+    const uint16x8_t is_low = vceqq_u16(vandq_u16(chunk, vdupq_n_u16(0xFC00)), vdupq_n_u16(0xDC00));
+    low_surrogates += vaddvq_u16(vshrq_n_u16(vandq_u16(is_low, vreinterpretq_u16_u8(tail_lanes_neon(2 * (length - i)))), 15));
+    return length - low_surrogates;
+  }
+
+  return (i - low_surrogates) + count_utf16_fallback(chars + i, length - i, order);
+}
+
+auto converter::find_first_non_ascii_neon(const unsigned char *bytes, std::size_t length) -> std::size_t
+{
+  std::size_t i = 0;
+
+  // OR four registers together so the common all-ASCII case costs one test per 64 bytes
+  for (; i + 64 <= length; i += 64)
+  {
+    const uint8x16_t combined = vorrq_u8(vorrq_u8(vld1q_u8(bytes + i), vld1q_u8(bytes + i + 16)), vorrq_u8(vld1q_u8(bytes + i + 32), vld1q_u8(bytes + i + 48)));
+    if (vmaxvq_u8(combined) >= 0x80)
+    {
+      break;
+    }
+  }
+  for (; i + 16 <= length; i += 16)
+  {
+    if (vmaxvq_u8(vld1q_u8(bytes + i)) >= 0x80)
+    {
+      break;
+    }
+  }
+  if (i != length && length - i < 16 && length >= 16 && vmaxvq_u8(vld1q_u8(bytes + length - 16)) < 0x80)
+  {
+    // The last block overlaps bytes already known to be ASCII
+    return length;
+  }
+
+  return i + find_first_non_ascii_fallback(bytes + i, length - i);
+}
+
+// Classifies by the largest byte: leads below C4 encode at most U+00FF, leads below F0 stay in the BMP
+auto converter::utf8_char_width_neon(const unsigned char *bytes, std::size_t length) -> char_width
+{
+  uint8_t max_byte = 0;
+  std::size_t i = 0;
+
+  while (i + 16 <= length)
+  {
+    // Check for four-byte leads once per 1 KiB so UCS-4 input stops scanning early
+    uint8x16_t block_max = vdupq_n_u8(0);
+    const std::size_t stop = std::min(length, i + 1024);
+    for (; i + 16 <= stop; i += 16)
+    {
+      block_max = vmaxq_u8(block_max, vld1q_u8(bytes + i));
+    }
+    max_byte = std::max(max_byte, vmaxvq_u8(block_max));
+    if (max_byte >= 0xF0)
+    {
+      return char_width::ucs4;
+    }
+  }
+
+  if (i != length && length >= 16)
+  {
+    // The last block overlaps bytes already classified, which changes nothing
+    max_byte = std::max(max_byte, vmaxvq_u8(vld1q_u8(bytes + length - 16)));
+    if (max_byte >= 0xF0)
+    {
+      return char_width::ucs4;
+    }
+    i = length;
+  }
+
+  const char_width tail = utf8_char_width_fallback(bytes + i, length - i);
+  if (tail == char_width::latin1 && max_byte >= 0xC4)
+  {
+    return char_width::ucs2;
+  }
+  return tail;
+}
+
+auto converter::utf16_length_from_utf8_neon(const unsigned char *bytes, std::size_t length) -> std::size_t
+{
+  std::size_t units = 0;
+  std::size_t i = 0;
+
+  while (length - i >= 16)
+  {
+    // Each byte adds at most 2 to its counter, fold them into the total before they saturate
+    const std::size_t blocks = std::min<std::size_t>((length - i) / 16, 127);
+    uint8x16_t counters = vdupq_n_u8(0);
+    for (std::size_t block = 0; block < blocks; ++block, i += 16)
+    {
+      const uint8x16_t chunk = vld1q_u8(bytes + i);
+      counters = vsubq_u8(counters, vcgeq_s8(vreinterpretq_s8_u8(chunk), vdupq_n_s8(-64)));
+      counters = vsubq_u8(counters, vcgeq_u8(chunk, vdupq_n_u8(0xF0)));
+    }
+    units += vaddlvq_u8(counters);
+  }
+
+  if (i != length && length >= 16)
+  {
+    // The last block overlaps bytes already counted, their lanes are masked off
+    const uint8x16_t chunk = vld1q_u8(bytes + length - 16);
+    uint8x16_t counts = vshrq_n_u8(vcgeq_s8(vreinterpretq_s8_u8(chunk), vdupq_n_s8(-64)), 7);
+    counts = vaddq_u8(counts, vshrq_n_u8(vcgeq_u8(chunk, vdupq_n_u8(0xF0)), 7));
+    return units + vaddvq_u8(vandq_u8(counts, tail_lanes_neon(length - i)));
+  }
+
+  return units + utf16_length_from_utf8_fallback(bytes + i, length - i);
+}
+
+auto converter::utf8_length_from_utf16_neon(const char16_t *chars, std::size_t length, byte_order order) -> std::size_t
+{
+  const bool swap = order != byte_order::native;
+  std::size_t bytes = 0;
+  std::size_t i = 0;
+
+  for (; i + 8 <= length; i += 8)
+  {
+    const uint16x8_t chunk = load_utf16_neon(chars + i, swap);
+    const uint16x8_t high = vandq_u16(chunk, vdupq_n_u16(0xF800));
+    uint16x8_t widths = vdupq_n_u16(3);
+    widths = vaddq_u16(widths, vceqq_u16(vandq_u16(chunk, vdupq_n_u16(0xFF80)), vdupq_n_u16(0)));
+    widths = vaddq_u16(widths, vceqq_u16(high, vdupq_n_u16(0)));
+    widths = vaddq_u16(widths, vceqq_u16(high, vdupq_n_u16(0xD800)));
+    bytes += vaddvq_u16(widths);
+  }
+
+  if (i != length && length >= 8)
+  {
+    // The last block overlaps units already counted, their lanes are masked off
+    const uint16x8_t chunk = load_utf16_neon(chars + length - 8, swap);
+    const uint16x8_t high = vandq_u16(chunk, vdupq_n_u16(0xF800));
+    uint16x8_t widths = vdupq_n_u16(3);
+    widths = vaddq_u16(widths, vceqq_u16(vandq_u16(chunk, vdupq_n_u16(0xFF80)), vdupq_n_u16(0)));
+    widths = vaddq_u16(widths, vceqq_u16(high, vdupq_n_u16(0)));
+    widths = vaddq_u16(widths, vceqq_u16(high, vdupq_n_u16(0xD800)));
+    return bytes + vaddvq_u16(vandq_u16(widths, vreinterpretq_u16_u8(tail_lanes_neon(2 * (length - i)))));
+  }
+
+  return bytes + utf8_length_from_utf16_fallback(chars + i, length - i, order);
+}
+
+auto converter::utf8_length_from_utf32_neon(const char32_t *chars, std::size_t length, byte_order order) -> std::size_t
+{
+  const bool swap = order != byte_order::native;
+  std::size_t bytes = 0;
+  std::size_t i = 0;
+
+  for (; i + 4 <= length; i += 4)
+  {
+    const uint32x4_t chunk = load_utf32_neon(chars + i, swap);
+    uint32x4_t widths = vdupq_n_u32(1);
+    widths = vsubq_u32(widths, vcgtq_u32(chunk, vdupq_n_u32(0x7F)));
+    widths = vsubq_u32(widths, vcgtq_u32(chunk, vdupq_n_u32(0x7FF)));
+    widths = vsubq_u32(widths, vcgtq_u32(chunk, vdupq_n_u32(0xFFFF)));
+    bytes += vaddvq_u32(widths);
+  }
+
+  if (i != length && length >= 4)
+  {
+    // The last block overlaps units already counted, their lanes are masked off
+    const uint32x4_t chunk = load_utf32_neon(chars + length - 4, swap);
+    uint32x4_t widths = vdupq_n_u32(1);
+    widths = vsubq_u32(widths, vcgtq_u32(chunk, vdupq_n_u32(0x7F)));
+    widths = vsubq_u32(widths, vcgtq_u32(chunk, vdupq_n_u32(0x7FF)));
+    widths = vsubq_u32(widths, vcgtq_u32(chunk, vdupq_n_u32(0xFFFF)));
+    return bytes + vaddvq_u32(vandq_u32(widths, vreinterpretq_u32_u8(tail_lanes_neon(4 * (length - i)))));
+  }
+
+  return bytes + utf8_length_from_utf32_fallback(chars + i, length - i, order);
+}
+
+auto converter::utf16_length_from_utf32_neon(const char32_t *chars, std::size_t length, byte_order order) -> std::size_t
+{
+  const bool swap = order != byte_order::native;
+  std::size_t units = 0;
+  std::size_t i = 0;
+
+  for (; i + 4 <= length; i += 4)
+  {
+    const uint32x4_t chunk = load_utf32_neon(chars + i, swap);
+    units += 4 + vaddvq_u32(vshrq_n_u32(vcgtq_u32(chunk, vdupq_n_u32(0xFFFF)), 31));
+  }
+
+  if (i != length && length >= 4)
+  {
+    // The last block overlaps units already counted, their lanes are masked off
+    const uint32x4_t chunk = load_utf32_neon(chars + length - 4, swap);
+    const uint32x4_t above_bmp = vandq_u32(vcgtq_u32(chunk, vdupq_n_u32(0xFFFF)), vreinterpretq_u32_u8(tail_lanes_neon(4 * (length - i))));
+    return units + (length - i) + vaddvq_u32(vshrq_n_u32(above_bmp, 31));
+  }
+
+  return units + utf16_length_from_utf32_fallback(chars + i, length - i, order);
+}
+
+// #else
+#endif
+
+template<typename Output>
+auto converter::utf8_to_utf16_fallback(std::string_view utf8, Output &utf16, byte_order order) -> void
+{
+  utf16.reserve(utf8.size());
+
+  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  const std::size_t length = utf8.length();
+
+  utf8_to_utf16_scalar(bytes, length, utf16, order);
+}
+
+template<typename Output>
+auto converter::utf16_to_utf8_fallback(std::u16string_view utf16, Output &utf8, byte_order order) -> void
+{
+  utf8.reserve(utf16.size() * 3);
+
+  const char16_t *chars = utf16.data();
+  const std::size_t length = utf16.length();
+
+  utf16_to_utf8_scalar(chars, length, utf8, order);
+}
+
+template<typename Output>
+auto converter::utf16_to_utf32_fallback(std::u16string_view utf16, Output &utf32, byte_order from, byte_order to) -> void
+{
+  utf32.reserve(utf16.size());
+
+  const char16_t *chars = utf16.data();
+  const std::size_t length = utf16.length();
+
+  utf16_to_utf32_scalar(chars, length, utf32, from, to);
+}
+
+template<typename Output>
+auto converter::utf32_to_utf16_fallback(std::u32string_view utf32, Output &utf16, byte_order from, byte_order to) -> void
+{
+  utf16.reserve(utf32.size() * 2);
+
+  const char32_t *chars = utf32.data();
+  const std::size_t length = utf32.length();
+
+  utf32_to_utf16_scalar(chars, length, utf16, from, to);
+}
+
+template<typename Output>
+auto converter::utf8_to_utf32_fallback(std::string_view utf8, Output &utf32, byte_order order) -> void
+{
+  utf32.reserve(utf8.size());
+
+  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  const std::size_t length = utf8.length();
+
+  utf8_to_utf32_scalar(bytes, length, utf32, order);
+}
+
+template<typename Output>
+auto converter::utf32_to_utf8_fallback(std::u32string_view utf32, Output &utf8, byte_order order) -> void
+{
+  if (!is_valid_utf32(utf32, order))
+  {
+    throw std::runtime_error("Invalid UTF-32 string");
+  }
+
+  utf8.reserve(utf32.size() * 4);
+
+  const char32_t *chars = utf32.data();
+  const std::size_t length = utf32.length();
+
+  utf32_to_utf8_scalar(chars, length, utf8, order);
+}
+
+auto converter::count_utf8_fallback(const unsigned char *bytes, std::size_t length) -> std::size_t
+{
+  std::size_t count = 0;
+  std::size_t i = 0;
+  for (; i + 8 <= length; i += 8)
+  {
+    count += 8 - flagged_bytes(continuation_bytes(load_word(bytes + i)));
+  }
+  for (; i < length; ++i)
+  {
+    count += static_cast<std::size_t>((bytes[i] & 0xC0U) != 0x80U);
+  }
+  return count;
+}
+
+auto converter::count_utf16_fallback(const char16_t *chars, std::size_t length, byte_order order) -> std::size_t
+{
+  const bool swap = order != byte_order::native;
+  std::size_t count = 0;
+  std::size_t i = 0;
+  for (; i + 4 <= length; i += 4)
+  {
+    uint64_t word = load_word(chars + i);
+    if (swap)
+    {
+      word = ((word >> 8U) & 0x00FF00FF00FF00FFULL) | ((word & 0x00FF00FF00FF00FFULL) << 8U);
+    }
+    // A unit is a low surrogate when its top six bits match DC00, i.e. when this difference is zero in its lane
+    const uint64_t difference = (word & 0xFC00FC00FC00FC00ULL) ^ 0xDC00DC00DC00DC00ULL;
+    const uint64_t nonzero = (((difference & 0x7FFF7FFF7FFF7FFFULL) + 0x7FFF7FFF7FFF7FFFULL) | difference) & 0x8000800080008000ULL;
+    count += static_cast<std::size_t>(((nonzero >> 15U) * 0x0001000100010001ULL) >> 48U);
+  }
+  for (; i < length; ++i)
+  {
+    count += static_cast<std::size_t>((load_unit(chars, i, swap) & 0xFC00U) != 0xDC00U);
+  }
+  return count;
+}
+
+auto converter::find_first_non_ascii_fallback(const unsigned char *bytes, std::size_t length) -> std::size_t
+{
+  std::size_t i = 0;
+  while (length - i >= 8 && ascii_word(bytes + i))
+  {
+    i += 8;
+  }
+  while (i < length && (bytes[i] & 0x80U) == 0)
+  {
+    ++i;
+  }
+  return i;
+}
+
+auto converter::utf8_char_width_fallback(const unsigned char *bytes, std::size_t length) -> char_width
+{
+  // Lead bytes from C4 up start code points above U+00FF, from F0 up code points above U+FFFF
+  bool wide = false;
+  std::size_t i = 0;
+  for (; i + 8 <= length; i += 8)
+  {
+    const uint64_t word = load_word(bytes + i);
+    if (four_byte_leads(word) != 0)
+    {
+      return char_width::ucs4;
+    }
+    wide = wide || (word & (word << 1U) & ((word << 2U) | (word << 3U) | (word << 4U) | (word << 5U)) & swar_high_bits) != 0;
+  }
+  auto max_byte = static_cast<unsigned char>(wide ? 0xC4U : 0U);
+  for (; i < length; ++i)
+  {
+    max_byte = std::max(max_byte, bytes[i]);
+  }
+  if (max_byte >= 0xF0)
+  {
+    return char_width::ucs4;
+  }
+  return max_byte >= 0xC4 ? char_width::ucs2 : char_width::latin1;
+}
+
+auto converter::utf16_length_from_utf8_fallback(const unsigned char *bytes, std::size_t length) -> std::size_t
+{
+  std::size_t units = 0;
+  std::size_t i = 0;
+  for (; i + 8 <= length; i += 8)
+  {
+    const uint64_t word = load_word(bytes + i);
+    units += 8 - flagged_bytes(continuation_bytes(word)) + flagged_bytes(four_byte_leads(word));
+  }
+  for (; i < length; ++i)
+  {
+    units += static_cast<std::size_t>((bytes[i] & 0xC0U) != 0x80U) + static_cast<std::size_t>(bytes[i] >= 0xF0U);
+  }
+  return units;
+}
+
+auto converter::utf8_length_from_utf16_fallback(const char16_t *chars, std::size_t length, byte_order order) -> std::size_t
+{
+  const bool swap = order != byte_order::native;
+  std::size_t bytes = 0;
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    const char16_t unit = load_unit(chars, i, swap);
+    // A surrogate half accounts for 2 of the 4 bytes of its pair
+    bytes += (unit < 0x80U) ? 1 : (unit < 0x800U || (unit & 0xF800U) == 0xD800U) ? 2 : 3;
+  }
+  return bytes;
+}
+
+auto converter::utf8_length_from_utf32_fallback(const char32_t *chars, std::size_t length, byte_order order) -> std::size_t
+{
+  const bool swap = order != byte_order::native;
+  std::size_t bytes = 0;
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    const char32_t codepoint = load_unit(chars, i, swap);
+    bytes += 1 + static_cast<std::size_t>(codepoint > 0x7FU) + static_cast<std::size_t>(codepoint > 0x7FFU) + static_cast<std::size_t>(codepoint > 0xFFFFU);
+  }
+  return bytes;
+}
+
+auto converter::utf16_length_from_utf32_fallback(const char32_t *chars, std::size_t length, byte_order order) -> std::size_t
+{
+  const bool swap = order != byte_order::native;
+  std::size_t units = 0;
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    units += 1 + static_cast<std::size_t>(load_unit(chars, i, swap) > 0xFFFFU);
+  }
+  return units;
+}
+
+// #endif
+
+#if defined(RAPIDUTF_USE_AVX2)
+constexpr backend simd_backend = backend::avx2;
+#elif defined(RAPIDUTF_USE_NEON)
+constexpr backend simd_backend = backend::neon;
+#else
+constexpr backend simd_backend = backend::scalar;
+#endif
+
+// Whether the kernels may use the SIMD backend: one is compiled in and RAPIDUTF_FORCE_BACKEND does not ask for
+// scalar code. The environment is read once, on first use.
+static auto simd_selected() -> bool
+{
+  static const bool selected = []
+  {
+    const char *forced = std::getenv("RAPIDUTF_FORCE_BACKEND");  // NOLINT(concurrency-mt-unsafe)
+    return simd_backend != backend::scalar && (forced == nullptr || std::strcmp(forced, "scalar") != 0);
+  }();
+  return selected;
+}
+
+// Whether a conversion runs its SIMD kernel; every direction has one on each SIMD backend
+static inline auto uses_simd([[maybe_unused]] conversion direction) -> bool
+{
+  return simd_selected();
+}
+
+// Inputs shorter than this skip the kernels: their setup costs more than the conversion of a few characters
+constexpr std::size_t small_input_limit = 64;
+
+auto converter::utf8_to_utf16(const std::string &utf8, byte_order order) -> std::u16string
+{
+  std::u16string utf16;
+  utf8_to_utf16(utf8, utf16, order);
+  return utf16;
+}
+
+auto converter::utf16_to_utf8(const std::u16string &utf16, byte_order order) -> std::string
+{
+  std::string utf8;
+  utf16_to_utf8(utf16, utf8, order);
+  return utf8;
+}
+
+auto converter::utf16_to_utf32(const std::u16string &utf16, byte_order from, byte_order to) -> std::u32string
+{
+  std::u32string utf32;
+  utf16_to_utf32(utf16, utf32, from, to);
+  return utf32;
+}
+
+auto converter::utf32_to_utf16(const std::u32string &utf32, byte_order from, byte_order to) -> std::u16string
+{
+  std::u16string utf16;
+  utf32_to_utf16(utf32, utf16, from, to);
+  return utf16;
+}
+
+auto converter::utf8_to_utf32(const std::string &utf8, byte_order order) -> std::u32string
+{
+  std::u32string utf32;
+  utf8_to_utf32(utf8, utf32, order);
+  return utf32;
+}
+
+auto converter::utf32_to_utf8(const std::u32string &utf32, byte_order order) -> std::string
+{
+  std::string utf8;
+  utf32_to_utf8(utf32, utf8, order);
+  return utf8;
+}
+
+template<typename Output>
+auto converter::utf8_to_utf16_dispatch(std::string_view utf8, Output &utf16, byte_order order) -> void
+{
+  RAPIDUTF_STATS_CALL(utf8_to_utf16);
+  utf16.clear();
+  if (utf8.size() < small_input_limit)
+  {
+    RAPIDUTF_STATS_ADD(utf8_to_utf16, small_input_bytes, utf8.size());
+    const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (order == byte_order::native && detail::is_short_ascii(utf8.data(), utf8.size()))
+    {
+      utf16.assign(bytes, bytes + utf8.size());
+    }
+    else
+    {
+      utf16.reserve(utf8.size());
+      utf8_to_utf16_scalar(bytes, utf8.size(), utf16, order);
+    }
+  }
+  else
+  {
+    if (uses_simd(conversion::utf8_to_utf16))
+    {
+#if defined(RAPIDUTF_USE_AVX2)
+      RAPIDUTF_STATS_ADD(utf8_to_utf16, simd_bytes, utf8.size());
+      utf8_to_utf16_avx2(utf8, utf16, order);
+#elif defined(RAPIDUTF_USE_NEON)
+      RAPIDUTF_STATS_ADD(utf8_to_utf16, simd_bytes, utf8.size());
+      utf8_to_utf16_neon(utf8, utf16, order);
+#endif
+    }
+    else
+    {
+      RAPIDUTF_STATS_ADD(utf8_to_utf16, fallback_bytes, utf8.size());
+      utf8_to_utf16_fallback(utf8, utf16, order);
+    }
+  }
+}
+
+template<typename Output>
+auto converter::utf16_to_utf8_dispatch(std::u16string_view utf16, Output &utf8, byte_order order) -> void
+{
+  RAPIDUTF_STATS_CALL(utf16_to_utf8);
+  utf8.clear();
+  if (utf16.size() < small_input_limit && order == byte_order::native)
+  {
+    RAPIDUTF_STATS_ADD(utf16_to_utf8, small_input_bytes, utf16.size() * sizeof(char16_t));
+    if (detail::short_unit_bound(utf16.data(), utf16.size()) < 0x80U)
+    {
+      utf8.assign(utf16.begin(), utf16.end());
+      return;
+    }
+    utf8.reserve(utf16.size() * 3);
+    utf16_to_utf8_scalar(utf16.data(), utf16.size(), utf8);
+    return;
+  }
+
+  if (uses_simd(conversion::utf16_to_utf8))
+  {
+#if defined(RAPIDUTF_USE_AVX2)
+    RAPIDUTF_STATS_ADD(utf16_to_utf8, simd_bytes, utf16.size() * sizeof(char16_t));
+    utf16_to_utf8_avx2(utf16, utf8, order);
+#elif defined(RAPIDUTF_USE_NEON)
+    RAPIDUTF_STATS_ADD(utf16_to_utf8, simd_bytes, utf16.size() * sizeof(char16_t));
+    utf16_to_utf8_neon(utf16, utf8, order);
+#endif
+  }
+  else
+  {
+    RAPIDUTF_STATS_ADD(utf16_to_utf8, fallback_bytes, utf16.size() * sizeof(char16_t));
+    utf16_to_utf8_fallback(utf16, utf8, order);
+  }
+}
+
+template<typename Output>
+auto converter::utf16_to_utf32_dispatch(std::u16string_view utf16, Output &utf32, byte_order from, byte_order to) -> void
+{
+  RAPIDUTF_STATS_CALL(utf16_to_utf32);
+  utf32.clear();
+  // Short input without surrogates widens directly
+  if (utf16.size() < small_input_limit && from == byte_order::native && to == byte_order::native && detail::short_unit_bound(utf16.data(), utf16.size()) < 0xD800U)
+  {
+    RAPIDUTF_STATS_ADD(utf16_to_utf32, small_input_bytes, utf16.size() * sizeof(char16_t));
+    utf32.assign(utf16.begin(), utf16.end());
+  }
+  else
+  {
+    if (uses_simd(conversion::utf16_to_utf32))
+    {
+#if defined(RAPIDUTF_USE_AVX2)
+      RAPIDUTF_STATS_ADD(utf16_to_utf32, simd_bytes, utf16.size() * sizeof(char16_t));
+      utf16_to_utf32_avx2(utf16, utf32, from, to);
+#elif defined(RAPIDUTF_USE_NEON)
+      RAPIDUTF_STATS_ADD(utf16_to_utf32, simd_bytes, utf16.size() * sizeof(char16_t));
+      utf16_to_utf32_neon(utf16, utf32, from, to);
+#endif
+    }
+    else
+    {
+      RAPIDUTF_STATS_ADD(utf16_to_utf32, fallback_bytes, utf16.size() * sizeof(char16_t));
+      utf16_to_utf32_fallback(utf16, utf32, from, to);
+    }
+  }
+}
+
+template<typename Output>
+auto converter::utf32_to_utf16_dispatch(std::u32string_view utf32, Output &utf16, byte_order from, byte_order to) -> void
+{
+  RAPIDUTF_STATS_CALL(utf32_to_utf16);
+  utf16.clear();
+  // Short input below the surrogate range narrows directly
+  if (utf32.size() < small_input_limit && from == byte_order::native && to == byte_order::native && detail::short_unit_bound(utf32.data(), utf32.size()) < 0xD800U)
+  {
+    RAPIDUTF_STATS_ADD(utf32_to_utf16, small_input_bytes, utf32.size() * sizeof(char32_t));
+    utf16.assign(utf32.begin(), utf32.end());
+  }
+  else
+  {
+    if (uses_simd(conversion::utf32_to_utf16))
+    {
+#if defined(RAPIDUTF_USE_AVX2)
+      RAPIDUTF_STATS_ADD(utf32_to_utf16, simd_bytes, utf32.size() * sizeof(char32_t));
+      utf32_to_utf16_avx2(utf32, utf16, from, to);
+#elif defined(RAPIDUTF_USE_NEON)
+      RAPIDUTF_STATS_ADD(utf32_to_utf16, simd_bytes, utf32.size() * sizeof(char32_t));
+      utf32_to_utf16_neon(utf32, utf16, from, to);
+#endif
+    }
+    else
+    {
+      RAPIDUTF_STATS_ADD(utf32_to_utf16, fallback_bytes, utf32.size() * sizeof(char32_t));
+      utf32_to_utf16_fallback(utf32, utf16, from, to);
+    }
+  }
+}
+
+template<typename Output>
+auto converter::utf8_to_utf32_dispatch(std::string_view utf8, Output &utf32, byte_order order) -> void
+{
+  RAPIDUTF_STATS_CALL(utf8_to_utf32);
+  utf32.clear();
+  if (utf8.size() < small_input_limit)
+  {
+    RAPIDUTF_STATS_ADD(utf8_to_utf32, small_input_bytes, utf8.size());
+    const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (order == byte_order::native && detail::is_short_ascii(utf8.data(), utf8.size()))
     {
-      char32_t ch = chars[i];
-      if (ch <= 0xFFFF)
-      {
-        utf16.push_back(static_cast<char16_t>(ch));
-      }
-      else
-      {
-        ch -= 0x10000;
-        utf16.push_back(static_cast<char16_t>((ch >> 10U) + 0xD800U));
-        utf16.push_back(static_cast<char16_t>((ch & 0x3FFU) + 0xDC00U));
-      }
+      utf32.assign(bytes, bytes + utf8.size());
+    }
+    else
+    {
+      utf32.reserve(utf8.size());
+      utf8_to_utf32_scalar(bytes, utf8.size(), utf32, order);
     }
   }
-  else if (length >= 4)
+  else
   {
-    // Process 4 characters using NEON
-    const uint32x4_t chunk = vld1q_u32(reinterpret_cast<const uint32_t *>(chars));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-    const uint32x4_t mask = vcgtq_u32(chunk, vdupq_n_u32(0xFFFF));
-    const uint64x2_t result = vreinterpretq_u64_u32(mask);
-    const uint64_t combined = vgetq_lane_u64(result, 0) | vgetq_lane_u64(result, 1);
-
-    if (combined == 0)
+    if (uses_simd(conversion::utf8_to_utf32))
     {
-      const uint16x4_t utf16_chunk = vmovn_u32(chunk);
-      std::array<char16_t, 4> temp {0};
-      vst1_u16(reinterpret_cast<uint16_t *>(temp.data()), utf16_chunk);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-      utf16.append(temp.data(), 4);
+#if defined(RAPIDUTF_USE_AVX2)
+      RAPIDUTF_STATS_ADD(utf8_to_utf32, simd_bytes, utf8.size());
+      utf8_to_utf32_avx2(utf8, utf32, order);
+#elif defined(RAPIDUTF_USE_NEON)
+      RAPIDUTF_STATS_ADD(utf8_to_utf32, simd_bytes, utf8.size());
+      utf8_to_utf32_neon(utf8, utf32, order);
+#endif
     }
     else
     {
-      // Process each character individually
-      const char32_t ch0 = vgetq_lane_u32(chunk, 0);
-      const char32_t ch1 = vgetq_lane_u32(chunk, 1);
-      const char32_t ch2 = vgetq_lane_u32(chunk, 2);
-      const char32_t ch3 = vgetq_lane_u32(chunk, 3);
-
-      for (char32_t ch : {ch0, ch1, ch2, ch3})
-      {
-        if (ch <= 0xFFFF)
-        {
-          utf16.push_back(static_cast<char16_t>(ch));
-        }
-        else
-        {
-          ch -= 0x10000;
-          utf16.push_back(static_cast<char16_t>((ch >> 10U) + 0xD800U));
-          utf16.push_back(static_cast<char16_t>((ch & 0x3FFU) + 0xDC00U));
-        }
-      }
+      RAPIDUTF_STATS_ADD(utf8_to_utf32, fallback_bytes, utf8.size());
+      utf8_to_utf32_fallback(utf8, utf32, order);
     }
+  }
+}
 
-    // Process remaining characters
-    for (std::size_t i = 4; i < length; ++i)
+template<typename Output>
+auto converter::utf32_to_utf8_dispatch(std::u32string_view utf32, Output &utf8, byte_order order) -> void
+{
+  RAPIDUTF_STATS_CALL(utf32_to_utf8);
+  utf8.clear();
+  if (utf32.size() < small_input_limit && order == byte_order::native)
+  {
+    RAPIDUTF_STATS_ADD(utf32_to_utf8, small_input_bytes, utf32.size() * sizeof(char32_t));
+    if (detail::short_unit_bound(utf32.data(), utf32.size()) < 0x80U)
     {
-      char32_t ch = chars[i];
-      if (ch <= 0xFFFF)
-      {
-        utf16.push_back(static_cast<char16_t>(ch));
-      }
-      else
-      {
-        ch -= 0x10000;
-        utf16.push_back(static_cast<char16_t>((ch >> 10U) + 0xD800U));
-        utf16.push_back(static_cast<char16_t>((ch & 0x3FFU) + 0xDC00U));
-      }
+      utf8.assign(utf32.begin(), utf32.end());
+      return;
     }
+    utf8.reserve(utf32.size() * 4);
+    utf32_to_utf8_scalar(utf32.data(), utf32.size(), utf8);
+    return;
+  }
+
+  if (uses_simd(conversion::utf32_to_utf8))
+  {
+#if defined(RAPIDUTF_USE_AVX2)
+    RAPIDUTF_STATS_ADD(utf32_to_utf8, simd_bytes, utf32.size() * sizeof(char32_t));
+    utf32_to_utf8_avx2(utf32, utf8, order);
+#elif defined(RAPIDUTF_USE_NEON)
+    RAPIDUTF_STATS_ADD(utf32_to_utf8, simd_bytes, utf32.size() * sizeof(char32_t));
+    utf32_to_utf8_neon(utf32, utf8, order);
+#endif
   }
   else
   {
-    // Process all characters individually without NEON
-    for (std::size_t i = 0; i < length; ++i)
-    {
-      char32_t ch = chars[i];
-      if (ch <= 0xFFFF)
-      {
-        utf16.push_back(static_cast<char16_t>(ch));
-      }
-      else
-      {
-        ch -= 0x10000;
-        utf16.push_back(static_cast<char16_t>((ch >> 10U) + 0xD800U));
-        utf16.push_back(static_cast<char16_t>((ch & 0x3FFU) + 0xDC00U));
-      }
-    }
+    RAPIDUTF_STATS_ADD(utf32_to_utf8, fallback_bytes, utf32.size() * sizeof(char32_t));
+    utf32_to_utf8_fallback(utf32, utf8, order);
   }
+}
 
-  return utf16;
+auto converter::utf8_to_utf16(std::string_view utf8, std::u16string &utf16, byte_order order) -> void
+{
+  utf8_to_utf16_dispatch(utf8, utf16, order);
 }
 
-auto converter::utf8_to_utf32_neon(const std::string &utf8) -> std::u32string
+auto converter::utf8_to_utf16(std::string_view utf8, char16_t *output, std::size_t capacity, byte_order order) -> std::size_t
 {
-  std::u32string utf32;
-  utf32.reserve(utf8.size());
+  unit_sink<char16_t> sink(output, capacity);
+  utf8_to_utf16_dispatch(utf8, sink, order);
+  return sink.size();
+}
 
-  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-  const std::size_t length = utf8.length();
+auto converter::utf16_to_utf8(std::u16string_view utf16, std::string &utf8, byte_order order) -> void
+{
+  utf16_to_utf8_dispatch(utf16, utf8, order);
+}
 
-  std::array<char32_t, 16> buffer {0};  // Temporary buffer to hold 16 char32_t values
+auto converter::utf16_to_utf8(std::u16string_view utf16, char *output, std::size_t capacity, byte_order order) -> std::size_t
+{
+  unit_sink<char> sink(output, capacity);
+  utf16_to_utf8_dispatch(utf16, sink, order);
+  return sink.size();
+}
 
-  for (std::size_t i = 0; i < length;)
-  {
-    if (length - i >= 16)
-    {
-      const uint8x16_t chunk = vld1q_u8(bytes + i);
-      const uint8x16_t mask = vdupq_n_u8(0x80);
-      const uint8x16_t result = vceqq_u8(vandq_u8(chunk, mask), vdupq_n_u8(0));
-      const uint64_t bitfield_lo = vgetq_lane_u64(vreinterpretq_u64_u8(result), 0);
-      const uint64_t bitfield_hi = vgetq_lane_u64(vreinterpretq_u64_u8(result), 1);
-      const uint64_t bitfield = bitfield_lo | (bitfield_hi << 8U);
+auto converter::utf16_to_utf32(std::u16string_view utf16, std::u32string &utf32, byte_order from, byte_order to) -> void
+{
+  utf16_to_utf32_dispatch(utf16, utf32, from, to);
+}
 
-      if (bitfield == 0xFFFFFFFFFFFFFFFF)
-      {
-        // All characters in the chunk are ASCII
-        const uint8x16_t ascii_chars = vld1q_u8(bytes + i);
-        const uint16x8_t lo_chars = vmovl_u8(vget_low_u8(ascii_chars));
-        const uint16x8_t hi_chars = vmovl_u8(vget_high_u8(ascii_chars));
-        const uint32x4_t lo_lo_chars = vmovl_u16(vget_low_u16(lo_chars));
-        const uint32x4_t lo_hi_chars = vmovl_u16(vget_high_u16(lo_chars));
-        const uint32x4_t hi_lo_chars = vmovl_u16(vget_low_u16(hi_chars));
-        const uint32x4_t hi_hi_chars = vmovl_u16(vget_high_u16(hi_chars));
+auto converter::utf16_to_utf32(std::u16string_view utf16, char32_t *output, std::size_t capacity, byte_order from, byte_order to) -> std::size_t
+{
+  unit_sink<char32_t> sink(output, capacity);
+  utf16_to_utf32_dispatch(utf16, sink, from, to);
+  return sink.size();
+}
 
-        vst1q_u32(reinterpret_cast<uint32_t *>(buffer.data()), lo_lo_chars);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-        vst1q_u32(reinterpret_cast<uint32_t *>(buffer.data()) + 4, lo_hi_chars);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-        vst1q_u32(reinterpret_cast<uint32_t *>(buffer.data()) + 8, hi_lo_chars);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-        vst1q_u32(reinterpret_cast<uint32_t *>(buffer.data()) + 12, hi_hi_chars);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+auto converter::utf32_to_utf16(std::u32string_view utf32, std::u16string &utf16, byte_order from, byte_order to) -> void
+{
+  utf32_to_utf16_dispatch(utf32, utf16, from, to);
+}
 
-        utf32.append(buffer.begin(), buffer.end());
+auto converter::utf32_to_utf16(std::u32string_view utf32, char16_t *output, std::size_t capacity, byte_order from, byte_order to) -> std::size_t
+{
+  unit_sink<char16_t> sink(output, capacity);
+  utf32_to_utf16_dispatch(utf32, sink, from, to);
+  return sink.size();
+}
 
-        i += 16;
-      }
-      else
-      {
-        // Handle non-ASCII characters with NEON
-        utf8_to_utf32_scalar(bytes + i, length - i, utf32);
-        break;
-      }
-    }
-    else
-    {
-      utf8_to_utf32_scalar(bytes + i, length - i, utf32);
-      break;
-    }
-  }
+auto converter::utf8_to_utf32(std::string_view utf8, std::u32string &utf32, byte_order order) -> void
+{
+  utf8_to_utf32_dispatch(utf8, utf32, order);
+}
 
-  return utf32;
+auto converter::utf8_to_utf32(std::string_view utf8, char32_t *output, std::size_t capacity, byte_order order) -> std::size_t
+{
+  unit_sink<char32_t> sink(output, capacity);
+  utf8_to_utf32_dispatch(utf8, sink, order);
+  return sink.size();
+}
+
+auto converter::utf32_to_utf8(std::u32string_view utf32, std::string &utf8, byte_order order) -> void
+{
+  utf32_to_utf8_dispatch(utf32, utf8, order);
+}
+
+auto converter::utf32_to_utf8(std::u32string_view utf32, char *output, std::size_t capacity, byte_order order) -> std::size_t
+{
+  unit_sink<char> sink(output, capacity);
+  utf32_to_utf8_dispatch(utf32, sink, order);
+  return sink.size();
 }
 
-auto converter::utf32_to_utf8_neon(const std::u32string &utf32) -> std::string
+auto converter::count_utf8(std::string_view utf8) -> std::size_t
 {
-  if (!is_valid_utf32(utf32))
+  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+#if defined(RAPIDUTF_USE_AVX2)
+  if (simd_selected())
   {
-    throw std::runtime_error("Invalid UTF-32 string");
+    return count_utf8_avx2(bytes, utf8.length());
   }
+#elif defined(RAPIDUTF_USE_NEON)
+  if (simd_selected())
+  {
+    return count_utf8_neon(bytes, utf8.length());
+  }
+#endif
+  return count_utf8_fallback(bytes, utf8.length());
+}
 
-  std::string utf8;
-  utf8.reserve(utf32.size() * 4);
-
-  const char32_t *chars = utf32.data();
-  const std::size_t length = utf32.length();
+auto converter::count_utf16(std::u16string_view utf16, byte_order order) -> std::size_t
+{
+#if defined(RAPIDUTF_USE_AVX2)
+  if (simd_selected())
+  {
+    return count_utf16_avx2(utf16.data(), utf16.length(), order);
+  }
+#elif defined(RAPIDUTF_USE_NEON)
+  if (simd_selected())
+  {
+    return count_utf16_neon(utf16.data(), utf16.length(), order);
+  }
+#endif
+  return count_utf16_fallback(utf16.data(), utf16.length(), order);
+}
 
-  for (std::size_t i = 0; i < length;)
+auto converter::skip_code_points(std::string_view utf8, std::size_t count) -> std::size_t
+{
+  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  const std::size_t length = utf8.length();
+  std::size_t offset = 0;
+  // `count` bytes hold at most `count` code points, so a block that long is counted whole and the sequence it ends in
+  // completed; the remainder shrinks by the code points found until it is short enough for the byte loop
+  while (count >= small_input_limit && offset < length)
   {
-    if (length - i >= 4)
+    const std::size_t block = std::min(count, length - offset);
+    count -= count_utf8(utf8.substr(offset, block));
+    offset += block;
+    while (offset < length && (bytes[offset] & 0xC0U) == 0x80U)
     {
-      const uint32x4_t chunk = vld1q_u32(reinterpret_cast<const uint32_t *>(chars + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-      const uint32x4_t mask = vdupq_n_u32(0x7F);
-      const uint32x4_t result = vceqq_u32(vandq_u32(chunk, mask), chunk);
-      const uint64_t bitfield = vgetq_lane_u64(vreinterpretq_u64_u32(result), 0) & 0xFFFFFFFF;
-
-      if (bitfield == 0xFFFFFFFF)
-      {
-        std::array<char, 4> temp {0};
-        temp[0] = static_cast<char>(vgetq_lane_u32(chunk, 0));
-        temp[1] = static_cast<char>(vgetq_lane_u32(chunk, 1));
-        temp[2] = static_cast<char>(vgetq_lane_u32(chunk, 2));
-        temp[3] = static_cast<char>(vgetq_lane_u32(chunk, 3));
-        utf8.append(temp.data(), 4);
+      ++offset;
+    }
+  }
+  for (; count != 0 && offset < length; --count)
+  {
+    ++offset;
+    while (offset < length && (bytes[offset] & 0xC0U) == 0x80U)
+    {
+      ++offset;
+    }
+  }
+  return offset;
+}
 
-        i += 4;
-      }
-      else
-      {
-        // Handle non-ASCII characters with NEON
-        utf32_to_utf8_scalar(chars + i, length - i, utf8);
-        break;
-      }
+auto converter::skip_code_points(std::u16string_view utf16, std::size_t count) -> std::size_t
+{
+  const std::size_t length = utf16.length();
+  std::size_t offset = 0;
+  while (count >= small_input_limit && offset < length)
+  {
+    const std::size_t block = std::min(count, length - offset);
+    count -= count_utf16(utf16.substr(offset, block));
+    offset += block;
+    while (offset < length && (utf16[offset] & 0xFC00U) == 0xDC00U)
+    {
+      ++offset;
     }
-    else
+  }
+  for (; count != 0 && offset < length; --count)
+  {
+    ++offset;
+    while (offset < length && (utf16[offset] & 0xFC00U) == 0xDC00U)
     {
-      utf32_to_utf8_scalar(chars + i, length - i, utf8);
-      break;
+      ++offset;
     }
   }
+  return offset;
+}
 
-  return utf8;
+auto converter::truncate_utf8(std::string_view utf8, std::size_t max_bytes) -> std::string_view
+{
+  if (max_bytes >= utf8.length())
+  {
+    return utf8;
+  }
+  // The byte at the cut starts the first code point left out unless it continues one, which starts at most 3 bytes back
+  std::size_t cut = max_bytes;
+  for (int back = 0; back < 3 && cut > 0 && (static_cast<unsigned char>(utf8[cut]) & 0xC0U) == 0x80U; ++back)
+  {
+    --cut;
+  }
+  return utf8.substr(0, cut);
 }
 
-// #else
-#endif
+auto converter::truncate_utf16(std::u16string_view utf16, std::size_t max_units) -> std::u16string_view
+{
+  if (max_units >= utf16.length())
+  {
+    return utf16;
+  }
+  std::size_t cut = max_units;
+  if (cut > 0 && (utf16[cut] & 0xFC00U) == 0xDC00U)
+  {
+    --cut;
+  }
+  return utf16.substr(0, cut);
+}
 
-auto converter::utf8_to_utf16_fallback(const std::string &utf8) -> std::u16string
+auto converter::truncate_utf8_code_points(std::string_view utf8, std::size_t count) -> std::string_view
 {
-  std::u16string utf16;
-  utf16.reserve(utf8.size());
+  return utf8.substr(0, skip_code_points(utf8, count));
+}
 
-  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-  const std::size_t length = utf8.length();
+auto converter::truncate_utf16_code_points(std::u16string_view utf16, std::size_t count) -> std::u16string_view
+{
+  return utf16.substr(0, skip_code_points(utf16, count));
+}
 
-  utf8_to_utf16_scalar(bytes, length, utf16);
+auto converter::split_at_boundaries(std::string_view utf8, std::size_t chunk_size) -> std::vector<std::string_view>
+{
+  if (chunk_size < 4)
+  {
+    throw std::runtime_error("Chunk size is shorter than a UTF-8 sequence");
+  }
+  std::vector<std::string_view> chunks;
+  chunks.reserve(utf8.length() / chunk_size + 1);
+  while (!utf8.empty())
+  {
+    chunks.push_back(truncate_utf8(utf8, chunk_size));
+    utf8.remove_prefix(chunks.back().length());
+  }
+  return chunks;
+}
 
-  return utf16;
+auto converter::split_at_boundaries(std::u16string_view utf16, std::size_t chunk_size) -> std::vector<std::u16string_view>
+{
+  if (chunk_size < 2)
+  {
+    throw std::runtime_error("Chunk size is shorter than a UTF-16 sequence");
+  }
+  std::vector<std::u16string_view> chunks;
+  chunks.reserve(utf16.length() / chunk_size + 1);
+  while (!utf16.empty())
+  {
+    chunks.push_back(truncate_utf16(utf16, chunk_size));
+    utf16.remove_prefix(chunks.back().length());
+  }
+  return chunks;
 }
 
-auto converter::utf16_to_utf8_fallback(const std::u16string &utf16) -> std::string
+// Offset just past the first `count` UTF-16 units of the conversion of well-formed UTF-8, rounded up to the end of a
+// surrogate pair. Bytes never encode more units than they are long, except a 4-byte lead cut off at the end of a
+// block, so a block one byte shorter than `count` cannot overshoot.
+static auto skip_utf16_units(std::string_view utf8, std::size_t count) -> std::size_t
 {
-  std::string utf8;
-  utf8.reserve(utf16.size() * 3);
+  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  const std::size_t length = utf8.length();
+  std::size_t offset = 0;
+  while (count >= small_input_limit && offset < length)
+  {
+    const std::size_t block = std::min(count - 1, length - offset);
+    count -= converter::utf16_length_from_utf8(utf8.substr(offset, block));
+    offset += block;
+    while (offset < length && (bytes[offset] & 0xC0U) == 0x80U)
+    {
+      ++offset;
+    }
+  }
+  while (count != 0 && offset < length)
+  {
+    count -= std::min<std::size_t>(count, bytes[offset] >= 0xF0U ? 2 : 1);
+    ++offset;
+    while (offset < length && (bytes[offset] & 0xC0U) == 0x80U)
+    {
+      ++offset;
+    }
+  }
+  return offset;
+}
 
-  const char16_t *chars = utf16.data();
-  const std::size_t length = utf16.length();
+// A code point boundary in UTF-8 text, counted in every offset_unit
+struct text_cursor
+{
+  std::size_t byte = 0;
+  std::size_t utf16 = 0;
+  std::size_t code_point = 0;
 
-  utf16_to_utf8_scalar(chars, length, utf8);
+  auto operator[](offset_unit unit) const -> std::size_t
+  {
+    switch (unit)
+    {
+      case offset_unit::utf8:
+        return byte;
+      case offset_unit::utf16:
+        return utf16;
+      case offset_unit::code_point:
+        break;
+    }
+    return code_point;
+  }
+};
 
-  return utf8;
+// Moves the cursor forward to `target`, counting the bytes it passes; targets at or behind the cursor leave it in place
+static auto advance_cursor(std::string_view utf8, text_cursor &cursor, std::size_t target, offset_unit unit) -> void
+{
+  if (target <= cursor[unit] || cursor.byte == utf8.length())
+  {
+    return;
+  }
+  const std::string_view rest = utf8.substr(cursor.byte);
+  std::size_t step = 0;
+  switch (unit)
+  {
+    case offset_unit::utf8:
+      step = std::min(target - cursor.byte, rest.length());
+      while (step < rest.length() && (static_cast<unsigned char>(rest[step]) & 0xC0U) == 0x80U)
+      {
+        ++step;
+      }
+      break;
+    case offset_unit::utf16:
+      step = skip_utf16_units(rest, target - cursor.utf16);
+      break;
+    case offset_unit::code_point:
+      step = converter::skip_code_points(rest, target - cursor.code_point);
+      break;
+  }
+  const std::string_view passed = rest.substr(0, step);
+  cursor.byte += step;
+  cursor.utf16 += converter::utf16_length_from_utf8(passed);
+  cursor.code_point += converter::count_utf8(passed);
 }
 
-auto converter::utf16_to_utf32_fallback(const std::u16string &utf16) -> std::u32string
+auto converter::translate_offset(std::string_view utf8, std::size_t offset, offset_unit from, offset_unit to) -> std::size_t
 {
-  std::u32string utf32;
-  utf32.reserve(utf16.size());
-
-  const char16_t *chars = utf16.data();
-  const std::size_t length = utf16.length();
-
-  utf16_to_utf32_scalar(chars, length, utf32);
-
-  return utf32;
+  text_cursor cursor;
+  advance_cursor(utf8, cursor, offset, from);
+  return cursor[to];
 }
 
-auto converter::utf32_to_utf16_fallback(const std::u32string &utf32) -> std::u16string
+auto converter::translate_range(std::string_view utf8, text_range range, offset_unit from, offset_unit to) -> text_range
 {
-  std::u16string utf16;
-  utf16.reserve(utf32.size() * 2);
-
-  const char32_t *chars = utf32.data();
-  const std::size_t length = utf32.length();
+  text_cursor cursor;
+  advance_cursor(utf8, cursor, std::min(range.begin, range.end), from);
+  const std::size_t first = cursor[to];
+  advance_cursor(utf8, cursor, std::max(range.begin, range.end), from);
+  return range.begin <= range.end ? text_range {first, cursor[to]} : text_range {cursor[to], first};
+}
 
-  utf32_to_utf16_scalar(chars, length, utf16);
+auto converter::translate_offsets(std::string_view utf8, std::vector<std::size_t> &offsets, offset_unit from, offset_unit to) -> void
+{
+  // Visiting the offsets in ascending order lets one cursor pass over the text once
+  std::vector<std::size_t> order(offsets.size());
+  for (std::size_t i = 0; i < order.size(); ++i)
+  {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&offsets](std::size_t lhs, std::size_t rhs) { return offsets[lhs] < offsets[rhs]; });
 
-  return utf16;
+  text_cursor cursor;
+  for (const std::size_t i : order)
+  {
+    advance_cursor(utf8, cursor, offsets[i], from);
+    offsets[i] = cursor[to];
+  }
 }
 
-auto converter::utf8_to_utf32_fallback(const std::string &utf8) -> std::u32string
+utf8_offset_index::utf8_offset_index(std::string_view utf8, std::size_t stride)
+    : text_(utf8)
+    , stride_(stride)
+    , offsets_ {0}
+    , utf16_offsets_ {0}
 {
-  std::u32string utf32;
-  utf32.reserve(utf8.size());
-
-  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-  const std::size_t length = utf8.length();
+  if (stride == 0)
+  {
+    throw std::runtime_error("Index stride must be positive");
+  }
+  offsets_.reserve(utf8.length() / stride + 1);
+  utf16_offsets_.reserve(utf8.length() / stride + 1);
+  index_from_last_checkpoint();
+}
 
-  utf8_to_utf32_scalar(bytes, length, utf32);
+auto utf8_offset_index::index_from_last_checkpoint() -> void
+{
+  // A checkpoint is recorded only when `stride` whole code points lie before the end, so appended text may extend
+  // the last, partial block
+  std::size_t offset = offsets_.back();
+  for (;;)
+  {
+    const std::string_view rest = text_.substr(offset);
+    const std::size_t step = converter::skip_code_points(rest, stride_);
+    if (step == rest.length())
+    {
+      size_ = (offsets_.size() - 1) * stride_ + converter::count_utf8(rest);
+      return;
+    }
+    utf16_offsets_.push_back(utf16_offsets_.back() + converter::utf16_length_from_utf8(rest.substr(0, step)));
+    offset += step;
+    offsets_.push_back(offset);
+  }
+}
 
-  return utf32;
+auto utf8_offset_index::append(std::string_view utf8) -> void
+{
+  if (utf8.length() < text_.length())
+  {
+    throw std::runtime_error("Appended text is shorter than the indexed text");
+  }
+  text_ = utf8;
+  index_from_last_checkpoint();
 }
 
-auto converter::utf32_to_utf8_fallback(const std::u32string &utf32) -> std::string
+auto utf8_offset_index::translate(std::size_t offset, offset_unit from, offset_unit to) const -> std::size_t
 {
-  if (!is_valid_utf32(utf32))
+  std::size_t block = 0;
+  switch (from)
   {
-    throw std::runtime_error("Invalid UTF-32 string");
+    case offset_unit::utf8:
+      block = static_cast<std::size_t>(std::upper_bound(offsets_.begin(), offsets_.end(), offset) - offsets_.begin()) - 1;
+      break;
+    case offset_unit::utf16:
+      block = static_cast<std::size_t>(std::upper_bound(utf16_offsets_.begin(), utf16_offsets_.end(), offset) - utf16_offsets_.begin()) - 1;
+      break;
+    case offset_unit::code_point:
+      block = std::min(offset / stride_, offsets_.size() - 1);
+      break;
   }
+  text_cursor cursor {offsets_[block], utf16_offsets_[block], block * stride_};
+  advance_cursor(text_, cursor, offset, from);
+  return cursor[to];
+}
 
-  std::string utf8;
-  utf8.reserve(utf32.size() * 4);
+auto utf8_offset_index::translate(text_range range, offset_unit from, offset_unit to) const -> text_range
+{
+  return {translate(range.begin, from, to), translate(range.end, from, to)};
+}
 
-  const char32_t *chars = utf32.data();
-  const std::size_t length = utf32.length();
+auto utf8_offset_index::byte_offset(std::size_t code_point) const -> std::size_t
+{
+  if (code_point >= size_)
+  {
+    return text_.length();
+  }
+  const std::size_t checkpoint = offsets_[code_point / stride_];
+  return checkpoint + converter::skip_code_points(text_.substr(checkpoint), code_point % stride_);
+}
 
-  utf32_to_utf8_scalar(chars, length, utf8);
+auto utf8_offset_index::code_point_index(std::size_t byte_offset) const -> std::size_t
+{
+  byte_offset = std::min(byte_offset, text_.length());
+  const auto next = std::upper_bound(offsets_.begin(), offsets_.end(), byte_offset);
+  const auto block = static_cast<std::size_t>(next - offsets_.begin()) - 1;
+  return block * stride_ + converter::count_utf8(text_.substr(offsets_[block], byte_offset - offsets_[block]));
+}
 
-  return utf8;
+auto converter::utf16_length_from_utf8(std::string_view utf8) -> std::size_t
+{
+  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+#if defined(RAPIDUTF_USE_AVX2)
+  if (simd_selected())
+  {
+    return utf16_length_from_utf8_avx2(bytes, utf8.length());
+  }
+#elif defined(RAPIDUTF_USE_NEON)
+  if (simd_selected())
+  {
+    return utf16_length_from_utf8_neon(bytes, utf8.length());
+  }
+#endif
+  return utf16_length_from_utf8_fallback(bytes, utf8.length());
 }
 
-// #endif
+auto converter::utf8_length_from_utf16(std::u16string_view utf16, byte_order order) -> std::size_t
+{
+#if defined(RAPIDUTF_USE_AVX2)
+  if (simd_selected())
+  {
+    return utf8_length_from_utf16_avx2(utf16.data(), utf16.length(), order);
+  }
+#elif defined(RAPIDUTF_USE_NEON)
+  if (simd_selected())
+  {
+    return utf8_length_from_utf16_neon(utf16.data(), utf16.length(), order);
+  }
+#endif
+  return utf8_length_from_utf16_fallback(utf16.data(), utf16.length(), order);
+}
 
-auto converter::utf8_to_utf16(const std::string &utf8) -> std::u16string
+auto converter::utf8_length_from_utf32(std::u32string_view utf32, byte_order order) -> std::size_t
 {
 #if defined(RAPIDUTF_USE_AVX2)
-  return utf8_to_utf16_avx2(utf8);
-#elif defined(RAPIDUTF_USE_NEON) && (0)
-  return utf8_to_utf16_neon(utf8);
-#else
-  return utf8_to_utf16_fallback(utf8);
+  if (simd_selected())
+  {
+    return utf8_length_from_utf32_avx2(utf32.data(), utf32.length(), order);
+  }
+#elif defined(RAPIDUTF_USE_NEON)
+  if (simd_selected())
+  {
+    return utf8_length_from_utf32_neon(utf32.data(), utf32.length(), order);
+  }
 #endif
+  return utf8_length_from_utf32_fallback(utf32.data(), utf32.length(), order);
 }
 
-auto converter::utf16_to_utf8(const std::u16string &utf16) -> std::string
+auto converter::utf16_length_from_utf32(std::u32string_view utf32, byte_order order) -> std::size_t
 {
-#if defined(RAPIDUTF_USE_AVX2) && 0
-  return utf16_to_utf8_avx2(utf16);
-#elif defined(RAPIDUTF_USE_NEON) //&& (0)
-  return utf16_to_utf8_neon(utf16);
-#else
-  return utf16_to_utf8_fallback(utf16);
+#if defined(RAPIDUTF_USE_AVX2)
+  if (simd_selected())
+  {
+    return utf16_length_from_utf32_avx2(utf32.data(), utf32.length(), order);
+  }
+#elif defined(RAPIDUTF_USE_NEON)
+  if (simd_selected())
+  {
+    return utf16_length_from_utf32_neon(utf32.data(), utf32.length(), order);
+  }
 #endif
+  return utf16_length_from_utf32_fallback(utf32.data(), utf32.length(), order);
 }
 
-auto converter::utf16_to_utf32(const std::u16string &utf16) -> std::u32string
+auto converter::is_ascii(std::string_view utf8) -> bool
 {
+  return find_first_non_ascii(utf8) == utf8.length();
+}
+
+auto converter::find_first_non_ascii(std::string_view utf8) -> std::size_t
+{
+  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
 #if defined(RAPIDUTF_USE_AVX2)
-  return utf16_to_utf32_avx2(utf16);
+  if (simd_selected())
+  {
+    return find_first_non_ascii_avx2(bytes, utf8.length());
+  }
 #elif defined(RAPIDUTF_USE_NEON)
-  return utf16_to_utf32_neon(utf16);
-#else
-  return utf16_to_utf32_fallback(utf16);
+  if (simd_selected())
+  {
+    return find_first_non_ascii_neon(bytes, utf8.length());
+  }
 #endif
+  return find_first_non_ascii_fallback(bytes, utf8.length());
 }
 
-auto converter::utf32_to_utf16(const std::u32string &utf32) -> std::u16string
+auto converter::utf8_to_narrowest(const std::string &utf8) -> narrow_text
 {
+  const auto *bytes = reinterpret_cast<const unsigned char *>(utf8.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+  // Pre-scan picks the width, the decode pass then writes that width directly
+  narrow_text text;
+  if (simd_selected())
+  {
 #if defined(RAPIDUTF_USE_AVX2)
-  return utf32_to_utf16_avx2(utf32);
+    text.width = utf8_char_width_avx2(bytes, utf8.length());
 #elif defined(RAPIDUTF_USE_NEON)
-  return utf32_to_utf16_neon(utf32);
-#else
-  return utf32_to_utf16_fallback(utf32);
+    text.width = utf8_char_width_neon(bytes, utf8.length());
 #endif
+  }
+  else
+  {
+    text.width = utf8_char_width_fallback(bytes, utf8.length());
+  }
+
+  switch (text.width)
+  {
+    case char_width::latin1:
+      // One output byte per non-continuation byte, so the size is exact before decoding
+      text.latin1.resize(count_utf8(utf8));
+      utf8_to_latin1_scalar(bytes, utf8.length(), text.latin1.data());
+      break;
+    case char_width::ucs2:
+      // Without four-byte sequences UTF-16 has no surrogate pairs and is UCS-2
+      text.ucs2 = utf8_to_utf16(utf8);
+      break;
+    case char_width::ucs4:
+      text.ucs4 = utf8_to_utf32(utf8);
+      break;
+  }
+  return text;
 }
 
-auto converter::utf8_to_utf32(const std::string &utf8) -> std::u32string
+auto detail::kernel_tables() -> std::vector<kernel_table>
 {
+  // The fallback kernels are the scalar loops behind a string interface, so they also stand in for the *_scalar helpers
+  std::vector<kernel_table> tables;
 #if defined(RAPIDUTF_USE_AVX2)
-  return utf8_to_utf32_avx2(utf8);
+  tables.push_back({"avx2",
+                    [](const std::string &utf8) { std::u16string utf16; converter::utf8_to_utf16_avx2(utf8, utf16, byte_order::native); return utf16; },
+                    [](const std::u16string &utf16) { std::string utf8; converter::utf16_to_utf8_avx2(utf16, utf8, byte_order::native); return utf8; },
+                    [](const std::u16string &utf16) { std::u32string utf32; converter::utf16_to_utf32_avx2(utf16, utf32, byte_order::native, byte_order::native); return utf32; },
+                    [](const std::u32string &utf32) { std::u16string utf16; converter::utf32_to_utf16_avx2(utf32, utf16, byte_order::native, byte_order::native); return utf16; },
+                    [](const std::string &utf8) { std::u32string utf32; converter::utf8_to_utf32_avx2(utf8, utf32, byte_order::native); return utf32; },
+                    [](const std::u32string &utf32) { std::string utf8; converter::utf32_to_utf8_avx2(utf32, utf8, byte_order::native); return utf8; },
+                    [](std::string_view utf8) { return converter::count_utf8_avx2(reinterpret_cast<const unsigned char *>(utf8.data()), utf8.length()); },  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+                    [](std::u16string_view utf16) { return converter::count_utf16_avx2(utf16.data(), utf16.length(), byte_order::native); },
+                    [](std::string_view utf8) { return converter::find_first_non_ascii_avx2(reinterpret_cast<const unsigned char *>(utf8.data()), utf8.length()); }});  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
 #elif defined(RAPIDUTF_USE_NEON)
-  return utf8_to_utf32_neon(utf8);
-#else
-  return utf8_to_utf32_fallback(utf8);
+  tables.push_back({"neon",
+                    [](const std::string &utf8) { std::u16string utf16; converter::utf8_to_utf16_neon(utf8, utf16, byte_order::native); return utf16; },
+                    [](const std::u16string &utf16) { std::string utf8; converter::utf16_to_utf8_neon(utf16, utf8, byte_order::native); return utf8; },
+                    [](const std::u16string &utf16) { std::u32string utf32; converter::utf16_to_utf32_neon(utf16, utf32, byte_order::native, byte_order::native); return utf32; },
+                    [](const std::u32string &utf32) { std::u16string utf16; converter::utf32_to_utf16_neon(utf32, utf16, byte_order::native, byte_order::native); return utf16; },
+                    [](const std::string &utf8) { std::u32string utf32; converter::utf8_to_utf32_neon(utf8, utf32, byte_order::native); return utf32; },
+                    [](const std::u32string &utf32) { std::string utf8; converter::utf32_to_utf8_neon(utf32, utf8, byte_order::native); return utf8; },
+                    [](std::string_view utf8) { return converter::count_utf8_neon(reinterpret_cast<const unsigned char *>(utf8.data()), utf8.length()); },  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+                    [](std::u16string_view utf16) { return converter::count_utf16_neon(utf16.data(), utf16.length(), byte_order::native); },
+                    [](std::string_view utf8) { return converter::find_first_non_ascii_neon(reinterpret_cast<const unsigned char *>(utf8.data()), utf8.length()); }});  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
 #endif
+  tables.push_back({"fallback",
+                    [](const std::string &utf8) { std::u16string utf16; converter::utf8_to_utf16_fallback(utf8, utf16, byte_order::native); return utf16; },
+                    [](const std::u16string &utf16) { std::string utf8; converter::utf16_to_utf8_fallback(utf16, utf8, byte_order::native); return utf8; },
+                    [](const std::u16string &utf16) { std::u32string utf32; converter::utf16_to_utf32_fallback(utf16, utf32, byte_order::native, byte_order::native); return utf32; },
+                    [](const std::u32string &utf32) { std::u16string utf16; converter::utf32_to_utf16_fallback(utf32, utf16, byte_order::native, byte_order::native); return utf16; },
+                    [](const std::string &utf8) { std::u32string utf32; converter::utf8_to_utf32_fallback(utf8, utf32, byte_order::native); return utf32; },
+                    [](const std::u32string &utf32) { std::string utf8; converter::utf32_to_utf8_fallback(utf32, utf8, byte_order::native); return utf8; },
+                    [](std::string_view utf8) { return converter::count_utf8_fallback(reinterpret_cast<const unsigned char *>(utf8.data()), utf8.length()); },  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+                    [](std::u16string_view utf16) { return converter::count_utf16_fallback(utf16.data(), utf16.length(), byte_order::native); },
+                    [](std::string_view utf8) { return converter::find_first_non_ascii_fallback(reinterpret_cast<const unsigned char *>(utf8.data()), utf8.length()); }});  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  return tables;
+}
+
+auto converter::swap_byte_order(std::u16string &utf16) -> void
+{
+  swap_units(utf16.data(), utf16.length());
+}
+
+auto converter::swap_byte_order(std::u32string &utf32) -> void
+{
+  swap_units(utf32.data(), utf32.length());
+}
+
+auto converter::swap_byte_order(char16_t *utf16, std::size_t length) -> void
+{
+  swap_units(utf16, length);
+}
+
+auto converter::swap_byte_order(char32_t *utf32, std::size_t length) -> void
+{
+  swap_units(utf32, length);
+}
+
+// Upper bound on the number of bytes inspected by the encoding heuristics
+static constexpr std::size_t detect_encoding_prefix = 4096;
+
+static inline auto load_utf16_bytes(const unsigned char *bytes, bool big_endian) -> uint32_t
+{
+  return big_endian ? ((static_cast<uint32_t>(bytes[0]) << 8U) | bytes[1]) : (bytes[0] | (static_cast<uint32_t>(bytes[1]) << 8U));
 }
 
-auto converter::utf32_to_utf8(const std::u32string &utf32) -> std::string
+static inline auto load_utf32_bytes(const unsigned char *bytes, bool big_endian) -> uint32_t
 {
+  return big_endian ? ((static_cast<uint32_t>(bytes[0]) << 24U) | (static_cast<uint32_t>(bytes[1]) << 16U) | (static_cast<uint32_t>(bytes[2]) << 8U) | bytes[3])
+                    : (bytes[0] | (static_cast<uint32_t>(bytes[1]) << 8U) | (static_cast<uint32_t>(bytes[2]) << 16U) | (static_cast<uint32_t>(bytes[3]) << 24U));
+}
+
+// Checks surrogate pairing; a high surrogate at the very end is tolerated when the input was cut short
+static auto utf16_bytes_are_valid(const unsigned char *bytes, std::size_t length, bool big_endian, bool truncated) -> bool
+{
+  const std::size_t units = length / 2;
+  for (std::size_t i = 0; i < units; ++i)
+  {
+    const uint32_t chr = load_utf16_bytes(bytes + (i * 2), big_endian);
+    if (chr >= 0xD800U && chr <= 0xDBFFU)
+    {
+      if (i + 1 >= units)
+      {
+        return truncated;
+      }
+      const uint32_t next = load_utf16_bytes(bytes + ((i + 1) * 2), big_endian);
+      if (next < 0xDC00U || next > 0xDFFFU)
+      {
+        return false;
+      }
+      ++i;
+    }
+    else if (chr >= 0xDC00U && chr <= 0xDFFFU)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static auto utf32_bytes_are_valid(const unsigned char *bytes, std::size_t length, bool big_endian) -> bool
+{
+  for (std::size_t i = 0; i + 4 <= length; i += 4)
+  {
+    const uint32_t chr = load_utf32_bytes(bytes + i, big_endian);
+    if (chr > 0x10FFFFU || (chr >= 0xD800U && chr <= 0xDFFFU))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto converter::detect_bom(const unsigned char *bytes, std::size_t length) -> encoding
+{
+  if (length >= 4 && bytes[0] == 0xFF && bytes[1] == 0xFE && bytes[2] == 0x00 && bytes[3] == 0x00)
+  {
+    return encoding::utf32_le;
+  }
+  if (length >= 4 && bytes[0] == 0x00 && bytes[1] == 0x00 && bytes[2] == 0xFE && bytes[3] == 0xFF)
+  {
+    return encoding::utf32_be;
+  }
+  if (length >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF)
+  {
+    return encoding::utf8;
+  }
+  if (length >= 2 && bytes[0] == 0xFF && bytes[1] == 0xFE)
+  {
+    return encoding::utf16_le;
+  }
+  if (length >= 2 && bytes[0] == 0xFE && bytes[1] == 0xFF)
+  {
+    return encoding::utf16_be;
+  }
+  return encoding::unknown;
+}
+
+auto converter::bom_length(const void *data, std::size_t length) -> std::size_t
+{
+  switch (detect_bom(static_cast<const unsigned char *>(data), length))
+  {
+    case encoding::utf8:
+      return 3;
+    case encoding::utf16_le:
+    case encoding::utf16_be:
+      return 2;
+    case encoding::utf32_le:
+    case encoding::utf32_be:
+      return 4;
+    case encoding::unknown:
+      break;
+  }
+  return 0;
+}
+
+auto converter::detect_encoding(const void *data, std::size_t length) -> encoding  // NOLINT(readability-function-cognitive-complexity)
+{
+  const auto *bytes = static_cast<const unsigned char *>(data);
+
+  const encoding from_bom = detect_bom(bytes, length);
+  if (from_bom != encoding::unknown)
+  {
+    return from_bom;
+  }
+  if (length == 0)
+  {
+    return encoding::utf8;
+  }
+
+  const bool truncated = length > detect_encoding_prefix;
+  const std::size_t prefix = std::min(length, detect_encoding_prefix);
+
+  // Census of zero bytes per offset modulo 4 and of surrogate high bytes (0xD8-0xDF) per offset parity
+  std::array<std::size_t, 4> zeros {0};
+  std::array<std::size_t, 2> surrogate_bytes {0};
+  std::size_t i = 0;
+
 #if defined(RAPIDUTF_USE_AVX2)
-  return utf32_to_utf8_avx2(utf32);
-#elif defined(RAPIDUTF_USE_NEON) && (0)
-  return utf32_to_utf8_neon(utf32);
-#else
-  return utf32_to_utf8_fallback(utf32);
+  for (; i + 32 <= prefix; i += 32)
+  {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto zero_mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_setzero_si256())));
+    const auto surrogate_mask = static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(chunk, _mm256_set1_epi8(static_cast<char>(0xF8))), _mm256_set1_epi8(static_cast<char>(0xD8)))));
+
+    for (std::size_t k = 0; k < 4; ++k)
+    {
+      zeros[k] += static_cast<std::size_t>(popcount(zero_mask & (0x11111111U << k)));
+    }
+    surrogate_bytes[0] += static_cast<std::size_t>(popcount(surrogate_mask & 0x55555555U));
+    surrogate_bytes[1] += static_cast<std::size_t>(popcount(surrogate_mask & 0xAAAAAAAAU));
+  }
+#elif defined(RAPIDUTF_USE_NEON)
+  static constexpr std::array<uint8_t, 16> lane_offsets {0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3};
+  const uint8x16_t offsets = vld1q_u8(lane_offsets.data());
+  for (; i + 16 <= prefix; i += 16)
+  {
+    const uint8x16_t chunk = vld1q_u8(bytes + i);
+    const uint8x16_t is_zero = vceqzq_u8(chunk);
+    const uint8x16_t is_surrogate = vceqq_u8(vandq_u8(chunk, vdupq_n_u8(0xF8)), vdupq_n_u8(0xD8));
+
+    for (std::size_t k = 0; k < 4; ++k)
+    {
+      const uint8x16_t lane_is_k = vceqq_u8(offsets, vdupq_n_u8(static_cast<uint8_t>(k)));
+      zeros[k] += vaddvq_u8(vandq_u8(vandq_u8(is_zero, lane_is_k), vdupq_n_u8(1)));
+    }
+    const uint8x16_t even_lanes = vceqq_u8(vandq_u8(offsets, vdupq_n_u8(1)), vdupq_n_u8(0));
+    surrogate_bytes[0] += vaddvq_u8(vandq_u8(vandq_u8(is_surrogate, even_lanes), vdupq_n_u8(1)));
+    surrogate_bytes[1] += vaddvq_u8(vandq_u8(vbicq_u8(is_surrogate, even_lanes), vdupq_n_u8(1)));
+  }
 #endif
+
+  for (; i < prefix; ++i)
+  {
+    if (bytes[i] == 0)
+    {
+      ++zeros[i % 4];
+    }
+    if ((bytes[i] & 0xF8U) == 0xD8U)
+    {
+      ++surrogate_bytes[i % 2];
+    }
+  }
+
+  const std::size_t total_zeros = zeros[0] + zeros[1] + zeros[2] + zeros[3];
+
+  // UTF-32: one end of every unit is zero and every unit is a valid scalar value
+  if (length % 4 == 0)
+  {
+    const std::size_t units = prefix / 4;
+    if (zeros[3] == units && utf32_bytes_are_valid(bytes, prefix, false))
+    {
+      return encoding::utf32_le;
+    }
+    if (zeros[0] == units && utf32_bytes_are_valid(bytes, prefix, true))
+    {
+      return encoding::utf32_be;
+    }
+  }
+
+  // A prefix cut in the middle of a sequence still counts as valid UTF-8
+  const auto is_utf8 = [&]() -> bool
+  {
+    const std::size_t valid = utf8_valid_prefix(bytes, prefix);
+    if (valid == prefix)
+    {
+      return true;
+    }
+    const std::size_t rest = prefix - valid;
+    if (!truncated || utf8_sequence_length(bytes[valid]) <= rest)
+    {
+      return false;
+    }
+    return std::all_of(bytes + valid + 1, bytes + prefix, [](unsigned char byte) { return (byte & 0xC0U) == 0x80U; });
+  };
+
+  // Real-world UTF-8 text practically never contains NUL bytes
+  if (total_zeros == 0 && is_utf8())
+  {
+    return encoding::utf8;
+  }
+
+  // UTF-16: the zero high bytes of Latin text pick the byte order, surrogate pairing must hold in that order
+  if (length % 2 == 0)
+  {
+    const std::size_t le_zeros = zeros[1] + zeros[3];
+    const std::size_t be_zeros = zeros[0] + zeros[2];
+    const bool le_valid = surrogate_bytes[1] == 0 || utf16_bytes_are_valid(bytes, prefix, false, truncated);
+    const bool be_valid = surrogate_bytes[0] == 0 || utf16_bytes_are_valid(bytes, prefix, true, truncated);
+
+    if (le_valid && le_zeros >= be_zeros)
+    {
+      return encoding::utf16_le;
+    }
+    if (be_valid)
+    {
+      return encoding::utf16_be;
+    }
+    if (le_valid)
+    {
+      return encoding::utf16_le;
+    }
+  }
+
+  if (is_utf8())
+  {
+    return encoding::utf8;
+  }
+  return encoding::unknown;
 }
 
 auto converter::utf8_to_wide(const std::string &utf8) -> std::wstring
@@ -1685,6 +4183,56 @@ auto converter::wide_to_utf8(const std::wstring &wide) -> std::string
 #endif  // RAPIDUTF_WCHAR_T_IS_WIDE
 }
 
+auto converter::stats() -> runtime_stats
+{
+  runtime_stats snapshot;
+#if defined(RAPIDUTF_ENABLE_STATS)
+  snapshot.enabled = true;
+  stat_totals totals {};
+  {
+    stats_registry &shared = registry();
+    const std::lock_guard<std::mutex> lock(shared.mutex);
+    totals = shared.retired;
+    for (const stats_block *block : shared.blocks)
+    {
+      block->add_to(totals);
+    }
+  }
+  for (std::size_t direction = 0; direction < conversion_count; ++direction)
+  {
+    const auto &values = totals.at(direction);
+    conversion_stats &counters = snapshot.conversions.at(direction);
+    counters.calls = values.at(static_cast<std::size_t>(stat::calls));
+    counters.invalid_input = values.at(static_cast<std::size_t>(stat::invalid_input));
+    counters.small_input_bytes = values.at(static_cast<std::size_t>(stat::small_input_bytes));
+    counters.simd_bytes = values.at(static_cast<std::size_t>(stat::simd_bytes));
+    counters.simd_scalar_bytes = values.at(static_cast<std::size_t>(stat::simd_scalar_bytes));
+    counters.scalar_transitions = values.at(static_cast<std::size_t>(stat::scalar_transitions));
+    counters.fallback_bytes = values.at(static_cast<std::size_t>(stat::fallback_bytes));
+  }
+#endif
+  return snapshot;
+}
+
+auto converter::active_backend(conversion direction) -> backend
+{
+  return uses_simd(direction) ? simd_backend : backend::scalar;
+}
+
+auto converter::backend_name(backend kind) -> const char *
+{
+  switch (kind)
+  {
+    case backend::avx2:
+      return "avx2";
+    case backend::neon:
+      return "neon";
+    case backend::scalar:
+      break;
+  }
+  return "scalar";
+}
+
 }  // namespace rapidutf
 
 // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic)
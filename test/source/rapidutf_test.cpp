@@ -1,4 +1,5 @@
 #include <string>
+#include <thread>
 
 #include "rapidutf/rapidutf.hpp"
 
@@ -320,4 +321,1147 @@ TEST_CASE("Long string conversion tests", "[unicode]") {
     REQUIRE(converter::utf32_to_utf8(long_utf32) == long_utf8);
 }
 
+TEST_CASE("Byte order conversion tests", "[unicode]") {
+    using rapidutf::byte_order;
+    using rapidutf::converter;
+
+    const byte_order foreign = byte_order::native == byte_order::little ? byte_order::big : byte_order::little;
+
+    // Long enough to exercise the SIMD blocks as well as the scalar tails
+    std::string utf8;
+    for (int i = 0; i < 20; ++i) {
+        utf8 += u8"Привет, 世界! 😀 ";
+    }
+    std::u16string utf16 = converter::utf8_to_utf16(utf8);
+    std::u32string utf32 = converter::utf8_to_utf32(utf8);
+
+    std::u16string swapped_utf16 = utf16;
+    converter::swap_byte_order(swapped_utf16);
+    std::u32string swapped_utf32 = utf32;
+    converter::swap_byte_order(swapped_utf32);
+
+    REQUIRE(swapped_utf16 != utf16);
+    REQUIRE(swapped_utf32 != utf32);
+    REQUIRE(swapped_utf16[0] == char16_t(0x1F04)); // U+041F with its bytes swapped
+
+    // In place through a pointer, as for caller-owned storage
+    std::u16string unswapped_utf16 = swapped_utf16;
+    converter::swap_byte_order(unswapped_utf16.data(), unswapped_utf16.size());
+    std::u32string unswapped_utf32 = swapped_utf32;
+    converter::swap_byte_order(unswapped_utf32.data(), unswapped_utf32.size());
+    REQUIRE(unswapped_utf16 == utf16);
+    REQUIRE(unswapped_utf32 == utf32);
+
+    // Non-native input
+    REQUIRE(converter::utf16_to_utf8(swapped_utf16, foreign) == utf8);
+    REQUIRE(converter::utf32_to_utf8(swapped_utf32, foreign) == utf8);
+    REQUIRE(converter::utf16_to_utf32(swapped_utf16, foreign, byte_order::native) == utf32);
+    REQUIRE(converter::utf32_to_utf16(swapped_utf32, foreign, byte_order::native) == utf16);
+
+    // Non-native output
+    REQUIRE(converter::utf8_to_utf16(utf8, foreign) == swapped_utf16);
+    REQUIRE(converter::utf8_to_utf32(utf8, foreign) == swapped_utf32);
+    REQUIRE(converter::utf16_to_utf32(utf16, byte_order::native, foreign) == swapped_utf32);
+    REQUIRE(converter::utf32_to_utf16(swapped_utf32, foreign, foreign) == swapped_utf16);
+
+    // Without surrogates whole blocks go through the vector stores, so every length up to a few blocks
+    for (std::size_t length = 0; length < 40; ++length) {
+        std::u32string bmp32;
+        for (std::size_t i = 0; i < length; ++i) {
+            bmp32 += i % 3 == 0 ? U'Ж' : static_cast<char32_t>(U'a' + i % 26);
+        }
+        const std::u16string bmp16(bmp32.begin(), bmp32.end());
+        std::u16string swapped_bmp16 = bmp16;
+        converter::swap_byte_order(swapped_bmp16);
+        std::u32string swapped_bmp32 = bmp32;
+        converter::swap_byte_order(swapped_bmp32);
+
+        REQUIRE(converter::utf16_to_utf32(bmp16, byte_order::native, foreign) == swapped_bmp32);
+        REQUIRE(converter::utf32_to_utf16(bmp32, byte_order::native, foreign) == swapped_bmp16);
+        REQUIRE(converter::utf16_to_utf32(swapped_bmp16, foreign, foreign) == swapped_bmp32);
+
+        std::vector<char16_t> buffer16(length);
+        std::vector<char32_t> buffer32(length);
+        REQUIRE(converter::utf32_to_utf16(bmp32, buffer16.data(), length, byte_order::native, foreign) == length);
+        REQUIRE(converter::utf16_to_utf32(bmp16, buffer32.data(), length, byte_order::native, foreign) == length);
+        REQUIRE(std::u16string(buffer16.begin(), buffer16.end()) == swapped_bmp16);
+        REQUIRE(std::u32string(buffer32.begin(), buffer32.end()) == swapped_bmp32);
+    }
+
+    // Native order behaves like the plain overloads
+    REQUIRE(converter::utf16_to_utf8(utf16, byte_order::native) == utf8);
+    REQUIRE(converter::utf32_to_utf8(utf32, byte_order::native) == utf8);
+
+    // Validation
+    REQUIRE(converter::is_valid_utf16(swapped_utf16, foreign));
+    REQUIRE(converter::is_valid_utf32(swapped_utf32, foreign));
+    REQUIRE(!converter::is_valid_utf32(swapped_utf32, byte_order::native));
+
+    std::u16string lone_surrogate = u"ab";
+    lone_surrogate += char16_t(0x00D8); // 0xD800 with its bytes swapped
+    REQUIRE(!converter::is_valid_utf16(lone_surrogate, foreign));
+    REQUIRE_THROWS_AS(converter::utf16_to_utf8(lone_surrogate, foreign), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf16_to_utf32(lone_surrogate, foreign, byte_order::native), std::runtime_error);
+
+    std::u32string out_of_range = U"abcdefghij";
+    out_of_range += char32_t(0x00001100); // 0x110000 with its bytes swapped
+    REQUIRE_THROWS_AS(converter::utf32_to_utf8(out_of_range, foreign), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf32_to_utf16(out_of_range, foreign, byte_order::native), std::runtime_error);
+}
+
+TEST_CASE("Encoding detection tests", "[unicode]") {
+    using rapidutf::byte_order;
+    using rapidutf::converter;
+    using rapidutf::encoding;
+
+    const auto detect = [](const std::string &bytes) { return converter::detect_encoding(bytes.data(), bytes.size()); };
+    const auto as_bytes16 = [](std::u16string utf16, byte_order order) {
+        if (order != byte_order::native) {
+            converter::swap_byte_order(utf16);
+        }
+        return std::string(reinterpret_cast<const char *>(utf16.data()), utf16.size() * 2);
+    };
+    const auto as_bytes32 = [](std::u32string utf32, byte_order order) {
+        if (order != byte_order::native) {
+            converter::swap_byte_order(utf32);
+        }
+        return std::string(reinterpret_cast<const char *>(utf32.data()), utf32.size() * 4);
+    };
+
+    // Byte order marks
+    REQUIRE(detect("\xEF\xBB\xBF" "abc") == encoding::utf8);
+    REQUIRE(detect(std::string("\xFF\xFE" "a\0", 4)) == encoding::utf16_le);
+    REQUIRE(detect(std::string("\xFE\xFF\0a", 4)) == encoding::utf16_be);
+    REQUIRE(detect(std::string("\xFF\xFE\0\0a\0\0\0", 8)) == encoding::utf32_le);
+    REQUIRE(detect(std::string("\0\0\xFE\xFF\0\0\0a", 8)) == encoding::utf32_be);
+    REQUIRE(converter::bom_length("\xEF\xBB\xBF" "abc", 6) == 3);
+    REQUIRE(converter::bom_length("\xFF\xFE\0\0", 4) == 4);
+    REQUIRE(converter::bom_length("abc", 3) == 0);
+
+    // Heuristics without a byte order mark
+    std::string text;
+    for (int i = 0; i < 40; ++i) {
+        text += u8"Hello, Здравствуй, 世界 😀! ";
+    }
+    std::u16string utf16 = converter::utf8_to_utf16(text);
+    std::u32string utf32 = converter::utf8_to_utf32(text);
+
+    REQUIRE(detect("") == encoding::utf8);
+    REQUIRE(detect("plain ASCII") == encoding::utf8);
+    REQUIRE(detect(text) == encoding::utf8);
+    REQUIRE(detect(as_bytes16(utf16, byte_order::little)) == encoding::utf16_le);
+    REQUIRE(detect(as_bytes16(utf16, byte_order::big)) == encoding::utf16_be);
+    REQUIRE(detect(as_bytes32(utf32, byte_order::little)) == encoding::utf32_le);
+    REQUIRE(detect(as_bytes32(utf32, byte_order::big)) == encoding::utf32_be);
+
+    // Only a bounded prefix is inspected, even when it ends inside a sequence
+    std::string long_text;
+    while (long_text.size() < 10000) {
+        long_text += u8"世界";
+    }
+    REQUIRE(detect(long_text) == encoding::utf8);
+
+    // Neither valid UTF-8 nor a plausible UTF-16/32 layout
+    REQUIRE(detect("\xFF\xFF\xFF") == encoding::unknown);
+}
+
+TEST_CASE("Code point counting tests", "[unicode]") {
+    using rapidutf::converter;
+
+    REQUIRE(converter::count_utf8("") == 0);
+    REQUIRE(converter::count_utf8("Hello, world!") == 13);
+    REQUIRE(converter::count_utf8(u8"こんにちは世界") == 7);
+    REQUIRE(converter::count_utf8(u8"😀😁😂🤣😃😄😅😆") == 8);
+    REQUIRE(converter::count_utf16(u"") == 0);
+    REQUIRE(converter::count_utf16(u"Hello, world!") == 13);
+    REQUIRE(converter::count_utf16(u"😀😁😂🤣😃😄😅😆") == 8);
+
+    // Large enough to fold the SIMD byte counters more than once
+    std::string utf8;
+    while (utf8.size() < 20000) {
+        utf8 += u8"Hello, Здравствуй, 世界 😀! ";
+    }
+    const std::u32string utf32 = converter::utf8_to_utf32(utf8);
+    REQUIRE(converter::count_utf8(utf8) == utf32.size());
+    REQUIRE(converter::count_utf16(converter::utf8_to_utf16(utf8)) == utf32.size());
+
+    // Every tail length after the vector blocks
+    for (std::size_t length = 0; length <= 70; ++length) {
+        const std::string prefix = converter::utf32_to_utf8(utf32.substr(0, length));
+        REQUIRE(converter::count_utf8(prefix) == length);
+        REQUIRE(converter::count_utf16(converter::utf32_to_utf16(utf32.substr(0, length))) == length);
+    }
+}
+
+TEST_CASE("Output length tests", "[unicode]") {
+    using rapidutf::byte_order;
+    using rapidutf::converter;
+
+    REQUIRE(converter::utf16_length_from_utf8("") == 0);
+    REQUIRE(converter::utf8_length_from_utf16(u"") == 0);
+    REQUIRE(converter::utf16_length_from_utf8(u8"aé世😀") == 5);
+    REQUIRE(converter::utf8_length_from_utf16(u"aé世😀") == 10);
+    REQUIRE(converter::utf8_length_from_utf32(U"aé世😀") == 10);
+    REQUIRE(converter::utf16_length_from_utf32(U"aé世😀") == 5);
+
+    std::string utf8;
+    while (utf8.size() < 40000) {
+        utf8 += u8"Hello, Здравствуй, 世界 😀! ";
+    }
+    const std::u32string utf32 = converter::utf8_to_utf32(utf8);
+    const std::u16string utf16 = converter::utf8_to_utf16(utf8);
+    REQUIRE(converter::utf16_length_from_utf8(utf8) == utf16.size());
+    REQUIRE(converter::utf8_length_from_utf16(utf16) == utf8.size());
+    REQUIRE(converter::utf8_length_from_utf32(utf32) == utf8.size());
+    REQUIRE(converter::utf16_length_from_utf32(utf32) == utf16.size());
+
+    // Non-native input gives the same lengths
+    const byte_order other = byte_order::native == byte_order::little ? byte_order::big : byte_order::little;
+    std::u16string swapped16 = utf16;
+    std::u32string swapped32 = utf32;
+    converter::swap_byte_order(swapped16);
+    converter::swap_byte_order(swapped32);
+    REQUIRE(converter::count_utf16(swapped16, other) == utf32.size());
+    REQUIRE(converter::utf8_length_from_utf16(swapped16, other) == utf8.size());
+    REQUIRE(converter::utf8_length_from_utf32(swapped32, other) == utf8.size());
+    REQUIRE(converter::utf16_length_from_utf32(swapped32, other) == utf16.size());
+
+    // Every tail length after the vector blocks
+    for (std::size_t length = 0; length <= 70; ++length) {
+        const std::u32string prefix = utf32.substr(0, length);
+        const std::string prefix8 = converter::utf32_to_utf8(prefix);
+        const std::u16string prefix16 = converter::utf32_to_utf16(prefix);
+        REQUIRE(converter::utf16_length_from_utf8(prefix8) == prefix16.size());
+        REQUIRE(converter::utf8_length_from_utf16(prefix16) == prefix8.size());
+        REQUIRE(converter::utf8_length_from_utf32(prefix) == prefix8.size());
+        REQUIRE(converter::utf16_length_from_utf32(prefix) == prefix16.size());
+    }
+}
+
+TEST_CASE("ASCII detection tests", "[unicode]") {
+    using rapidutf::converter;
+
+    REQUIRE(converter::is_ascii(""));
+    REQUIRE(converter::is_ascii("Hello, world!"));
+    REQUIRE(!converter::is_ascii(u8"Hello, 世界!"));
+    REQUIRE(converter::find_first_non_ascii("Hello, world!") == 13);
+    REQUIRE(converter::find_first_non_ascii(u8"Hello, 世界!") == 7);
+
+    // The first non-ASCII byte is found at every position of the unrolled blocks and tails
+    for (std::size_t position = 0; position < 300; ++position) {
+        std::string text(300, 'a');
+        text[position] = '\x80';
+        REQUIRE(converter::find_first_non_ascii(text) == position);
+        REQUIRE(!converter::is_ascii(text));
+    }
+}
+
+TEST_CASE("ASCII run conversion tests", "[unicode]") {
+    using rapidutf::converter;
+
+    // Lengths around the vector block sizes, with and without non-ASCII text after the run
+    for (std::size_t length : {31U, 32U, 33U, 63U, 64U, 65U, 127U, 128U, 129U, 1000U}) {
+        std::string ascii;
+        for (std::size_t i = 0; i < length; ++i) {
+            ascii += static_cast<char>('a' + i % 26);
+        }
+        const std::u16string ascii16(ascii.begin(), ascii.end());
+        const std::u32string ascii32(ascii.begin(), ascii.end());
+
+        REQUIRE(converter::utf8_to_utf16(ascii) == ascii16);
+        REQUIRE(converter::utf8_to_utf32(ascii) == ascii32);
+        REQUIRE(converter::utf8_to_utf16(ascii + u8"世界" + ascii) == ascii16 + u"世界" + ascii16);
+        REQUIRE(converter::utf8_to_utf32(ascii + u8"世界" + ascii) == ascii32 + U"世界" + ascii32);
+    }
+
+    // Runs large enough for large-input mode, which streams them into caller-owned destinations
+    const std::string large(3 << 20, 'x');
+    const std::u16string large16 = converter::utf8_to_utf16(large + u8"é");
+    const std::u32string large32 = converter::utf8_to_utf32(large + u8"é");
+    REQUIRE(large16.size() == large.size() + 1);
+    REQUIRE(large32.size() == large.size() + 1);
+    REQUIRE(large16.find_first_not_of(u'x') == large.size());
+    REQUIRE(large32.find_first_not_of(U'x') == large.size());
+    REQUIRE(large16.back() == u'é');
+    REQUIRE(large32.back() == U'é');
+    std::vector<char16_t> buffer16(large.size() + 2);
+    std::vector<char32_t> buffer32(large.size() + 2);
+    for (const std::size_t offset : {0U, 1U}) {
+        REQUIRE(converter::utf8_to_utf16(large + u8"é", buffer16.data() + offset, large.size() + 1) == large16.size());
+        REQUIRE(std::u16string(buffer16.data() + offset, large16.size()) == large16);
+        REQUIRE(converter::utf8_to_utf32(large + u8"é", buffer32.data() + offset, large.size() + 1) == large32.size());
+        REQUIRE(std::u32string(buffer32.data() + offset, large32.size()) == large32);
+    }
+    const rapidutf::byte_order foreign = rapidutf::byte_order::native == rapidutf::byte_order::little ? rapidutf::byte_order::big : rapidutf::byte_order::little;
+    REQUIRE(converter::utf8_to_utf16(large, buffer16.data(), large.size(), foreign) == large.size());
+    REQUIRE(std::u16string(buffer16.data(), large.size()) == std::u16string(large.size(), u'\x7800'));
+    REQUIRE(converter::utf8_to_utf32(large, buffer32.data(), large.size(), foreign) == large.size());
+    REQUIRE(std::u32string(buffer32.data(), large.size()) == std::u32string(large.size(), U'\x78000000'));
+
+    // Large inputs also stream ASCII runs after the first non-ASCII character, at every destination alignment
+    std::string mixed;
+    std::u16string mixed16;
+    std::u32string mixed32;
+    for (std::size_t run = 0; mixed.size() < (3 << 20); run += 97) {
+        mixed += u8"é" + std::string(1000 + run % 4096, static_cast<char>('a' + run % 26));
+        mixed16 += u"é" + std::u16string(1000 + run % 4096, static_cast<char16_t>('a' + run % 26));
+        mixed32 += U"é" + std::u32string(1000 + run % 4096, static_cast<char32_t>('a' + run % 26));
+    }
+    REQUIRE(converter::utf8_to_utf16(mixed) == mixed16);
+    REQUIRE(converter::utf8_to_utf32(mixed) == mixed32);
+    buffer16.resize(mixed16.size());
+    buffer32.resize(mixed32.size());
+    REQUIRE(converter::utf8_to_utf16(mixed, buffer16.data(), buffer16.size()) == mixed16.size());
+    REQUIRE(std::u16string(buffer16.begin(), buffer16.end()) == mixed16);
+    REQUIRE(converter::utf8_to_utf32(mixed, buffer32.data(), buffer32.size()) == mixed32.size());
+    REQUIRE(std::u32string(buffer32.begin(), buffer32.end()) == mixed32);
+}
+
+TEST_CASE("Narrowest representation decode tests", "[unicode]") {
+    using rapidutf::char_width;
+    using rapidutf::converter;
+
+    rapidutf::narrow_text text = converter::utf8_to_narrowest("Hello, world!");
+    REQUIRE(text.width == char_width::latin1);
+    REQUIRE(text.latin1 == "Hello, world!");
+
+    text = converter::utf8_to_narrowest("");
+    REQUIRE(text.width == char_width::latin1);
+    REQUIRE(text.latin1.empty());
+
+    text = converter::utf8_to_narrowest(u8"Grüße, café ÿ");
+    REQUIRE(text.width == char_width::latin1);
+    REQUIRE(text.latin1 == "Gr\xFC\xDF" "e, caf\xE9 \xFF");
+
+    text = converter::utf8_to_narrowest(u8"Ā");
+    REQUIRE(text.width == char_width::ucs2);
+    REQUIRE(text.ucs2 == u"Ā");
+
+    // Wide characters far from the start, past the vector blocks and the early-exit checkpoints
+    std::string mixed(5000, 'a');
+    mixed += u8"é";
+    REQUIRE(converter::utf8_to_narrowest(mixed).width == char_width::latin1);
+    mixed += u8"世界";
+    text = converter::utf8_to_narrowest(mixed);
+    REQUIRE(text.width == char_width::ucs2);
+    REQUIRE(text.ucs2 == converter::utf8_to_utf16(mixed));
+    mixed += u8"😀";
+    text = converter::utf8_to_narrowest(mixed);
+    REQUIRE(text.width == char_width::ucs4);
+    REQUIRE(text.ucs4 == converter::utf8_to_utf32(mixed));
+
+    REQUIRE_THROWS_AS(converter::utf8_to_narrowest("\xC3"), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf8_to_narrowest("\xC0\xAF"), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf8_to_narrowest("a\x80"), std::runtime_error);
+}
+
+TEST_CASE("Backend kernel agreement tests", "[unicode]") {
+    using rapidutf::converter;
+
+    std::string utf8;
+    while (utf8.size() < 5000) {
+        utf8 += u8"Hello, world! Здравствуй, 世界 😀 café ";
+    }
+    const std::u16string utf16 = converter::utf8_to_utf16(utf8);
+    const std::u32string utf32 = converter::utf8_to_utf32(utf8);
+
+    const auto tables = rapidutf::detail::kernel_tables();
+    REQUIRE(!tables.empty());
+    REQUIRE(std::string(tables.back().backend) == "fallback");
+    for (const auto& kernels : tables) {
+        INFO(kernels.backend);
+        // Every prefix length up to a few vector blocks, then the whole text
+        for (std::size_t length = 0; length <= utf32.size(); length += (length < 80 ? 1 : 997)) {
+            const std::u32string text32 = utf32.substr(0, length);
+            const std::string text8 = converter::utf32_to_utf8(text32);
+            const std::u16string text16 = converter::utf32_to_utf16(text32);
+            REQUIRE(kernels.utf8_to_utf16(text8) == text16);
+            REQUIRE(kernels.utf16_to_utf8(text16) == text8);
+            REQUIRE(kernels.utf16_to_utf32(text16) == text32);
+            REQUIRE(kernels.utf32_to_utf16(text32) == text16);
+            REQUIRE(kernels.utf8_to_utf32(text8) == text32);
+            REQUIRE(kernels.utf32_to_utf8(text32) == text8);
+            REQUIRE(kernels.count_utf8(text8) == length);
+            REQUIRE(kernels.count_utf16(text16) == length);
+            REQUIRE(kernels.find_first_non_ascii(text8) == converter::find_first_non_ascii(text8));
+        }
+        // A two-byte character and a surrogate pair at every lane of the first vector blocks
+        for (std::size_t position = 0; position < 40; ++position) {
+            const std::u32string text32 = std::u32string(position, U'a') + U"Ж😀" + std::u32string(40, U'z');
+            const std::string text8 = std::string(position, 'a') + u8"Ж😀" + std::string(40, 'z');
+            const std::u16string text16 = std::u16string(position, u'a') + u"Ж😀" + std::u16string(40, u'z');
+            INFO("position " << position);
+            REQUIRE(kernels.utf8_to_utf16(text8) == text16);
+            REQUIRE(kernels.utf16_to_utf8(text16) == text8);
+            REQUIRE(kernels.utf16_to_utf32(text16) == text32);
+            REQUIRE(kernels.utf32_to_utf16(text32) == text16);
+            REQUIRE(kernels.utf8_to_utf32(text8) == text32);
+            REQUIRE(kernels.utf32_to_utf8(text32) == text8);
+        }
+        // Every kernel rejects the same input, wherever it falls
+        for (const std::size_t position : {0U, 5U, 15U, 31U, 70U}) {
+            INFO("position " << position);
+            const std::string text8(position, 'a');
+            const std::u16string text16(position, u'a');
+            const std::u32string text32(position, U'a');
+            for (const char* sequence : {"\xED\xA0\x80", "\xF4\x90\x80\x80", "\xC0\x80", "\x80", "\xE4\xB8"}) {
+                REQUIRE_THROWS_AS(kernels.utf8_to_utf16(text8 + sequence + text8), std::runtime_error);
+                REQUIRE_THROWS_AS(kernels.utf8_to_utf32(text8 + sequence + text8), std::runtime_error);
+            }
+            for (const char16_t unit : {u'\xD800', u'\xDBFF', u'\xDC00', u'\xDFFF'}) {
+                REQUIRE_THROWS_AS(kernels.utf16_to_utf8(text16 + unit + text16), std::runtime_error);
+                REQUIRE_THROWS_AS(kernels.utf16_to_utf32(text16 + unit + text16), std::runtime_error);
+            }
+            for (const char32_t unit : {U'\xD800', U'\xDFFF', U'\x110000', U'\xFFFFFFFF'}) {
+                REQUIRE_THROWS_AS(kernels.utf32_to_utf16(text32 + unit + text32), std::runtime_error);
+                REQUIRE_THROWS_AS(kernels.utf32_to_utf8(text32 + unit + text32), std::runtime_error);
+            }
+        }
+    }
+}
+
+TEST_CASE("Short input tests", "[unicode]") {
+    using rapidutf::converter;
+
+    // Values at the edges of the direct widening and narrowing paths
+    REQUIRE(converter::utf16_to_utf32(u"\u007F\uD7FF") == U"\u007F\uD7FF");
+    REQUIRE(converter::utf32_to_utf16(U"\u007F\uD7FF") == u"\u007F\uD7FF");
+    REQUIRE(converter::utf16_to_utf8(u"\u007F\u0080") == u8"\u007F\u0080");
+    REQUIRE(converter::utf32_to_utf8(U"\u007F\u0080") == u8"\u007F\u0080");
+    REQUIRE(converter::utf8_to_utf16(std::string("abc\0def", 7)) == std::u16string(u"abc\0def", 7));
+
+    // Invalid short input still throws
+    REQUIRE_THROWS_AS(converter::utf8_to_utf16("ab\x80"), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf8_to_utf32("\xE4\xB8"), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf16_to_utf8(std::u16string(1, static_cast<char16_t>(0xD800))), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf16_to_utf32(std::u16string(1, static_cast<char16_t>(0xDC00))), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf32_to_utf8(std::u32string(1, static_cast<char32_t>(0x110000))), std::runtime_error);
+
+    // Every length across the short input limit, ASCII and not
+    for (std::size_t length = 0; length <= 80; ++length) {
+        const std::u32string ascii(length, U'a');
+        const std::u32string mixed = std::u32string(length, U'\u00E9') + U"\U0001F600";
+        for (const std::u32string& utf32 : {ascii, mixed}) {
+            const std::string utf8 = converter::utf32_to_utf8(utf32);
+            const std::u16string utf16 = converter::utf32_to_utf16(utf32);
+            REQUIRE(converter::utf8_to_utf32(utf8) == utf32);
+            REQUIRE(converter::utf8_to_utf16(utf8) == utf16);
+            REQUIRE(converter::utf16_to_utf8(utf16) == utf8);
+            REQUIRE(converter::utf16_to_utf32(utf16) == utf32);
+            REQUIRE(converter::utf8_to_utf16(utf8, rapidutf::byte_order::big) == converter::utf32_to_utf16(utf32, rapidutf::byte_order::native, rapidutf::byte_order::big));
+        }
+    }
+}
+
+TEST_CASE("Buffer reuse tests", "[unicode]") {
+    using rapidutf::converter;
+
+    const std::u32string long_text = std::u32string(100, U'x') + U"\u00E9\u4E2D\U0001F600" + std::u32string(50, U'\u0416');
+    const std::u32string short_text = U"a\u00E9\U0001F600";
+    const std::string utf8 = converter::utf32_to_utf8(long_text);
+    const std::u16string utf16 = converter::utf32_to_utf16(long_text);
+
+    // Conversions into a buffer match the allocating API
+    std::u16string utf16_out;
+    std::string utf8_out;
+    std::u32string utf32_out;
+    converter::utf8_to_utf16(utf8, utf16_out);
+    REQUIRE(utf16_out == utf16);
+    converter::utf16_to_utf8(utf16, utf8_out);
+    REQUIRE(utf8_out == utf8);
+    converter::utf16_to_utf32(utf16, utf32_out);
+    REQUIRE(utf32_out == long_text);
+    converter::utf8_to_utf32(utf8, utf32_out);
+    REQUIRE(utf32_out == long_text);
+    converter::utf32_to_utf8(long_text, utf8_out);
+    REQUIRE(utf8_out == utf8);
+    converter::utf32_to_utf16(long_text, utf16_out);
+    REQUIRE(utf16_out == utf16);
+
+    // Previous contents are replaced and the capacity is kept
+    const std::size_t capacity = utf16_out.capacity();
+    const auto *data = utf16_out.data();
+    converter::utf8_to_utf16(converter::utf32_to_utf8(short_text), utf16_out);
+    REQUIRE(utf16_out == converter::utf32_to_utf16(short_text));
+    REQUIRE(utf16_out.capacity() == capacity);
+    REQUIRE(utf16_out.data() == data);
+    converter::utf8_to_utf16(utf8, utf16_out);
+    REQUIRE(utf16_out == utf16);
+    REQUIRE(utf16_out.data() == data);
+
+    // Byte order arguments behave like the allocating variants
+    converter::utf8_to_utf16(utf8, utf16_out, rapidutf::byte_order::big);
+    REQUIRE(utf16_out == converter::utf8_to_utf16(utf8, rapidutf::byte_order::big));
+    converter::utf16_to_utf8(utf16_out, utf8_out, rapidutf::byte_order::big);
+    REQUIRE(utf8_out == utf8);
+    converter::utf32_to_utf16(long_text, utf16_out, rapidutf::byte_order::native, rapidutf::byte_order::big);
+    converter::utf16_to_utf32(utf16_out, utf32_out, rapidutf::byte_order::big, rapidutf::byte_order::native);
+    REQUIRE(utf32_out == long_text);
+
+    REQUIRE_THROWS_AS(converter::utf8_to_utf16(utf8 + "\x80", utf16_out), std::runtime_error);
+}
+
+TEST_CASE("Runtime statistics tests", "[unicode]") {
+    using rapidutf::converter;
+    using rapidutf::conversion;
+
+    const rapidutf::runtime_stats before = converter::stats();
+    const std::string short_text = "short";
+    const std::string long_text = std::string(200, 'a') + "\xC3\xA9" + std::string(200, 'b');
+    static_cast<void>(converter::utf8_to_utf16(short_text));
+    static_cast<void>(converter::utf8_to_utf16(long_text));
+    REQUIRE_THROWS_AS(converter::utf8_to_utf16(long_text + "\x80"), std::runtime_error);
+    const rapidutf::runtime_stats after = converter::stats();
+
+    REQUIRE(after.enabled == before.enabled);
+    const auto& first = before[conversion::utf8_to_utf16];
+    const auto& last = after[conversion::utf8_to_utf16];
+    if (!after.enabled) {
+        REQUIRE(last.calls == 0);
+        REQUIRE(last.small_input_bytes == 0);
+        return;
+    }
+
+    REQUIRE(last.calls - first.calls == 3);
+    REQUIRE(last.invalid_input - first.invalid_input == 1);
+    REQUIRE(last.small_input_bytes - first.small_input_bytes == short_text.size());
+    const auto kernel_bytes = (last.simd_bytes - first.simd_bytes) + (last.fallback_bytes - first.fallback_bytes);
+    REQUIRE(kernel_bytes == 2 * long_text.size() + 1);
+    REQUIRE(last.simd_scalar_bytes - first.simd_scalar_bytes <= last.simd_bytes - first.simd_bytes);
+
+    // Counts of exited threads are kept
+    std::thread([] { static_cast<void>(converter::utf16_to_utf8(u"thread")); }).join();
+    REQUIRE(converter::stats()[conversion::utf16_to_utf8].calls == after[conversion::utf16_to_utf8].calls + 1);
+}
+
+TEST_CASE("Backend selection tests", "[unicode]") {
+    using rapidutf::converter;
+    using rapidutf::backend;
+    using rapidutf::conversion;
+
+    const conversion directions[] = {conversion::utf8_to_utf16,  conversion::utf16_to_utf8, conversion::utf16_to_utf32,
+                                     conversion::utf32_to_utf16, conversion::utf8_to_utf32, conversion::utf32_to_utf8};
+    for (const conversion direction : directions) {
+        const backend kind = converter::active_backend(direction);
+        REQUIRE(converter::active_backend(direction) == kind);
+        const std::string name = converter::backend_name(kind);
+        REQUIRE((name == "scalar" || name == "avx2" || name == "neon"));
+    }
+    REQUIRE(std::string(converter::backend_name(backend::scalar)) == "scalar");
+    REQUIRE(std::string(converter::backend_name(backend::avx2)) == "avx2");
+    REQUIRE(std::string(converter::backend_name(backend::neon)) == "neon");
+
+    // Whichever backend is active, results match the portable kernels
+    const std::string utf8 = std::string(100, 'a') + "\xD0\x96\xE4\xB8\xAD\xF0\x9F\x98\x80" + std::string(100, 'z');
+    REQUIRE(converter::utf16_to_utf8(converter::utf8_to_utf16(utf8)) == utf8);
+    REQUIRE(converter::utf32_to_utf8(converter::utf8_to_utf32(utf8)) == utf8);
+    REQUIRE(converter::count_utf8(utf8) == 203);
+
+    // and so does what they reject, short or long
+    for (const std::size_t prefix : {0U, 70U}) {
+        INFO("prefix " << prefix);
+        REQUIRE_THROWS_AS(converter::utf8_to_utf16(std::string(prefix, 'a') + "\xED\xA0\x80"), std::runtime_error);
+        REQUIRE_THROWS_AS(converter::utf8_to_utf32(std::string(prefix, 'a') + "\xF4\x90\x80\x80"), std::runtime_error);
+        REQUIRE_THROWS_AS(converter::utf16_to_utf8(std::u16string(prefix, u'a') + u'\xDC00'), std::runtime_error);
+        REQUIRE_THROWS_AS(converter::utf16_to_utf32(std::u16string(prefix, u'a') + u'\xD800'), std::runtime_error);
+        REQUIRE_THROWS_AS(converter::utf32_to_utf16(std::u32string(prefix, U'a') + U'\xD800'), std::runtime_error);
+        REQUIRE_THROWS_AS(converter::utf32_to_utf8(std::u32string(prefix, U'a') + U'\xDFFF'), std::runtime_error);
+        REQUIRE_THROWS_AS(converter::utf32_to_utf16(std::u32string(prefix, U'a') + U'\x110000'), std::runtime_error);
+    }
+}
+
+TEST_CASE("UTF-8 decoder state machine tests", "[unicode]") {
+    using rapidutf::converter;
+
+    // Every scalar value round trips, alone and after an ASCII prefix that puts it at the end of a SIMD block
+    std::string utf8;
+    std::u32string utf32;
+    for (char32_t cp = 0; cp <= 0x10FFFF; cp += (cp < 0x1000 ? 1 : 7)) {
+        if (cp >= 0xD800 && cp <= 0xDFFF) {
+            continue;
+        }
+        utf32 += cp;
+    }
+    utf8 = converter::utf32_to_utf8(utf32);
+    REQUIRE(converter::is_valid_utf8(utf8));
+    REQUIRE(converter::utf8_to_utf32(utf8) == utf32);
+    REQUIRE(converter::utf8_to_utf16(utf8) == converter::utf32_to_utf16(utf32));
+
+    // Overlong forms, encoded surrogates, values past U+10FFFF, stray and missing continuation bytes
+    const char* invalid[] = {"\xC0\x80", "\xC1\xBF", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xED\xBF\xBF", "\xF0\x8F\xBF\xBF",
+                             "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xFF", "\x80", "\xE4\xB8", "\xF0\x9F\x98", "\xE4\x41\x80"};
+    for (const char* sequence : invalid) {
+        for (const std::size_t prefix : {0U, 1U, 31U, 40U, 200U}) {
+            const std::string text = std::string(prefix, 'a') + sequence + "bc";
+            INFO("prefix " << prefix << ", sequence " << sequence);
+            REQUIRE(!converter::is_valid_utf8(text));
+            REQUIRE_THROWS_AS(converter::utf8_to_utf16(text), std::runtime_error);
+            REQUIRE_THROWS_AS(converter::utf8_to_utf32(text), std::runtime_error);
+        }
+    }
+
+    // Boundary code points of each sequence length are accepted
+    REQUIRE(converter::utf8_to_utf32("\xC2\x80\xDF\xBF\xE0\xA0\x80\xED\x9F\xBF\xEE\x80\x80\xF0\x90\x80\x80\xF4\x8F\xBF\xBF") ==
+            U"\u0080\u07FF\u0800\uD7FF\uE000\U00010000\U0010FFFF");
+}
+
+TEST_CASE("Word-at-a-time scan tests", "[unicode]") {
+    using rapidutf::byte_order;
+    using rapidutf::char_width;
+    using rapidutf::converter;
+
+    const byte_order foreign = byte_order::native == byte_order::little ? byte_order::big : byte_order::little;
+
+    // Each kind of character at every offset of a 64-bit word, inside ASCII runs longer than a word
+    const std::u32string characters = U"\u00E9\u0100\u4E2D\U0001F600";
+    for (const char32_t character : characters) {
+        for (std::size_t offset = 0; offset < 20; ++offset) {
+            const std::u32string utf32 = std::u32string(offset, U'a') + character + std::u32string(19 - offset, U'b');
+            const std::string utf8 = converter::utf32_to_utf8(utf32);
+            const std::u16string utf16 = converter::utf32_to_utf16(utf32);
+            std::u16string swapped16 = utf16;
+            std::u32string swapped32 = utf32;
+            converter::swap_byte_order(swapped16);
+            converter::swap_byte_order(swapped32);
+
+            REQUIRE(converter::count_utf8(utf8) == utf32.size());
+            REQUIRE(converter::count_utf16(utf16) == utf32.size());
+            REQUIRE(converter::count_utf16(swapped16, foreign) == utf32.size());
+            REQUIRE(converter::utf16_length_from_utf8(utf8) == utf16.size());
+            REQUIRE(converter::find_first_non_ascii(utf8) == offset);
+            REQUIRE(converter::utf16_to_utf8(swapped16, foreign) == utf8);
+            REQUIRE(converter::utf32_to_utf8(swapped32, foreign) == utf8);
+
+            const char_width width = converter::utf8_to_narrowest(utf8).width;
+            REQUIRE(width == (character < 0x100 ? char_width::latin1 : character < 0x10000 ? char_width::ucs2 : char_width::ucs4));
+        }
+    }
+}
+
+TEST_CASE("Vector tail tests", "[unicode]") {
+    using rapidutf::byte_order;
+    using rapidutf::char_width;
+    using rapidutf::converter;
+
+    const byte_order foreign = byte_order::native == byte_order::little ? byte_order::big : byte_order::little;
+
+    // Every tail length of a 32-byte register, with one character at the end, in the block overlapping the tail or at
+    // the start, and the rest ASCII
+    const std::u32string characters = U"a\u00E9\u0100\u4E2D\U0001F600";
+    for (const char32_t character : characters) {
+        for (std::size_t length = 1; length < 100; ++length) {
+            for (const std::size_t position : {length - 1, length > 20 ? length - 20 : 0, std::size_t{0}}) {
+                std::u32string utf32(length, U'x');
+                utf32[position] = character;
+                const std::string utf8 = converter::utf32_to_utf8(utf32);
+                const std::u16string utf16 = converter::utf32_to_utf16(utf32);
+                std::u16string swapped16 = utf16;
+                std::u32string swapped32 = utf32;
+                converter::swap_byte_order(swapped16);
+                converter::swap_byte_order(swapped32);
+                INFO("length " << length << ", position " << position << ", character " << static_cast<uint32_t>(character));
+
+                REQUIRE(converter::count_utf8(utf8) == length);
+                REQUIRE(converter::count_utf16(swapped16, foreign) == length);
+                REQUIRE(converter::utf16_length_from_utf8(utf8) == utf16.size());
+                REQUIRE(converter::utf8_length_from_utf16(swapped16, foreign) == utf8.size());
+                REQUIRE(converter::utf8_length_from_utf32(swapped32, foreign) == utf8.size());
+                REQUIRE(converter::utf16_length_from_utf32(swapped32, foreign) == utf16.size());
+                REQUIRE(converter::find_first_non_ascii(utf8) == (character < 0x80 ? utf8.size() : position));
+
+                const char_width width = converter::utf8_to_narrowest(utf8).width;
+                REQUIRE(width == (character < 0x100 ? char_width::latin1 : character < 0x10000 ? char_width::ucs2 : char_width::ucs4));
+
+                REQUIRE(converter::utf8_to_utf16(utf8) == utf16);
+                REQUIRE(converter::utf8_to_utf32(utf8) == utf32);
+                REQUIRE(converter::utf16_to_utf8(swapped16, foreign) == utf8);
+                REQUIRE(converter::utf16_to_utf32(swapped16, foreign, byte_order::native) == utf32);
+                REQUIRE(converter::utf32_to_utf8(swapped32, foreign) == utf8);
+                REQUIRE(converter::utf32_to_utf16(swapped32, foreign, byte_order::native) == utf16);
+            }
+        }
+    }
+
+    // Errors in the tail are still reported
+    REQUIRE_THROWS_AS(converter::utf16_to_utf32(std::u16string(70, u'x') + u'\xD800'), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf32_to_utf16(std::u32string(70, U'x') + static_cast<char32_t>(0x110000)), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf32_to_utf8(std::u32string(70, U'x') + static_cast<char32_t>(0x110000)), std::runtime_error);
+}
+
+TEST_CASE("Inline short input tests", "[unicode]") {
+    using rapidutf::converter;
+
+    // Value-returning overloads take the header path for short inputs; they must agree with the library path
+    const std::u32string samples[] = {U"a", U"~", U"\u00E9", U"\u07FF", U"\uD7FF", U"\uE000", U"\U0001F600"};
+    for (std::size_t length = 0; length <= 20; ++length) {
+        for (const std::u32string& sample : samples) {
+            std::u32string utf32(length, U'x');
+            if (length != 0) {
+                utf32.replace(length - 1, 1, sample);
+            }
+            std::string utf8;
+            std::u16string utf16;
+            converter::utf32_to_utf8(utf32, utf8);
+            converter::utf32_to_utf16(utf32, utf16);
+            REQUIRE(converter::utf32_to_utf8(utf32) == utf8);
+            REQUIRE(converter::utf32_to_utf16(utf32) == utf16);
+            REQUIRE(converter::utf8_to_utf16(utf8) == utf16);
+            REQUIRE(converter::utf8_to_utf32(utf8) == utf32);
+            REQUIRE(converter::utf16_to_utf8(utf16) == utf8);
+            REQUIRE(converter::utf16_to_utf32(utf16) == utf32);
+        }
+    }
+
+    REQUIRE_THROWS_AS(converter::utf8_to_utf16("ab\x80"), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf8_to_utf32("\xC3"), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf16_to_utf8(std::u16string(1, char16_t(0xD800))), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf16_to_utf32(std::u16string(1, char16_t(0xDC00))), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf32_to_utf8(std::u32string(1, char32_t(0x110000))), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf32_to_utf16(std::u32string(1, char32_t(0x110000))), std::runtime_error);
+}
+
+TEST_CASE("Compile-time literal tests", "[unicode]") {
+    using rapidutf::converter;
+
+    constexpr auto utf16 = RAPIDUTF_UTF16_LITERAL("h\xC3\xA9llo \xE4\xB8\xAD \xF0\x9F\x98\x80");
+    constexpr auto utf32 = RAPIDUTF_UTF32_LITERAL("h\xC3\xA9llo \xE4\xB8\xAD \xF0\x9F\x98\x80");
+    static_assert(utf16.size() == 10 && utf16[1] == 0xE9 && utf16[8] == 0xD83D && utf16[9] == 0xDE00);
+    static_assert(utf32.size() == 9 && utf32[6] == 0x4E2D && utf32[8] == 0x1F600);
+    static_assert(RAPIDUTF_UTF16_LITERAL("").empty());
+    static_assert(converter::utf16_length_of("\xF4\x8F\xBF\xBF") == 2 && converter::utf32_length_of("\xF4\x8F\xBF\xBF") == 1);
+
+    const std::string text = "h\xC3\xA9llo \xE4\xB8\xAD \xF0\x9F\x98\x80";
+    REQUIRE(std::u16string(utf16.begin(), utf16.end()) == converter::utf8_to_utf16(text));
+    REQUIRE(std::u32string(utf32.begin(), utf32.end()) == converter::utf8_to_utf32(text));
+
+    // Outside constant expressions the same functions throw like the other conversions
+    const std::string invalid[] = {"\x80", "\xC3", "\xC0\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xE4\xB8", "\xC3("};
+    for (const std::string& input : invalid) {
+        REQUIRE_THROWS_AS(converter::utf16_length_of(input), std::runtime_error);
+        REQUIRE_THROWS_AS(converter::utf32_length_of(input), std::runtime_error);
+        REQUIRE_THROWS_AS(converter::utf8_to_utf16(input), std::runtime_error);
+    }
+    REQUIRE_THROWS_AS(converter::utf8_to_utf16_array<2>("abc"), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf8_to_utf16_array<4>("abc"), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf8_to_utf16_array<1>("\xF0\x9F\x98\x80"), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf8_to_utf32_array<2>("abc"), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::utf8_to_utf32_array<4>("abc"), std::runtime_error);
+}
+
+TEST_CASE("Generic transcode tests", "[unicode]") {
+    using rapidutf::converter;
+
+    const std::string utf8 = "h\xC3\xA9llo \xE4\xB8\xAD \xF0\x9F\x98\x80 " + std::string(100, 'a');
+    const std::u16string utf16 = converter::utf8_to_utf16(utf8);
+    const std::u32string utf32 = converter::utf8_to_utf32(utf8);
+
+    // Containers are sized by the length functions and written by the kernels in place; wchar_t ones get a copy
+    std::u16string to_string;
+    converter::transcode<char, char16_t>(utf8, to_string);
+    REQUIRE(to_string == utf16);
+    std::vector<char16_t> to_vector;
+    converter::transcode<char, char16_t>(std::vector<char>(utf8.begin(), utf8.end()), to_vector);
+    REQUIRE(std::u16string(to_vector.begin(), to_vector.end()) == utf16);
+    std::vector<char> from_utf32;
+    converter::transcode<char32_t, char>(std::u32string_view(utf32), from_utf32);
+    REQUIRE(std::string(from_utf32.begin(), from_utf32.end()) == utf8);
+    std::wstring wide;
+    converter::transcode<char, wchar_t>(utf8, wide);
+    REQUIRE(wide == converter::utf8_to_wide(utf8));
+    std::u32string from_wide;
+    converter::transcode<wchar_t, char32_t>(wide, from_wide);
+    REQUIRE(from_wide == utf32);
+    std::string same;
+    converter::transcode<char, char>(utf8, same);
+    REQUIRE(same == utf8);
+
+    // Output iterators take the scalar path
+    std::vector<char> appended{'>'};
+    converter::transcode<char16_t, char>(utf16, std::back_inserter(appended));
+    REQUIRE(std::string(appended.begin() + 1, appended.end()) == utf8);
+    std::array<char16_t, 256> fixed{};
+    char16_t* end = converter::transcode<char32_t, char16_t>(utf32, fixed.data());
+    REQUIRE(std::u16string(fixed.data(), end) == utf16);
+    std::u32string iterated;
+    converter::transcode<char16_t, char32_t>(utf16, std::back_inserter(iterated));
+    REQUIRE(iterated == utf32);
+
+    const std::string invalid = "ab\xC3(";
+    std::u16string unused;
+    REQUIRE_THROWS_AS((converter::transcode<char, char16_t>(invalid, unused)), std::runtime_error);
+    REQUIRE_THROWS_AS((converter::transcode<char, char>(invalid, same)), std::runtime_error);
+    REQUIRE_THROWS_AS((converter::transcode<char, char16_t>(std::string("a\x80\x80\x80\x80"), to_vector)), std::runtime_error);
+    REQUIRE_THROWS_AS((converter::transcode<char, char32_t>(invalid, std::back_inserter(iterated))), std::runtime_error);
+    const std::u16string lone(1, char16_t(0xDC00));
+    REQUIRE_THROWS_AS((converter::transcode<char16_t, char>(lone, std::back_inserter(appended))), std::runtime_error);
+    const std::u32string out_of_range(1, char32_t(0x110000));
+    REQUIRE_THROWS_AS((converter::transcode<char32_t, char16_t>(out_of_range, std::back_inserter(to_vector))), std::runtime_error);
+}
+
+TEST_CASE("Code point view tests", "[unicode]") {
+    using rapidutf::converter;
+
+    const std::u32string pieces[] = {U"a", U"\u00E9", U"\u4E2D", U"\U0001F600"};
+    std::u32string utf32;
+    for (std::size_t i = 0; i < 700; ++i) {
+        utf32 += pieces[(i * 7 + i / 50) % 4];
+    }
+    const std::string utf8 = converter::utf32_to_utf8(utf32);
+    const std::u16string utf16 = converter::utf32_to_utf16(utf32);
+
+    REQUIRE(std::u32string(converter::utf8_codepoints(utf8).begin(), converter::utf8_codepoints(utf8).end()) == utf32);
+    std::u32string decoded;
+    for (const char32_t code_point : converter::utf16_codepoints(utf16)) {
+        decoded += code_point;
+    }
+    REQUIRE(decoded == utf32);
+
+    const auto utf8_view = converter::utf8_codepoints(utf8);
+    const auto utf16_view = converter::utf16_codepoints(utf16);
+    for (const std::size_t n : {0U, 1U, 2U, 63U, 64U, 65U, 100U, 333U, 699U}) {
+        const std::size_t utf8_offset = converter::utf32_to_utf8(utf32.substr(0, n)).size();
+        const std::size_t utf16_offset = converter::utf32_to_utf16(utf32.substr(0, n)).size();
+        REQUIRE(converter::skip_code_points(utf8, n) == utf8_offset);
+        REQUIRE(converter::skip_code_points(utf16, n) == utf16_offset);
+        REQUIRE(*utf8_view.begin().next(n) == utf32[n]);
+        REQUIRE(utf16_view.begin().next(n).offset() == utf16_offset);
+
+        const auto slice = utf8_view.subview(n, 80);
+        REQUIRE(std::u32string(slice.begin(), slice.end()) == utf32.substr(n, 80));
+        const auto tail = utf16_view.subview(n);
+        REQUIRE(std::u32string(tail.begin(), tail.end()) == utf32.substr(n));
+    }
+    REQUIRE(converter::skip_code_points(utf8, 5000) == utf8.size());
+    REQUIRE(converter::skip_code_points(utf16, 5000) == utf16.size());
+    REQUIRE(utf8_view.begin().next(700) == utf8_view.end());
+    REQUIRE(converter::utf8_codepoints("").begin() == converter::utf8_codepoints("").end());
+
+    // Iterating is lazy: the error surfaces at the invalid sequence, not before
+    const std::string invalid = "ab\xC3(";
+    auto it = converter::utf8_codepoints(invalid).begin();
+    REQUIRE(*it++ == U'a');
+    REQUIRE(*it++ == U'b');
+    REQUIRE_THROWS_AS(*it, std::runtime_error);
+}
+
+TEST_CASE("Code point offset index tests", "[unicode]") {
+    using rapidutf::converter;
+
+    const std::u32string pieces[] = {U"a", U"\u00E9", U"\u4E2D", U"\U0001F600"};
+    std::u32string utf32;
+    for (std::size_t i = 0; i < 3000; ++i) {
+        utf32 += pieces[(i * 7 + i / 90) % 4];
+    }
+    const std::string utf8 = converter::utf32_to_utf8(utf32);
+
+    // Reference: byte offset of every code point, and the code point each byte offset rounds up to
+    std::vector<std::size_t> offsets;
+    std::vector<std::size_t> indexes;
+    for (std::size_t i = 0; i < utf8.size(); ++i) {
+        if ((static_cast<unsigned char>(utf8[i]) & 0xC0U) != 0x80U) {
+            offsets.push_back(i);
+        }
+        indexes.push_back(offsets.size() - ((static_cast<unsigned char>(utf8[i]) & 0xC0U) != 0x80U ? 1 : 0));
+    }
+    indexes.push_back(offsets.size());
+
+    for (const std::size_t stride : {1U, 7U, 64U, 100U, 1024U, 5000U}) {
+        const rapidutf::utf8_offset_index index(utf8, stride);
+        REQUIRE(index.size() == utf32.size());
+        for (std::size_t cp = 0; cp < offsets.size(); cp += 13) {
+            REQUIRE(index.byte_offset(cp) == offsets[cp]);
+        }
+        REQUIRE(index.byte_offset(utf32.size()) == utf8.size());
+        REQUIRE(index.byte_offset(utf32.size() + 10) == utf8.size());
+        for (std::size_t byte = 0; byte <= utf8.size(); byte += 11) {
+            REQUIRE(index.code_point_index(byte) == indexes[byte]);
+        }
+        REQUIRE(index.code_point_index(utf8.size() + 10) == utf32.size());
+
+        // Appending in pieces, with the text moving between calls, gives the same answers as a fresh index
+        std::string grown = utf8.substr(0, 1000);
+        rapidutf::utf8_offset_index appended(grown, stride);
+        for (const std::size_t end : {std::size_t{1001}, std::size_t{2500}, std::size_t{2503}, std::size_t{7000}, utf8.size()}) {
+            grown = utf8.substr(0, end);
+            appended.append(grown);
+            REQUIRE(appended.size() == converter::count_utf8(grown));
+        }
+        for (std::size_t cp = 0; cp < offsets.size(); cp += 97) {
+            REQUIRE(appended.byte_offset(cp) == offsets[cp]);
+            REQUIRE(appended.code_point_index(offsets[cp]) == cp);
+        }
+    }
+
+    REQUIRE(rapidutf::utf8_offset_index("").size() == 0);
+    REQUIRE(rapidutf::utf8_offset_index("").byte_offset(3) == 0);
+    REQUIRE_THROWS_AS(rapidutf::utf8_offset_index(utf8, 0), std::runtime_error);
+    rapidutf::utf8_offset_index shrinking(utf8);
+    REQUIRE_THROWS_AS(shrinking.append(std::string_view(utf8).substr(1)), std::runtime_error);
+}
+
+TEST_CASE("Offset translation tests", "[unicode]") {
+    using rapidutf::converter;
+    using rapidutf::offset_unit;
+
+    const std::u32string pieces[] = {U"a", U"\u00E9", U"\u4E2D", U"\U0001F600"};
+    std::u32string utf32;
+    for (std::size_t i = 0; i < 2000; ++i) {
+        utf32 += pieces[(i * 7 + i / 60) % 4];
+    }
+    const std::string utf8 = converter::utf32_to_utf8(utf32);
+
+    // Reference positions of every code point boundary, and for every byte and UTF-16 offset the boundary it rounds up to
+    std::vector<std::array<std::size_t, 3>> boundaries{{0, 0, 0}};
+    std::vector<std::size_t> byte_boundary;
+    std::vector<std::size_t> utf16_boundary;
+    for (const char32_t code_point : utf32) {
+        auto next = boundaries.back();
+        next[0] += code_point < 0x80 ? 1 : code_point < 0x800 ? 2 : code_point < 0x10000 ? 3 : 4;
+        next[1] += code_point < 0x10000 ? 1 : 2;
+        next[2] += 1;
+        while (byte_boundary.size() < next[0]) {
+            byte_boundary.push_back(boundaries.size() - (byte_boundary.size() == boundaries.back()[0] ? 1 : 0));
+        }
+        while (utf16_boundary.size() < next[1]) {
+            utf16_boundary.push_back(boundaries.size() - (utf16_boundary.size() == boundaries.back()[1] ? 1 : 0));
+        }
+        boundaries.push_back(next);
+    }
+    byte_boundary.push_back(boundaries.size() - 1);
+    utf16_boundary.push_back(boundaries.size() - 1);
+
+    const offset_unit units[] = {offset_unit::utf8, offset_unit::utf16, offset_unit::code_point};
+    const rapidutf::utf8_offset_index index(utf8, 100);
+    for (std::size_t cp = 0; cp < boundaries.size(); cp += 7) {
+        for (std::size_t from = 0; from < 3; ++from) {
+            for (std::size_t to = 0; to < 3; ++to) {
+                REQUIRE(converter::translate_offset(utf8, boundaries[cp][from], units[from], units[to]) == boundaries[cp][to]);
+                REQUIRE(index.translate(boundaries[cp][from], units[from], units[to]) == boundaries[cp][to]);
+            }
+        }
+    }
+
+    // Positions inside a sequence or a surrogate pair round up, positions past the end clamp
+    for (std::size_t byte = 0; byte < byte_boundary.size(); byte += 5) {
+        REQUIRE(converter::translate_offset(utf8, byte, offset_unit::utf8, offset_unit::utf16) == boundaries[byte_boundary[byte]][1]);
+        REQUIRE(index.translate(byte, offset_unit::utf8, offset_unit::code_point) == byte_boundary[byte]);
+    }
+    for (std::size_t unit = 0; unit < utf16_boundary.size(); unit += 3) {
+        REQUIRE(converter::translate_offset(utf8, unit, offset_unit::utf16, offset_unit::utf8) == boundaries[utf16_boundary[unit]][0]);
+        REQUIRE(index.translate(unit, offset_unit::utf16, offset_unit::code_point) == utf16_boundary[unit]);
+    }
+    REQUIRE(converter::translate_offset(utf8, utf8.size() + 9, offset_unit::utf8, offset_unit::code_point) == utf32.size());
+    REQUIRE(index.translate(utf32.size() + 9, offset_unit::code_point, offset_unit::utf8) == utf8.size());
+
+    // Ranges, and batches in any order
+    const rapidutf::text_range range = converter::translate_range(utf8, {boundaries[1500][1], boundaries[20][1]}, offset_unit::utf16, offset_unit::utf8);
+    REQUIRE(range.begin == boundaries[1500][0]);
+    REQUIRE(range.end == boundaries[20][0]);
+    const rapidutf::text_range indexed = index.translate(rapidutf::text_range{boundaries[20][2], boundaries[1500][2]}, offset_unit::code_point, offset_unit::utf16);
+    REQUIRE(indexed.begin == boundaries[20][1]);
+    REQUIRE(indexed.end == boundaries[1500][1]);
+
+    std::vector<std::size_t> offsets;
+    for (std::size_t i = 0; i < 300; ++i) {
+        offsets.push_back((i * 7919) % (utf16_boundary.size() + 10));
+    }
+    std::vector<std::size_t> translated = offsets;
+    converter::translate_offsets(utf8, translated, offset_unit::utf16, offset_unit::utf8);
+    for (std::size_t i = 0; i < offsets.size(); ++i) {
+        REQUIRE(translated[i] == converter::translate_offset(utf8, offsets[i], offset_unit::utf16, offset_unit::utf8));
+    }
+}
+
+TEST_CASE("Boundary-safe truncation tests", "[unicode]") {
+    using rapidutf::converter;
+
+    const std::u32string pieces[] = {U"a", U"\u00E9", U"\u4E2D", U"\U0001F600"};
+    std::u32string utf32;
+    for (std::size_t i = 0; i < 300; ++i) {
+        utf32 += pieces[(i * 7 + i / 20) % 4];
+    }
+    const std::string utf8 = converter::utf32_to_utf8(utf32);
+    const std::u16string utf16 = converter::utf32_to_utf16(utf32);
+
+    // Each cut is the last code point boundary at or before the limit
+    for (std::size_t limit = 0; limit <= utf8.size() + 1; ++limit) {
+        const std::string_view cut = converter::truncate_utf8(utf8, limit);
+        REQUIRE(cut.size() <= limit);
+        REQUIRE(cut.size() + 3 >= std::min(limit, utf8.size()));
+        REQUIRE(converter::is_valid_utf8(std::string(cut)));
+        REQUIRE((cut.size() == utf8.size() || (static_cast<unsigned char>(utf8[cut.size()]) & 0xC0U) != 0x80U));
+    }
+    for (std::size_t limit = 0; limit <= utf16.size() + 1; ++limit) {
+        const std::u16string_view cut = converter::truncate_utf16(utf16, limit);
+        REQUIRE(cut.size() <= limit);
+        REQUIRE(cut.size() + 1 >= std::min(limit, utf16.size()));
+        REQUIRE(converter::is_valid_utf16(std::u16string(cut)));
+    }
+    for (const std::size_t count : {0U, 1U, 2U, 63U, 64U, 65U, 200U, 299U, 300U, 301U}) {
+        REQUIRE(converter::truncate_utf8_code_points(utf8, count) == converter::utf32_to_utf8(utf32.substr(0, count)));
+        REQUIRE(converter::truncate_utf16_code_points(utf16, count) == converter::utf32_to_utf16(utf32.substr(0, count)));
+    }
+
+    for (const std::size_t chunk_size : {4U, 5U, 7U, 64U, 1000U}) {
+        std::string joined;
+        for (const std::string_view chunk : converter::split_at_boundaries(utf8, chunk_size)) {
+            REQUIRE(!chunk.empty());
+            REQUIRE(chunk.size() <= chunk_size);
+            REQUIRE(converter::is_valid_utf8(std::string(chunk)));
+            joined += chunk;
+        }
+        REQUIRE(joined == utf8);
+
+        std::u16string joined16;
+        for (const std::u16string_view chunk : converter::split_at_boundaries(utf16, chunk_size / 2)) {
+            REQUIRE(chunk.size() <= chunk_size / 2);
+            REQUIRE(converter::is_valid_utf16(std::u16string(chunk)));
+            joined16 += chunk;
+        }
+        REQUIRE(joined16 == utf16);
+    }
+    REQUIRE(converter::split_at_boundaries(std::string_view(), 4).empty());
+    REQUIRE_THROWS_AS(converter::split_at_boundaries(utf8, 3), std::runtime_error);
+    REQUIRE_THROWS_AS(converter::split_at_boundaries(utf16, 1), std::runtime_error);
+}
+
+TEST_CASE("Short UTF-32 surrogate tests", "[unicode]") {
+    using rapidutf::converter;
+    using rapidutf::byte_order;
+
+    // Inputs under the short-input limit take the scalar path, which must reject surrogates like the kernels do
+    for (const char32_t surrogate : {char32_t(0xD800), char32_t(0xDBFF), char32_t(0xDC00), char32_t(0xDFFF)}) {
+        for (const std::size_t length : {1U, 5U, 63U}) {
+            std::u32string utf32(length, U'a');
+            utf32[length / 2] = surrogate;
+            std::string utf8;
+            REQUIRE_THROWS_AS(converter::utf32_to_utf8(utf32), std::runtime_error);
+            REQUIRE_THROWS_AS(converter::utf32_to_utf8(utf32, utf8), std::runtime_error);
+            converter::swap_byte_order(utf32);
+            REQUIRE_THROWS_AS(converter::utf32_to_utf8(utf32, utf8, byte_order::little == byte_order::native ? byte_order::big : byte_order::little),
+                              std::runtime_error);
+        }
+    }
+}
+
+TEST_CASE("UTF-32 units above 0x7FFFFFFF tests", "[unicode]") {
+    using rapidutf::converter;
+
+    // Units with the top bit set are negative as signed lanes; short inputs hit the masked tail, longer ones full blocks
+    for (const char32_t unit : {char32_t(0x80000000), char32_t(0xFFFFFFFF), char32_t(0x80000041)}) {
+        for (const std::size_t length : {1U, 7U, 8U, 9U, 70U}) {
+            std::u32string utf32(length, U'a');
+            utf32[length - 1] = unit;
+            REQUIRE_THROWS_AS(converter::utf32_to_utf16(utf32), std::runtime_error);
+            REQUIRE_THROWS_AS(converter::utf32_to_utf8(utf32), std::runtime_error);
+            REQUIRE_FALSE(converter::is_valid_utf32(utf32));
+        }
+    }
+}
+
+TEST_CASE("Byte order output store tests", "[unicode]") {
+    using rapidutf::byte_order;
+    using rapidutf::converter;
+
+    const byte_order foreign = byte_order::native == byte_order::little ? byte_order::big : byte_order::little;
+    const auto check = [foreign](const std::string& utf8) {
+        std::u16string utf16 = converter::utf8_to_utf16(utf8);
+        std::u32string utf32 = converter::utf8_to_utf32(utf8);
+        converter::swap_byte_order(utf16);
+        converter::swap_byte_order(utf32);
+        REQUIRE(converter::utf8_to_utf16(utf8, foreign) == utf16);
+        REQUIRE(converter::utf8_to_utf32(utf8, foreign) == utf32);
+    };
+
+    // Short ASCII, ASCII runs of every length around the vector blocks between non-ASCII text, and ASCII tails
+    check("");
+    check("abc");
+    check(std::string(63, 'a'));
+    for (std::size_t run = 0; run < 200; run += (run < 70 ? 1 : 13)) {
+        check(std::string(run, 'x') + u8"é世😀" + std::string(run, 'y'));
+        check(u8"€" + std::string(run, 'z'));
+    }
+
+    // Large enough for the streaming stores of long ASCII runs
+    std::string large(std::size_t{3} << 20U, 'q');
+    large.replace(large.size() / 2, 4, u8"😀");
+    check(large);
+}
+
+TEST_CASE("Pointer conversion tests", "[unicode]") {
+    using rapidutf::byte_order;
+    using rapidutf::converter;
+
+    const byte_order foreign = byte_order::native == byte_order::little ? byte_order::big : byte_order::little;
+    std::string text;
+    while (text.size() < 3000) {
+        text += u8"Hello, world! Здравствуй, 世界 😀 café ";
+    }
+    const std::u32string all = converter::utf8_to_utf32(text);
+
+    // Every prefix length up to a few vector blocks, into heap buffers of exactly the converted length
+    for (std::size_t length = 0; length <= all.size(); length += (length < 80 ? 1 : 331)) {
+        const std::u32string utf32 = all.substr(0, length);
+        const std::string utf8 = converter::utf32_to_utf8(utf32);
+        const std::u16string utf16 = converter::utf32_to_utf16(utf32);
+
+        std::vector<char16_t> to16(converter::utf16_length_from_utf8(utf8));
+        REQUIRE(converter::utf8_to_utf16(utf8, to16.data(), to16.size()) == utf16.size());
+        REQUIRE(std::u16string(to16.begin(), to16.end()) == utf16);
+        std::vector<char32_t> to32(converter::count_utf8(utf8));
+        REQUIRE(converter::utf8_to_utf32(utf8, to32.data(), to32.size()) == utf32.size());
+        REQUIRE(std::u32string(to32.begin(), to32.end()) == utf32);
+        std::vector<char> to8(converter::utf8_length_from_utf16(utf16));
+        REQUIRE(converter::utf16_to_utf8(utf16, to8.data(), to8.size()) == utf8.size());
+        REQUIRE(std::string(to8.begin(), to8.end()) == utf8);
+        to8.assign(converter::utf8_length_from_utf32(utf32), '\0');
+        REQUIRE(converter::utf32_to_utf8(utf32, to8.data(), to8.size()) == utf8.size());
+        REQUIRE(std::string(to8.begin(), to8.end()) == utf8);
+        to32.assign(converter::count_utf16(utf16), U'\0');
+        REQUIRE(converter::utf16_to_utf32(utf16, to32.data(), to32.size()) == utf32.size());
+        REQUIRE(std::u32string(to32.begin(), to32.end()) == utf32);
+        to16.assign(converter::utf16_length_from_utf32(utf32), u'\0');
+        REQUIRE(converter::utf32_to_utf16(utf32, to16.data(), to16.size()) == utf16.size());
+        REQUIRE(std::u16string(to16.begin(), to16.end()) == utf16);
+
+        // Foreign output order
+        std::u16string swapped16 = utf16;
+        converter::swap_byte_order(swapped16);
+        REQUIRE(converter::utf8_to_utf16(utf8, to16.data(), to16.size(), foreign) == utf16.size());
+        REQUIRE(std::u16string(to16.begin(), to16.end()) == swapped16);
+        REQUIRE(converter::utf32_to_utf16(utf32, to16.data(), to16.size(), byte_order::native, foreign) == utf16.size());
+        REQUIRE(std::u16string(to16.begin(), to16.end()) == swapped16);
+
+        // One unit short of the result, which is reported as such and not as invalid input
+        if (length != 0) {
+            const std::string overflow = "Converted output does not fit the destination";
+            std::vector<char16_t> short16(utf16.size() - 1);
+            REQUIRE_THROWS_WITH(converter::utf8_to_utf16(utf8, short16.data(), short16.size()), overflow);
+            REQUIRE_THROWS_WITH(converter::utf32_to_utf16(utf32, short16.data(), short16.size()), overflow);
+            std::vector<char32_t> short32(utf32.size() - 1);
+            REQUIRE_THROWS_WITH(converter::utf8_to_utf32(utf8, short32.data(), short32.size()), overflow);
+            REQUIRE_THROWS_WITH(converter::utf16_to_utf32(utf16, short32.data(), short32.size()), overflow);
+            std::vector<char> short8(utf8.size() - 1);
+            REQUIRE_THROWS_WITH(converter::utf16_to_utf8(utf16, short8.data(), short8.size()), overflow);
+            REQUIRE_THROWS_WITH(converter::utf32_to_utf8(utf32, short8.data(), short8.size()), overflow);
+        }
+    }
+
+    // The room runs out in the middle of the scalar tail of a long input
+    const std::string tail = std::string(100, 'a') + u8"世世";
+    std::vector<char16_t> tail16(101);
+    REQUIRE_THROWS_WITH(converter::utf8_to_utf16(tail, tail16.data(), tail16.size()), "Converted output does not fit the destination");
+    std::vector<char32_t> tail32(101);
+    REQUIRE_THROWS_WITH(converter::utf8_to_utf32(tail, tail32.data(), tail32.size()), "Converted output does not fit the destination");
+
+    // Stray continuation bytes count for nothing, so the computed length is short of what a decoder could write
+    for (const std::size_t prefix : {0U, 1U, 7U, 40U, 100U}) {
+        const std::string invalid = std::string(prefix, 'a') + std::string(40, '\x80') + "bc";
+        std::vector<char16_t> to16(converter::utf16_length_from_utf8(invalid));
+        REQUIRE_THROWS_AS(converter::utf8_to_utf16(invalid, to16.data(), to16.size()), std::runtime_error);
+        std::vector<char32_t> to32(converter::count_utf8(invalid));
+        REQUIRE_THROWS_AS(converter::utf8_to_utf32(invalid, to32.data(), to32.size()), std::runtime_error);
+    }
+}
+
 // NOLINTEND
\ No newline at end of file
@@ -0,0 +1,632 @@
+// rapidutf-iconv: bulk file conversion between UTF-8, UTF-16 and UTF-32.
+//
+// Regular files are memory-mapped. The exact output size is computed up front with the library's length
+// counting, the output file is sized with ftruncate and mapped, and the input is converted in parallel slices
+// that the library writes straight into their own range of the output mapping. Pipes and other unmappable files
+// go through a streaming read/convert/write loop instead.
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "rapidutf/rapidutf.hpp"
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+namespace
+{
+
+using rapidutf::byte_order;
+using rapidutf::converter;
+
+struct text_encoding
+{
+  std::size_t unit = 1;
+  byte_order order = byte_order::native;
+};
+
+// Streamed input is read and converted in chunks of this size
+constexpr std::size_t chunk_size = std::size_t {1} << 20;
+// A chunk converts to at most this many times its size, from one-byte UTF-8 to UTF-32
+constexpr std::size_t max_expansion = 4;
+// Inputs are not split into slices smaller than this
+constexpr std::size_t min_slice_size = std::size_t {4} << 20;
+
+auto parse_encoding(const std::string &label) -> text_encoding
+{
+  std::string name;
+  for (const char c : label)
+  {
+    if (c != '-')
+    {
+      name += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+  }
+
+  if (name == "utf8")
+  {
+    return {1, byte_order::native};
+  }
+  if (name == "utf16le")
+  {
+    return {2, byte_order::little};
+  }
+  if (name == "utf16be")
+  {
+    return {2, byte_order::big};
+  }
+  if (name == "utf32le")
+  {
+    return {4, byte_order::little};
+  }
+  if (name == "utf32be")
+  {
+    return {4, byte_order::big};
+  }
+  throw std::invalid_argument("unsupported encoding: " + label);
+}
+
+auto system_error(const std::string &what) -> std::system_error
+{
+  return {errno, std::generic_category(), what};
+}
+
+class file_descriptor
+{
+public:
+  explicit file_descriptor(int fd)
+      : m_fd(fd)
+  {
+  }
+  file_descriptor(const file_descriptor &) = delete;
+  file_descriptor(file_descriptor &&) = delete;
+  auto operator=(const file_descriptor &) -> file_descriptor & = delete;
+  auto operator=(file_descriptor &&) -> file_descriptor & = delete;
+  ~file_descriptor()
+  {
+    if (m_fd > STDERR_FILENO)
+    {
+      ::close(m_fd);
+    }
+  }
+
+  auto get() const -> int { return m_fd; }
+
+private:
+  int m_fd;
+};
+
+class mapping
+{
+public:
+  mapping(int fd, std::size_t size, int protection)
+      : m_size(size)
+  {
+    if (m_size == 0)
+    {
+      return;
+    }
+    void *data = ::mmap(nullptr, m_size, protection, (protection & PROT_WRITE) != 0 ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+      throw system_error("mmap");
+    }
+    m_data = static_cast<unsigned char *>(data);
+  }
+  mapping(const mapping &) = delete;
+  mapping(mapping &&) = delete;
+  auto operator=(const mapping &) -> mapping & = delete;
+  auto operator=(mapping &&) -> mapping & = delete;
+  ~mapping()
+  {
+    if (m_data != nullptr)
+    {
+      ::munmap(m_data, m_size);
+    }
+  }
+
+  auto data() const -> unsigned char * { return m_data; }
+
+private:
+  unsigned char *m_data = nullptr;
+  std::size_t m_size;
+};
+
+auto read_unit16(const unsigned char *bytes, byte_order order) -> unsigned
+{
+  return order == byte_order::little ? (bytes[0] | (bytes[1] << 8U)) : ((bytes[0] << 8U) | bytes[1]);
+}
+
+// Length of the longest prefix of `size` bytes that ends on a character boundary
+auto complete_prefix(const unsigned char *data, std::size_t size, const text_encoding &encoding) -> std::size_t
+{
+  if (encoding.unit == 1)
+  {
+    // Back up over at most three continuation bytes to the lead byte of the last sequence
+    std::size_t lead = size;
+    while (lead > 0 && size - lead < 3 && (data[lead - 1] & 0xC0U) == 0x80U)
+    {
+      --lead;
+    }
+    if (lead == 0)
+    {
+      return size;
+    }
+    --lead;
+    const unsigned char byte = data[lead];
+    const std::size_t needed = byte >= 0xF0U ? 4 : byte >= 0xE0U ? 3 : byte >= 0xC0U ? 2 : 1;
+    return size - lead >= needed ? size : lead;
+  }
+
+  size -= size % encoding.unit;
+  if (encoding.unit == 2 && size >= 2 && (read_unit16(data + size - 2, encoding.order) & 0xFC00U) == 0xD800U)
+  {
+    size -= 2;
+  }
+  return size;
+}
+
+auto input_view(const unsigned char *data, std::size_t size) -> std::string_view
+{
+  return {reinterpret_cast<const char *>(data), size};  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+auto input_view16(const unsigned char *data, std::size_t size) -> std::u16string_view
+{
+  return {reinterpret_cast<const char16_t *>(data), size / 2};  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+auto input_view32(const unsigned char *data, std::size_t size) -> std::u32string_view
+{
+  return {reinterpret_cast<const char32_t *>(data), size / 4};  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+// Output size in bytes of converting well-formed input
+auto output_length(const unsigned char *data, std::size_t size, const text_encoding &from, const text_encoding &to) -> std::size_t
+{
+  if (from.unit == to.unit)
+  {
+    return size;
+  }
+  if (from.unit == 1)
+  {
+    return to.unit == 2 ? 2 * converter::utf16_length_from_utf8(input_view(data, size)) : 4 * converter::count_utf8(input_view(data, size));
+  }
+  if (from.unit == 2)
+  {
+    return to.unit == 1 ? converter::utf8_length_from_utf16(input_view16(data, size), from.order) : 4 * converter::count_utf16(input_view16(data, size), from.order);
+  }
+  return to.unit == 1 ? converter::utf8_length_from_utf32(input_view32(data, size), from.order) : 2 * converter::utf16_length_from_utf32(input_view32(data, size), from.order);
+}
+
+auto output_units(unsigned char *data) -> char *
+{
+  return reinterpret_cast<char *>(data);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+auto output_units16(unsigned char *data) -> char16_t *
+{
+  return reinterpret_cast<char16_t *>(data);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+auto output_units32(unsigned char *data) -> char32_t *
+{
+  return reinterpret_cast<char32_t *>(data);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+// Throws unless a chunk is well-formed text in `encoding`
+void validate(const unsigned char *data, std::size_t size, const text_encoding &encoding)
+{
+  if (encoding.unit == 1 && !converter::is_valid_utf8(input_view(data, size)))
+  {
+    throw std::runtime_error("Invalid UTF-8 sequence");
+  }
+  if (encoding.unit == 2 && !converter::is_valid_utf16(input_view16(data, size), encoding.order))
+  {
+    throw std::runtime_error("Invalid UTF-16 sequence");
+  }
+  if (encoding.unit == 4 && !converter::is_valid_utf32(input_view32(data, size), encoding.order))
+  {
+    throw std::runtime_error("Invalid UTF-32 sequence");
+  }
+}
+
+// Converts a chunk that starts and ends on character boundaries into `target`, which has room for `capacity` bytes,
+// and returns the number of bytes written
+auto transcode(const unsigned char *data, std::size_t size, const text_encoding &from, const text_encoding &to, unsigned char *target, std::size_t capacity) -> std::size_t
+{
+  if (size % from.unit != 0)
+  {
+    throw std::runtime_error("Truncated input");
+  }
+
+  if (from.unit == to.unit)
+  {
+    validate(data, size, from);
+    if (size > capacity)
+    {
+      throw std::runtime_error("Invalid input");
+    }
+    std::memcpy(target, data, size);
+    if (from.order != to.order)
+    {
+      if (from.unit == 2)
+      {
+        converter::swap_byte_order(output_units16(target), size / 2);
+      }
+      else
+      {
+        converter::swap_byte_order(output_units32(target), size / 4);
+      }
+    }
+    return size;
+  }
+
+  if (from.unit == 1)
+  {
+    return to.unit == 2 ? 2 * converter::utf8_to_utf16(input_view(data, size), output_units16(target), capacity / 2, to.order)
+                        : 4 * converter::utf8_to_utf32(input_view(data, size), output_units32(target), capacity / 4, to.order);
+  }
+  if (from.unit == 2)
+  {
+    return to.unit == 1 ? converter::utf16_to_utf8(input_view16(data, size), output_units(target), capacity, from.order)
+                        : 4 * converter::utf16_to_utf32(input_view16(data, size), output_units32(target), capacity / 4, from.order, to.order);
+  }
+  return to.unit == 1 ? converter::utf32_to_utf8(input_view32(data, size), output_units(target), capacity, from.order)
+                      : 2 * converter::utf32_to_utf16(input_view32(data, size), output_units16(target), capacity / 2, from.order, to.order);
+}
+
+// Runs work(0) .. work(count - 1) on their own threads and rethrows the first failure
+template<typename Work>
+void run_parallel(std::size_t count, const Work &work)
+{
+  std::vector<std::exception_ptr> errors(count);
+  std::vector<std::thread> threads;
+  threads.reserve(count);
+  for (std::size_t index = 0; index < count; ++index)
+  {
+    threads.emplace_back(
+        [&, index]()
+        {
+          try
+          {
+            work(index);
+          }
+          catch (...)
+          {
+            errors[index] = std::current_exception();
+          }
+        });
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+  for (const auto &error : errors)
+  {
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+struct slice
+{
+  std::size_t begin = 0;
+  std::size_t end = 0;
+  std::size_t output_begin = 0;
+  std::size_t output_size = 0;
+};
+
+// Converts a mapped regular file into `output_path` and returns the output size
+auto transcode_mapped(int input_fd, std::size_t input_size, const std::string &output_path, const text_encoding &from, const text_encoding &to, std::size_t threads)
+    -> std::size_t
+{
+  const mapping input(input_fd, input_size, PROT_READ);
+  const unsigned char *data = input.data();
+  if (data != nullptr)
+  {
+    ::madvise(input.data(), input_size, MADV_SEQUENTIAL);
+  }
+
+  // Slices end on character boundaries so every one of them converts on its own
+  const std::size_t count = std::clamp<std::size_t>(input_size / min_slice_size, 1, threads);
+  std::vector<slice> slices(count);
+  for (std::size_t index = 1; index < count; ++index)
+  {
+    const std::size_t begin = slices[index - 1].begin;
+    const std::size_t split = begin + complete_prefix(data + begin, (input_size * index / count) - begin, from);
+    slices[index - 1].end = split;
+    slices[index].begin = split;
+  }
+  slices.back().end = input_size;
+
+  run_parallel(count, [&](std::size_t index) { slices[index].output_size = output_length(data + slices[index].begin, slices[index].end - slices[index].begin, from, to); });
+  std::size_t output_size = 0;
+  for (auto &part : slices)
+  {
+    part.output_begin = output_size;
+    output_size += part.output_size;
+  }
+
+  const file_descriptor output_fd(::open(output_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666));  // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+  if (output_fd.get() < 0)
+  {
+    throw system_error(output_path);
+  }
+  try
+  {
+    if (::ftruncate(output_fd.get(), static_cast<off_t>(output_size)) != 0)
+    {
+      throw system_error("ftruncate");
+    }
+    const mapping output(output_fd.get(), output_size, PROT_READ | PROT_WRITE);
+
+    run_parallel(count,
+                 [&](std::size_t index)
+                 {
+                   // The lengths were counted assuming well-formed input; anything else converts to a different size
+                   const slice &part = slices[index];
+                   if (transcode(data + part.begin, part.end - part.begin, from, to, output.data() + part.output_begin, part.output_size) != part.output_size)
+                   {
+                     throw std::runtime_error("Invalid input");
+                   }
+                 });
+  }
+  catch (...)
+  {
+    // Do not leave a full-sized file of partly converted text and zeros behind for what failed
+    [[maybe_unused]] const int truncated = ::ftruncate(output_fd.get(), 0);
+    throw;
+  }
+
+  return output_size;
+}
+
+void write_all(int fd, const unsigned char *bytes, std::size_t length)
+{
+  while (length > 0)
+  {
+    const ssize_t written = ::write(fd, bytes, length);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      throw system_error("write");
+    }
+    bytes += written;
+    length -= static_cast<std::size_t>(written);
+  }
+}
+
+struct stream_totals
+{
+  std::size_t input = 0;
+  std::size_t output = 0;
+};
+
+// Fallback for pipes and other files that cannot be mapped
+auto transcode_stream(int input_fd, int output_fd, const text_encoding &from, const text_encoding &to) -> stream_totals
+{
+  stream_totals totals;
+  std::vector<unsigned char> buffer(chunk_size + 4);
+  std::vector<unsigned char> converted(max_expansion * buffer.size());
+  std::size_t pending = 0;
+  const auto convert = [&](std::size_t length)
+  {
+    const std::size_t written = transcode(buffer.data(), length, from, to, converted.data(), converted.size());
+    write_all(output_fd, converted.data(), written);
+    totals.output += written;
+  };
+
+  for (;;)
+  {
+    const ssize_t count = ::read(input_fd, buffer.data() + pending, chunk_size);
+    if (count < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      throw system_error("read");
+    }
+    if (count == 0)
+    {
+      // Whatever is left is an incomplete character; let the converter report it
+      convert(pending);
+      return totals;
+    }
+
+    totals.input += static_cast<std::size_t>(count);
+    const std::size_t available = pending + static_cast<std::size_t>(count);
+    const std::size_t length = complete_prefix(buffer.data(), available, from);
+    convert(length);
+    pending = available - length;
+    std::memmove(buffer.data(), buffer.data() + length, pending);
+  }
+}
+
+void usage(std::ostream &stream)
+{
+  stream << "usage: rapidutf-iconv -f FROM -t TO [-o OUTPUT] [-j THREADS] [--stats] [INPUT]\n"
+            "encodings: utf-8, utf-16le, utf-16be, utf-32le, utf-32be\n"
+            "INPUT and OUTPUT default to standard input and output. Regular files are converted through\n"
+            "memory mappings on THREADS threads; anything else is streamed.\n";
+}
+
+struct options
+{
+  text_encoding from;
+  text_encoding to;
+  std::string input = "-";
+  std::string output = "-";
+  std::size_t threads = std::max(1U, std::thread::hardware_concurrency());
+  bool stats = false;
+};
+
+auto parse_options(const std::vector<std::string> &args) -> options
+{
+  options result;
+  bool has_from = false;
+  bool has_to = false;
+  bool has_input = false;
+  for (std::size_t i = 0; i < args.size(); ++i)
+  {
+    const std::string &arg = args[i];
+    const auto value = [&]() -> const std::string &
+    {
+      if (i + 1 >= args.size())
+      {
+        throw std::invalid_argument("missing value for " + arg);
+      }
+      return args[++i];
+    };
+
+    if (arg == "-f")
+    {
+      result.from = parse_encoding(value());
+      has_from = true;
+    }
+    else if (arg == "-t")
+    {
+      result.to = parse_encoding(value());
+      has_to = true;
+    }
+    else if (arg == "-o")
+    {
+      result.output = value();
+    }
+    else if (arg == "-j")
+    {
+      result.threads = std::max<std::size_t>(1, std::stoul(value()));
+    }
+    else if (arg == "--stats")
+    {
+      result.stats = true;
+    }
+    else if (!has_input && (arg == "-" || arg.empty() || arg[0] != '-'))
+    {
+      result.input = arg;
+      has_input = true;
+    }
+    else
+    {
+      throw std::invalid_argument("unexpected argument: " + arg);
+    }
+  }
+  if (!has_from || !has_to)
+  {
+    throw std::invalid_argument("both -f and -t are required");
+  }
+  return result;
+}
+
+auto run(const options &opts) -> int
+{
+  const file_descriptor input_fd(opts.input == "-" ? STDIN_FILENO : ::open(opts.input.c_str(), O_RDONLY));  // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+  if (input_fd.get() < 0)
+  {
+    throw system_error(opts.input);
+  }
+  struct stat input_stat = {};
+  if (::fstat(input_fd.get(), &input_stat) != 0)
+  {
+    throw system_error(opts.input);
+  }
+
+  // Mapping needs a regular file on both ends; an existing special file such as /dev/null is streamed to
+  bool mapped = S_ISREG(input_stat.st_mode) && opts.output != "-";
+  if (mapped)
+  {
+    struct stat output_stat = {};
+    if (::stat(opts.output.c_str(), &output_stat) == 0)
+    {
+      if (output_stat.st_dev == input_stat.st_dev && output_stat.st_ino == input_stat.st_ino)
+      {
+        throw std::invalid_argument("input and output are the same file");
+      }
+      mapped = S_ISREG(output_stat.st_mode);
+    }
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  stream_totals totals;
+  if (mapped)
+  {
+    totals.input = static_cast<std::size_t>(input_stat.st_size);
+    totals.output = transcode_mapped(input_fd.get(), totals.input, opts.output, opts.from, opts.to, opts.threads);
+  }
+  else
+  {
+    const file_descriptor output_fd(opts.output == "-" ? STDOUT_FILENO : ::open(opts.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666));  // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    if (output_fd.get() < 0)
+    {
+      throw system_error(opts.output);
+    }
+    totals = transcode_stream(input_fd.get(), output_fd.get(), opts.from, opts.to);
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  if (opts.stats)
+  {
+    const double seconds = elapsed.count();
+    std::cerr << "rapidutf-iconv: " << totals.input << " bytes in, " << totals.output << " bytes out, " << seconds << " s, "
+              << (seconds > 0 ? static_cast<double>(totals.input) / seconds / 1e9 : 0.0) << " GB/s (" << (mapped ? "mapped" : "streamed") << ")\n";
+  }
+  return 0;
+}
+
+}  // namespace
+
+auto main(int argc, char *argv[]) -> int
+{
+  const std::vector<std::string> args(argv + 1, argv + argc);
+  if (std::find(args.begin(), args.end(), "-h") != args.end() || std::find(args.begin(), args.end(), "--help") != args.end())
+  {
+    usage(std::cout);
+    return 0;
+  }
+
+  options opts;
+  try
+  {
+    opts = parse_options(args);
+  }
+  catch (const std::exception &error)
+  {
+    std::cerr << "rapidutf-iconv: " << error.what() << '\n';
+    usage(std::cerr);
+    return 2;
+  }
+
+  try
+  {
+    return run(opts);
+  }
+  catch (const std::exception &error)
+  {
+    std::cerr << "rapidutf-iconv: " << error.what() << '\n';
+    return 1;
+  }
+}
+
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers,cppcoreguidelines-pro-bounds-pointer-arithmetic)